@@ -25,16 +25,27 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <util/macros.h>
 #include <util/issue_context.h>
 #include <util/config.h>
+#include <util/checkpoint.h>
 #include <api/elementnode.h>
 #include <rt/cursor.h>
 #include <rt/systime.h>
+#include <rt/profiler.h>
+#include <rt/cycle_stats.h>
+#include <rt/trace.h>
+#include <rt/watcher.h>
+#include <rt/breakpoints.h>
 #include <elements/ifunction_block.h>
 #include <elements/types.h>
 #include <elements/builtins.h>
+#include <elements/integers.h>
+#include <elements/array.h>
+#include <expressions/inline_expression.h>
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <errno.h>
 #include <utlist.h>
 #include <uthash.h>
 
@@ -55,7 +66,13 @@ struct st_t {
 
     struct config_iface_t *config;
     struct dmem_iface_t *direct_memory;
+    size_t direct_memory_bytes;
     struct systime_iface_t *systime;
+    struct profiler_iface_t *profiler;
+    struct cycle_stats_iface_t *cycle_stats;
+    struct trace_recorder_iface_t *trace;
+    struct watcher_iface_t *watcher;	     /* Created by the first watch */
+    struct breakpoints_iface_t *breakpoints;
 
     struct element_node_context_t element_node_context;
     struct element_node_t *element_nodes;
@@ -63,11 +80,38 @@ struct st_t {
     struct parser_t parser;
 
     int needs_linking;
+    int stop_periodic;		/* Accessed atomically */
 };
 
 static void reset_linking(
     struct st_t *st);
 
+static void drop_watches(
+    struct st_t *st);
+
+static void drop_breakpoints(
+    struct st_t *st);
+
+static void init_parser(
+    struct parser_t *parser,
+    struct issues_iface_t *errors,
+    struct config_iface_t *config,
+    struct dmem_iface_t *direct_memory)
+{
+    yylex_init_extra(&(parser->scanner_options), &(parser->yyscanner));
+    
+    parser->errors = errors;
+    parser->config = config;
+    parser->direct_memory = direct_memory;
+    parser->global_type_ref_pool = NULL;
+    parser->global_var_ref_pool = NULL;
+    parser->function_ref_pool = NULL;
+    parser->pou_type_ref_pool = NULL;
+    parser->pou_var_ref_pool = NULL;
+    parser->program_ref_pool = NULL;
+    parser->queries = NULL;
+}
+
 struct st_t * st_new_instance(
     size_t direct_memory_bytes)
 {
@@ -80,6 +124,7 @@ struct st_t * st_new_instance(
     struct st_t *st = NULL;
     struct systime_iface_t *s = NULL;
     struct function_iface_t *f = NULL;
+    struct cycle_stats_iface_t *cs = NULL;
     
     ALLOC_OR_JUMP(
 	st,
@@ -92,10 +137,11 @@ struct st_t * st_new_instance(
     dm    = st_new_direct_memory(direct_memory_bytes);
     s     = st_new_systime();
     cur   = st_new_cursor();
+    cs    = st_new_cycle_stats(e);
 
     pe    = st_new_issue_context();
     
-    if(!(e && et && c && dm && s && pe && cur))
+    if(!(e && et && c && dm && s && pe && cur && cs))
     {
 	goto error_free_resources;
     }
@@ -111,16 +157,7 @@ struct st_t * st_new_instance(
     	goto error_free_resources;
     }
 
-    yylex_init_extra(&(st->parser.scanner_options), &(st->parser.yyscanner));
-    
-    st->parser.errors = pe;
-    st->parser.config = c;
-    st->parser.direct_memory = dm;
-    st->parser.global_type_ref_pool = NULL;
-    st->parser.global_var_ref_pool = NULL;
-    st->parser.function_ref_pool = NULL;
-    st->parser.pou_type_ref_pool = NULL;
-    st->parser.pou_var_ref_pool = NULL;
+    init_parser(&(st->parser), pe, c, dm);
     
     st->elementary_types = et;
     st->global_variables = NULL;
@@ -132,7 +169,14 @@ struct st_t * st_new_instance(
     st->compilation_units = NULL;
     st->config = c;
     st->direct_memory = dm;
+    st->direct_memory_bytes = direct_memory_bytes;
     st->systime = s;
+    st->profiler = NULL;
+    st->cycle_stats = cs;
+    st->stop_periodic = ESSTEE_FALSE;
+    st->trace = NULL;
+    st->watcher = NULL;
+    st->breakpoints = NULL;
     st->element_nodes = NULL;
 
     return st;
@@ -149,36 +193,82 @@ int st_set_config(
     int value,
     struct st_t *st)
 {
-    /* TODO: implement set config */
-    return ESSTEE_FALSE;
+    return st->config->set(st->config, option, value);
 }
 
 int st_get_config(
     const char *option,
     struct st_t *st)
 {
-    /* TODO: implement get config */
-    return ESSTEE_FALSE;
+    return st->config->get(st->config, option);
 }
 
-int st_load_file(struct st_t *st, const char *path)
+static void unlink_compilation_unit(
+    struct st_t *st,
+    struct compilation_unit_t *cu)
 {
-    struct compilation_unit_t *cu = st_parse_file(path, &(st->parser));
+    struct type_iface_t *titr = NULL, *tfound = NULL;
+    DL_FOREACH(cu->global_types, titr)
+    {
+	HASH_FIND_STR(st->global_types, titr->identifier, tfound);
+	if(tfound == titr)
+	{
+	    HASH_DEL(st->global_types, titr);
+	}
+    }
 
-    if(!cu)
+    struct variable_iface_t *vitr = NULL, *vfound = NULL;
+    DL_FOREACH(cu->global_variables, vitr)
     {
-	st->errors->merge(st->errors, st->parser.errors);
-	return ESSTEE_ERROR;
+	HASH_FIND_STR(st->global_variables, vitr->identifier, vfound);
+	if(vfound == vitr)
+	{
+	    HASH_DEL(st->global_variables, vitr);
+	}
+    }
+
+    struct function_iface_t *fitr = NULL, *ffound = NULL;
+    DL_FOREACH(cu->functions, fitr)
+    {
+	HASH_FIND_STR(st->functions, fitr->identifier, ffound);
+	if(ffound == fitr)
+	{
+	    HASH_DEL(st->functions, fitr);
+	}
+    }
+
+    struct program_iface_t *pitr = NULL, *pfound = NULL;
+    DL_FOREACH(cu->programs, pitr)
+    {
+	HASH_FIND_STR(st->programs, pitr->identifier, pfound);
+	if(pfound == pitr)
+	{
+	    HASH_DEL(st->programs, pitr);
+	}
+
+	if(st->main == pitr)
+	{
+	    st->main = NULL;
+	}
     }
+}
 
+static void add_compilation_unit(
+    struct st_t *st,
+    struct compilation_unit_t *cu)
+{
     struct compilation_unit_t *found = NULL;
-    HASH_FIND_STR(st->compilation_units, path, found);
+    HASH_FIND_STR(st->compilation_units, cu->source, found);
 
     if(found)
     {
+	unlink_compilation_unit(st, found);
 	HASH_DEL(st->compilation_units, found);
 	st_destroy_compilation_unit(found);
     }
+
+    drop_watches(st);
+    drop_breakpoints(st);
     
     HASH_ADD_KEYPTR(
 	hh, 
@@ -188,16 +278,65 @@ int st_load_file(struct st_t *st, const char *path)
 	cu);
 
     st->needs_linking = 1;
+}
+
+int st_load_file(struct st_t *st, const char *path)
+{
+    struct compilation_unit_t *cu = st_parse_file(path, &(st->parser));
+
+    if(!cu)
+    {
+	st->errors->merge(st->errors, st->parser.errors);
+	return ESSTEE_ERROR;
+    }
+
+    add_compilation_unit(st, cu);
     return ESSTEE_OK;
 }
 
 int st_load_buffer(
     const char *identifier, 
-    const char *bytes, 
+    char *bytes, 
     size_t len, 
     struct st_t *st)
 {
-    /* TODO: implement loading of buffer */
+    struct compilation_unit_t *cu = st_parse_buffer(identifier,
+						    bytes,
+						    len,
+						    &(st->parser));
+    if(!cu)
+    {
+	st->errors->merge(st->errors, st->parser.errors);
+	return ESSTEE_ERROR;
+    }
+
+    add_compilation_unit(st, cu);
+    return ESSTEE_OK;
+}
+
+int st_unload_buffer(
+    struct st_t *st,
+    const char *identifier)
+{
+    struct compilation_unit_t *found = NULL;
+    HASH_FIND_STR(st->compilation_units, identifier, found);
+
+    if(!found)
+    {
+	st->errors->new_issue(st->errors,
+			      "nothing loaded as '%s'",
+			      ESSTEE_ARGUMENT_ERROR,
+			      identifier);
+	return ESSTEE_ERROR;
+    }
+
+    drop_watches(st);
+    drop_breakpoints(st);
+    unlink_compilation_unit(st, found);
+    HASH_DEL(st->compilation_units, found);
+    st_destroy_compilation_unit(found);
+
+    st->needs_linking = 1;
     return ESSTEE_OK;
 }
 
@@ -415,59 +554,6 @@ int st_link(struct st_t *st)
     return ESSTEE_OK;
 }
 
-const struct st_location_t * st_start(
-    struct st_t *st,
-    const char *program)
-{
-    struct program_iface_t *found = NULL;
-    HASH_FIND_STR(st->programs, program, found);
-
-    if(!found)
-    {
-	st->errors->new_issue(
-	    st->errors,
-	    "no program named '%s' defined",
-	    ESSTEE_CONTEXT_ERROR,
-	    program);
-
-	return NULL;
-    }
-
-    /* Reset global variables */
-    struct variable_iface_t *itr = NULL;
-    DL_FOREACH(st->global_variables, itr)
-    {
-	int reset_result = itr->reset(itr,
-				      st->config,
-				      st->errors);
-	
-	if(reset_result != ESSTEE_OK)
-	{
-	    st->errors->internal_error(st->errors,
-				       __FILE__,
-				       __FUNCTION__,
-				       __LINE__);
-
-	    return NULL;
-	}
-    }
-
-    /* Start program */
-    int start_result = found->start(found,
-				    st->cursor,
-				    st->config,
-				    st->errors);
-
-    if(start_result != ESSTEE_OK)
-    {
-	return NULL;
-    }
-
-    st->main = found;
-    
-    return st->cursor->current_location(st->cursor);
-}
-
 const struct st_issue_t * st_fetch_issue(
     struct st_t *st,
     st_bitflag_t filter)
@@ -483,72 +569,41 @@ const struct st_issue_t * st_fetch_sub_issue(
     return st->errors->fetch_sub_issue(st->errors, issue, filter);
 }
 
-int st_query(
+struct st_element_t * st_get_element(
     struct st_t *st,
-    char *output,
-    size_t output_max_len,
-    const char *query_string)
+    const char *identifier)
 {
-    if(output_max_len > 0)
-    {
-	output[0] = '\0';
-    }
-    else
-    {
-	return ESSTEE_ERROR;
-    }
+    return NULL;
+}
 
-    struct queries_iface_t *queries = st_parse_query_string(query_string,
-							    &(st->parser));
-    if(!queries)
-    {
-	st->errors->merge(st->errors, st->parser.errors);
-	return ESSTEE_ERROR;
-    }
-    
-    int link_result = queries->link(queries,
-				    st->global_variables,
-				    st->functions,
-				    st->programs,
-				    st->config,
-				    st->errors);
+/* Passes the time of a finished cycle, and reports it to the trace
+ * and the watches */
+static int finish_cycle(
+    struct st_t *st,
+    uint64_t ms)
+{
+    st->systime->add_time_ms(st->systime, ms);
 
-    if(link_result != ESSTEE_OK)
+    if(st->trace)
     {
-	goto error_free_resources;
+	int record_result = st->trace->record(st->trace,
+					      st->systime->get_time_ms(st->systime),
+					      st->errors);
+	if(record_result != ESSTEE_OK)
+	{
+	    return record_result;
+	}
     }
-    
-    int evaluate_result = queries->evaluate(queries,
-					    st->config,
-					    st->errors);
 
-    if(evaluate_result != ESSTEE_OK)
+    if(st->watcher)
     {
-	goto error_free_resources;
+	return st->watcher->notify(st->watcher, st->config, st->errors);
     }
-
-    int display_result = queries->display(queries,
-					  output,
-					  output_max_len,
-					  st->config,
-					  st->errors);
-
-    queries->destroy(queries);
-    return display_result;
     
-error_free_resources:
-    queries->destroy(queries);
-    return ESSTEE_ERROR;    
-}
-
-struct st_element_t * st_get_element(
-    struct st_t *st,
-    const char *identifier)
-{
-    return NULL;
+    return ESSTEE_OK;
 }
 
-int st_run_cycle(
+static int run_cycle(
     struct st_t *st,
     uint64_t ms)
 {
@@ -561,57 +616,1771 @@ int st_run_cycle(
 	return ESSTEE_ERROR;
     }
 
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    st->cursor->arm_watchdog(st->cursor);
+    st->systime->clear_deadlines(st->systime);
+    
     int cycle_result = st->main->run_cycle(st->main,
 					   st->cursor,
 					   st->systime,
 					   st->config,
 					   st->errors);
 
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
     if(cycle_result != ESSTEE_OK)
     {
 	return cycle_result;
     }
+
+    uint64_t time_ns = (stop.tv_sec - start.tv_sec) * 1000000000ULL
+	+ stop.tv_nsec - start.tv_nsec;
     
-    st->systime->add_time_ms(st->systime, ms);
-    
-    return ESSTEE_OK;
+    st->cycle_stats->record(st->cycle_stats, time_ns);
+
+    return finish_cycle(st, ms);
 }
 
 
-const struct st_location_t * st_step(
-    struct st_t *st)
-{
-    return NULL;
-}
+#define CHECKPOINT_MAGIC "ESSTEECP"
+#define CHECKPOINT_VERSION 2
 
-const struct st_location_t * st_step_in(
-    struct st_t *st)
+/* Writes the values of the runtime state, everything but the time */
+static int checkpoint_values(
+    const struct st_t *st,
+    struct issues_iface_t *issues,
+    struct checkpoint_iface_t *checkpoint)
 {
-    return NULL;
+    if(st->direct_memory->checkpoint(st->direct_memory, checkpoint) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_checkpoint_variables(st->global_variables, checkpoint, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    struct program_iface_t *pitr = NULL;
+    for(pitr = st->programs; pitr != NULL; pitr = pitr->hh.next)
+    {
+	if(pitr->checkpoint(pitr, checkpoint, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return ESSTEE_OK;
 }
 
-const struct st_location_t * st_step_out(
-    struct st_t *st)
+static void fingerprint_variables(
+    const struct variable_iface_t *variables,
+    struct checkpoint_iface_t *digest)
 {
-    return NULL;
+    const struct variable_iface_t *itr = NULL;
+    DL_FOREACH(variables, itr)
+    {
+	if(!itr->checkpoint)
+	{
+	    continue;
+	}
+
+	const struct type_iface_t *type = itr->type(itr);
+	st_bitflag_t type_class = type->class(type);
+
+	digest->write(digest, itr->identifier, strlen(itr->identifier) + 1);
+	if(type->identifier)
+	{
+	    digest->write(digest, type->identifier, strlen(type->identifier) + 1);
+	}
+	digest->write(digest, &type_class, sizeof(type_class));
+    }
 }
 
-int st_step_time(
-    struct st_t *st,
-    uint64_t ms)
+/* Folds the layout of the checkpointed values into a digest: the size
+ * of direct memory, then the identifiers and types of the variables in
+ * the order their values are written */
+static int program_fingerprint(
+    const struct st_t *st,
+    struct issues_iface_t *issues,
+    uint64_t *fingerprint)
 {
-    st->systime->add_time_ms(st->systime, ms);
-    return ESSTEE_OK;
-}
+    struct checkpoint_iface_t *digest =
+	st_new_checkpoint_digest(fingerprint, issues);
+
+    if(!digest)
+    {
+	return ESSTEE_ERROR;
+    }
 
+    uint64_t direct_memory_bytes = st->direct_memory_bytes;
+    digest->write(digest, &direct_memory_bytes, sizeof(direct_memory_bytes));
 
-void st_destroy(struct st_t *st)
-{
-    /* TODO: Destructor for st instance */
+    fingerprint_variables(st->global_variables, digest);
+
+    struct program_iface_t *pitr = NULL;
+    for(pitr = st->programs; pitr != NULL; pitr = pitr->hh.next)
+    {
+	digest->write(digest, pitr->identifier, strlen(pitr->identifier) + 1);
+	fingerprint_variables(pitr->variables(pitr), digest);
+    }
+
+    digest->destroy(digest);
+
+    return ESSTEE_OK;
 }
 
-static void reset_linking(
-    struct st_t *st)
+static int checkpoint_state(
+    const struct st_t *st,
+    struct issues_iface_t *issues,
+    struct checkpoint_iface_t *checkpoint)
 {
-    /* TODO: Functionality, resetting linking prior to link operation */
+    uint32_t version = CHECKPOINT_VERSION;
+    uint64_t fingerprint = 0;
+    uint32_t main_size = (st->main) ? strlen(st->main->identifier) : 0;
+    uint64_t time_ms = st->systime->get_time_ms(st->systime);
+
+    if(program_fingerprint(st, issues, &fingerprint) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(checkpoint->write(checkpoint, CHECKPOINT_MAGIC, 8) != ESSTEE_OK
+       || checkpoint->write(checkpoint, &version, sizeof(version)) != ESSTEE_OK
+       || checkpoint->write(checkpoint, &fingerprint, sizeof(fingerprint)) != ESSTEE_OK
+       || checkpoint->write(checkpoint, &main_size, sizeof(main_size)) != ESSTEE_OK
+       || (main_size > 0
+	   && checkpoint->write(checkpoint, st->main->identifier, main_size) != ESSTEE_OK)
+       || checkpoint->write(checkpoint, &time_ms, sizeof(time_ms)) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return checkpoint_values(st, issues, checkpoint);
+}
+
+static int restore_state(
+    struct st_t *st,
+    struct issues_iface_t *issues,
+    struct checkpoint_iface_t *checkpoint)
+{
+    char magic[8];
+    uint32_t version = 0;
+    uint64_t fingerprint = 0;
+    uint64_t own_fingerprint = 0;
+    uint32_t main_size = 0;
+    uint64_t time_ms = 0;
+
+    if(checkpoint->read(checkpoint, magic, 8) != ESSTEE_OK
+       || checkpoint->read(checkpoint, &version, sizeof(version)) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(memcmp(magic, CHECKPOINT_MAGIC, 8) != 0 || version != CHECKPOINT_VERSION)
+    {
+	issues->new_issue(issues,
+			  "not a valid checkpoint",
+			  ESSTEE_ARGUMENT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    if(checkpoint->read(checkpoint, &fingerprint, sizeof(fingerprint)) != ESSTEE_OK
+       || program_fingerprint(st, issues, &own_fingerprint) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(fingerprint != own_fingerprint)
+    {
+	issues->new_issue(issues,
+			  "checkpoint was taken from a different program",
+			  ESSTEE_ARGUMENT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    if(checkpoint->read(checkpoint, &main_size, sizeof(main_size)) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    struct program_iface_t *main = NULL;
+    if(main_size > 0)
+    {
+	char main_identifier[main_size+1];
+	if(checkpoint->read(checkpoint, main_identifier, main_size) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+	main_identifier[main_size] = '\0';
+
+	HASH_FIND_STR(st->programs, main_identifier, main);
+	if(!main)
+	{
+	    issues->new_issue(issues,
+			      "checkpoint refers to unknown program '%s'",
+			      ESSTEE_ARGUMENT_ERROR,
+			      main_identifier);
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    if(checkpoint->read(checkpoint, &time_ms, sizeof(time_ms)) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    /* Starting places the cursor at the start of a cycle, but also
+     * resets the program variables, so it is done before restoring
+     * them */
+    if(main)
+    {
+	if(main->start(main, st->cursor, st->config, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+    st->main = main;
+
+    if(st->direct_memory->restore(st->direct_memory, checkpoint) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_restore_variables(st->global_variables, checkpoint, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    struct program_iface_t *pitr = NULL;
+    for(pitr = st->programs; pitr != NULL; pitr = pitr->hh.next)
+    {
+	if(pitr->restore(pitr, checkpoint, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    st->systime->reset(st->systime);
+    st->systime->add_time_ms(st->systime, time_ms);
+
+    return ESSTEE_OK;
+}
+
+static int take_checkpoint(
+    const struct st_t *st,
+    struct issues_iface_t *issues,
+    struct st_buffer_t *buffer)
+{
+    if(st->needs_linking)
+    {
+	issues->new_issue(issues,
+			  "cannot checkpoint an unlinked instance",
+			  ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    if(st->main && !st->cursor->at_cycle_start(st->cursor))
+    {
+	issues->new_issue(issues,
+			  "checkpoints can only be taken between cycles",
+			  ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    struct checkpoint_iface_t *checkpoint =
+	st_new_checkpoint_writer(buffer, issues);
+
+    if(!checkpoint)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int checkpoint_result = checkpoint_state(st, issues, checkpoint);
+    checkpoint->destroy(checkpoint);
+
+    return checkpoint_result;
+}
+
+static int restore_checkpoint(
+    struct st_t *st,
+    struct issues_iface_t *issues,
+    const struct st_buffer_t *buffer)
+{
+    if(st->needs_linking)
+    {
+	issues->new_issue(issues,
+			  "cannot restore into an unlinked instance",
+			  ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    struct checkpoint_iface_t *checkpoint =
+	st_new_checkpoint_reader(buffer, issues);
+
+    if(!checkpoint)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int restore_result = restore_state(st, issues, checkpoint);
+    checkpoint->destroy(checkpoint);
+
+    return restore_result;
+}
+
+const struct st_location_t * st_start(
+    struct st_t *st,
+    const char *program)
+{
+    struct program_iface_t *found = NULL;
+    HASH_FIND_STR(st->programs, program, found);
+
+    if(!found)
+    {
+	st->errors->new_issue(
+	    st->errors,
+	    "no program named '%s' defined",
+	    ESSTEE_CONTEXT_ERROR,
+	    program);
+
+	return NULL;
+    }
+
+    /* Reset global variables */
+    struct variable_iface_t *itr = NULL;
+    DL_FOREACH(st->global_variables, itr)
+    {
+	int reset_result = itr->reset(itr,
+				      st->config,
+				      st->errors);
+	
+	if(reset_result != ESSTEE_OK)
+	{
+	    st->errors->internal_error(st->errors,
+				       __FILE__,
+				       __FUNCTION__,
+				       __LINE__);
+
+	    return NULL;
+	}
+    }
+
+    /* Start program */
+    int start_result = found->start(found,
+				    st->cursor,
+				    st->config,
+				    st->errors);
+
+    if(start_result != ESSTEE_OK)
+    {
+	return NULL;
+    }
+
+    st->main = found;
+    
+    return st->cursor->current_location(st->cursor);
+}
+
+int st_query(
+    struct st_t *st,
+    char *output,
+    size_t output_max_len,
+    const char *query_string)
+{
+    if(output_max_len > 0)
+    {
+	output[0] = '\0';
+    }
+    else
+    {
+	return ESSTEE_ERROR;
+    }
+
+    struct queries_iface_t *queries = st_parse_query_string(query_string,
+							    &(st->parser));
+    if(!queries)
+    {
+	st->errors->merge(st->errors, st->parser.errors);
+	return ESSTEE_ERROR;
+    }
+    
+    int link_result = queries->link(queries,
+				    st->global_variables,
+				    st->functions,
+				    st->programs,
+				    st->config,
+				    st->errors);
+
+    if(link_result != ESSTEE_OK)
+    {
+	goto error_free_resources;
+    }
+    
+    int evaluate_result = queries->evaluate(queries,
+					    st->config,
+					    st->errors);
+
+    if(evaluate_result != ESSTEE_OK)
+    {
+	goto error_free_resources;
+    }
+
+    int display_result = queries->display(queries,
+					  output,
+					  output_max_len,
+					  st->config,
+					  st->errors);
+
+    queries->destroy(queries);
+    return display_result;
+    
+error_free_resources:
+    queries->destroy(queries);
+    return ESSTEE_ERROR;    
+}
+
+int st_run_cycle(
+    struct st_t *st,
+    uint64_t ms)
+{
+    return run_cycle(st, ms);
+}
+
+static void timespec_add_ns(
+    struct timespec *ts,
+    uint64_t ns)
+{
+    ns += ts->tv_nsec;
+    ts->tv_sec += ns / 1000000000ULL;
+    ts->tv_nsec = ns % 1000000000ULL;
+}
+
+static int64_t timespec_diff_ns(
+    const struct timespec *later,
+    const struct timespec *earlier)
+{
+    return (int64_t)(later->tv_sec - earlier->tv_sec) * 1000000000LL
+	+ (later->tv_nsec - earlier->tv_nsec);
+}
+
+int st_run_periodic(
+    struct st_t *st,
+    uint64_t period_us,
+    uint64_t cycles,
+    struct st_periodic_report_t *report)
+{
+    struct st_periodic_report_t local_report;
+    if(!report)
+    {
+	report = &local_report;
+    }
+    memset(report, 0, sizeof(struct st_periodic_report_t));
+    
+    if(period_us == 0)
+    {
+	st->errors->new_issue(st->errors,
+			      "the period of a periodic run must be positive",
+			      ESSTEE_ARGUMENT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    st->systime->set_paced(st->systime, ESSTEE_TRUE);
+
+    __atomic_store_n(&(st->stop_periodic), ESSTEE_FALSE, __ATOMIC_SEQ_CST);
+
+    uint64_t period_ns = period_us * 1000;
+    uint64_t total_latency_ns = 0;
+
+    /* Deadlines are absolute and advanced by whole periods, so neither
+     * sleep nor cycle time lateness accumulates */
+    struct timespec deadline, started, finished;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    
+    while(cycles == 0 || report->cycles < cycles)
+    {
+	if(__atomic_load_n(&(st->stop_periodic), __ATOMIC_SEQ_CST))
+	{
+	    break;
+	}
+	
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+	{
+	    /* Interrupted by a signal, sleep for the rest */
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &started);
+	int64_t latency_ns = timespec_diff_ns(&started, &deadline);
+	if(latency_ns < 0)
+	{
+	    latency_ns = 0;
+	}
+
+	int cycle_result = run_cycle(st, 0);
+
+	if(cycle_result != ESSTEE_OK)
+	{
+	    return cycle_result;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &finished);
+
+	report->cycles++;
+	total_latency_ns += latency_ns;
+	if((uint64_t)latency_ns > report->max_latency_ns)
+	{
+	    report->max_latency_ns = latency_ns;
+	}
+	report->mean_latency_ns = total_latency_ns / report->cycles;
+	
+	timespec_add_ns(&deadline, period_ns);
+
+	int64_t late_ns = timespec_diff_ns(&finished, &deadline);
+	if(late_ns > 0)
+	{
+	    /* Start at the first deadline not yet passed */
+	    uint64_t passed = late_ns / period_ns + 1;
+	    
+	    report->overruns++;
+	    report->skipped += passed;
+	    timespec_add_ns(&deadline, passed * period_ns);
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+/* Resolves "[program].variable" or a global "variable", followed by
+ * ".member" for each level of members */
+static struct variable_iface_t * named_variable(
+    struct st_t *st,
+    const char *name)
+{
+    char *path = strdup(name);
+    if(!path)
+    {
+	st->errors->memory_error(st->errors, __FILE__, __FUNCTION__, __LINE__);
+	return NULL;
+    }
+
+    struct variable_iface_t *found = NULL;
+    char *members = NULL;
+    
+    if(path[0] != '[')
+    {
+	members = strchr(path, '.');
+	if(members)
+	{
+	    *members++ = '\0';
+	}
+	HASH_FIND_STR(st->global_variables, path, found);
+    }
+    else
+    {
+	char *end = strchr(path, ']');
+	if(end && end[1] == '.')
+	{
+	    *end = '\0';
+	    char *identifier = end + 2;
+	    members = strchr(identifier, '.');
+	    if(members)
+	    {
+		*members++ = '\0';
+	    }
+	    
+	    struct program_iface_t *program = NULL;
+	    HASH_FIND_STR(st->programs, path + 1, program);
+	    if(program)
+	    {
+		found = program->variable(program, identifier, st->config, st->errors);
+	    }
+	}
+    }
+
+    char *saveptr = NULL;
+    for(char *member = (found && members) ? strtok_r(members, ".", &saveptr) : NULL;
+	found && member != NULL;
+	member = strtok_r(NULL, ".", &saveptr))
+    {
+	found = (found->sub_variable)
+	    ? found->sub_variable(found, NULL, member, st->config, st->errors)
+	    : NULL;
+    }
+    
+    if(!found)
+    {
+	st->errors->new_issue(st->errors,
+			      "no variable named '%s'",
+			      ESSTEE_ARGUMENT_ERROR,
+			      name);
+    }
+
+    free(path);
+    return found;
+}
+
+static int add_all_traced_variables(
+    struct st_t *st,
+    struct trace_recorder_iface_t *trace)
+{
+    struct variable_iface_t *vitr = NULL;
+    DL_FOREACH(st->global_variables, vitr)
+    {
+	if(vitr->checkpoint
+	   && trace->add_variable(trace, vitr->identifier, vitr, st->errors) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+    
+    struct program_iface_t *pitr = NULL;
+    for(pitr = st->programs; pitr != NULL; pitr = pitr->hh.next)
+    {
+	DL_FOREACH(pitr->variables(pitr), vitr)
+	{
+	    if(!vitr->checkpoint)
+	    {
+		continue;
+	    }
+	    
+	    const char *name = st->errors->build_message(st->errors,
+							 "[%s].%s",
+							 pitr->identifier,
+							 vitr->identifier);
+	    
+	    if(trace->add_variable(trace, name, vitr, st->errors) != ESSTEE_OK)
+	    {
+		return ESSTEE_ERROR;
+	    }
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+static int add_traced_variables(
+    struct st_t *st,
+    struct trace_recorder_iface_t *trace,
+    const char *variables)
+{
+    char *names = strdup(variables);
+    if(!names)
+    {
+	st->errors->memory_error(st->errors, __FILE__, __FUNCTION__, __LINE__);
+	return ESSTEE_ERROR;
+    }
+
+    int add_result = ESSTEE_OK;
+    char *saveptr = NULL;
+    for(char *name = strtok_r(names, ";", &saveptr);
+	name != NULL && add_result == ESSTEE_OK;
+	name = strtok_r(NULL, ";", &saveptr))
+    {
+	struct variable_iface_t *variable = named_variable(st, name);
+	add_result = (variable)
+	    ? trace->add_variable(trace, name, variable, st->errors)
+	    : ESSTEE_ERROR;
+    }
+
+    free(names);
+    return add_result;
+}
+
+static int restore_trace(
+    struct st_t *st,
+    const char *path,
+    uint64_t cycle)
+{
+    if(st->needs_linking)
+    {
+	st->errors->new_issue(st->errors,
+			      "cannot restore into an unlinked instance",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    struct trace_reader_iface_t *trace = st_new_trace_reader(path, st->errors);
+    if(!trace)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int restore_result = trace->seek(trace, cycle, st->errors);
+    
+    for(size_t i = 0; i < trace->variable_count(trace) && restore_result == ESSTEE_OK; i++)
+    {
+	struct variable_iface_t *variable =
+	    named_variable(st, trace->variable_name(trace, i));
+
+	restore_result = (variable)
+	    ? trace->restore_variable(trace, i, variable, st->errors)
+	    : ESSTEE_ERROR;
+    }
+
+    if(restore_result == ESSTEE_OK)
+    {
+	st->systime->reset(st->systime);
+	st->systime->add_time_ms(st->systime, trace->time_ms(trace));
+    }
+
+    trace->destroy(trace);
+
+    return restore_result;
+}
+
+int st_trace_start(
+    struct st_t *st,
+    const char *path,
+    const char *variables)
+{
+    if(st->needs_linking)
+    {
+	st->errors->new_issue(st->errors,
+			      "cannot trace an unlinked instance",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    if(st->trace)
+    {
+	st->errors->new_issue(st->errors,
+			      "a trace is already being recorded",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+    
+    struct trace_recorder_iface_t *trace = st_new_trace_recorder(path, st->errors);
+    if(!trace)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int add_result = (variables)
+	? add_traced_variables(st, trace, variables)
+	: add_all_traced_variables(st, trace);
+
+    if(add_result != ESSTEE_OK
+       || trace->begin(trace, st->systime->get_time_ms(st->systime), st->errors) != ESSTEE_OK)
+    {
+	trace->destroy(trace);
+	return ESSTEE_ERROR;
+    }
+
+    st->trace = trace;
+
+    return ESSTEE_OK;
+}
+
+int st_trace_stop(
+    struct st_t *st)
+{
+    if(!st->trace)
+    {
+	return ESSTEE_OK;
+    }
+
+    int end_result = st->trace->end(st->trace, st->errors);
+    st->trace->destroy(st->trace);
+    st->trace = NULL;
+
+    return end_result;
+}
+
+int st_trace_restore(
+    struct st_t *st,
+    const char *path,
+    uint64_t cycle)
+{
+    int restore_result = restore_trace(st, path, cycle);
+    if(restore_result == ESSTEE_OK && st->watcher)
+    {
+	restore_result = st->watcher->notify(st->watcher, st->config, st->errors);
+    }
+
+    return restore_result;
+}
+
+static int state_digest(
+    const struct st_t *st,
+    uint64_t *digest)
+{
+    struct checkpoint_iface_t *checkpoint =
+	st_new_checkpoint_digest(digest, st->errors);
+
+    if(!checkpoint)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int digest_result = checkpoint_values(st, st->errors, checkpoint);
+    checkpoint->destroy(checkpoint);
+
+    return digest_result;
+}
+
+static int fast_forward(
+    struct st_t *st,
+    uint64_t span_ms,
+    uint64_t cycle_ms,
+    struct st_fast_forward_report_t *report)
+{
+    if(cycle_ms == 0)
+    {
+	st->errors->new_issue(st->errors,
+			      "the cycle time of a fast-forward must be positive",
+			      ESSTEE_ARGUMENT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    uint64_t cycles = span_ms / cycle_ms;
+    uint64_t done = 0;
+    uint64_t before = 0, after = 0;
+
+    if(state_digest(st, &before) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+    
+    while(done < cycles)
+    {
+	int cycle_result = run_cycle(st, cycle_ms);
+	if(cycle_result != ESSTEE_OK)
+	{
+	    return cycle_result;
+	}
+
+	done++;
+	report->cycles_run++;
+
+	if(state_digest(st, &after) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+
+	if(after == before && st->cursor->at_cycle_start(st->cursor))
+	{
+	    /* An idle cycle, the cycles up to the one at or after the
+	     * next deadline would be idle as well */
+	    uint64_t skip = cycles - done;
+	    uint64_t deadline = st->systime->next_deadline(st->systime);
+
+	    if(deadline != UINT64_MAX)
+	    {
+		uint64_t now = st->systime->get_time_ms(st->systime);
+		uint64_t until = (deadline > now)
+		    ? (deadline - now + cycle_ms - 1) / cycle_ms
+		    : 0;
+
+		if(until < skip)
+		{
+		    skip = until;
+		}
+	    }
+
+	    st->systime->add_time_ms(st->systime, skip * cycle_ms);
+	    done += skip;
+	    report->cycles_skipped += skip;
+	}
+
+	before = after;
+    }
+
+    return ESSTEE_OK;
+}
+
+int st_watch(
+    struct st_t *st,
+    const char *identifier,
+    st_watch_callback_t callback,
+    void *user_data)
+{
+    if(st->needs_linking)
+    {
+	st->errors->new_issue(st->errors,
+			      "cannot watch an unlinked instance",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    struct variable_iface_t *variable = named_variable(st, identifier);
+    if(!variable)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(!st->watcher)
+    {
+	st->watcher = st_new_watcher(st->errors);
+	if(!st->watcher)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return st->watcher->watch(st->watcher,
+			      identifier,
+			      variable,
+			      callback,
+			      user_data,
+			      st->errors);
+}
+
+int st_unwatch(
+    struct st_t *st,
+    const char *identifier)
+{
+    if(!st->watcher)
+    {
+	st->errors->new_issue(st->errors,
+			      "'%s' is not watched",
+			      ESSTEE_ARGUMENT_ERROR,
+			      identifier);
+	return ESSTEE_ERROR;
+    }
+
+    return st->watcher->unwatch(st->watcher, identifier, st->errors);
+}
+
+int st_fast_forward(
+    struct st_t *st,
+    uint64_t span_ms,
+    uint64_t cycle_ms,
+    struct st_fast_forward_report_t *report)
+{
+    struct st_fast_forward_report_t local_report;
+    if(!report)
+    {
+	report = &local_report;
+    }
+    memset(report, 0, sizeof(struct st_fast_forward_report_t));
+
+    return fast_forward(st, span_ms, cycle_ms, report);
+}
+
+void st_stop_periodic(
+    struct st_t *st)
+{
+    __atomic_store_n(&(st->stop_periodic), ESSTEE_TRUE, __ATOMIC_SEQ_CST);
+}
+
+int st_set_paced(
+    struct st_t *st,
+    int paced)
+{
+    return st->systime->set_paced(st->systime, paced);
+}
+
+int st_checkpoint(
+    struct st_t *st,
+    struct st_buffer_t *buffer)
+{
+    return take_checkpoint(st, st->errors, buffer);
+}
+
+int st_restore(
+    struct st_t *st,
+    const struct st_buffer_t *buffer)
+{
+    int restore_result = restore_checkpoint(st, st->errors, buffer);
+    if(restore_result == ESSTEE_OK && st->watcher)
+    {
+	restore_result = st->watcher->notify(st->watcher, st->config, st->errors);
+    }
+
+    return restore_result;
+}
+
+struct st_t * st_clone_instance(
+    struct st_t *st)
+{
+    struct st_t *clone = NULL;
+    struct st_buffer_t state = { .bytes = NULL, .size = 0, .capacity = 0 };
+
+    if(take_checkpoint(st, st->errors, &state) != ESSTEE_OK)
+    {
+	return NULL;
+    }
+
+    clone = st_new_instance(st->direct_memory_bytes);
+    if(!clone)
+    {
+	st->errors->memory_error(st->errors, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
+
+    st_copy_config(clone->config, st->config);
+
+    /* The clone links its own elements from the same sources, in the
+     * order they were loaded */
+    struct compilation_unit_t *cuitr = NULL;
+    for(cuitr = st->compilation_units; cuitr != NULL; cuitr = cuitr->hh.next)
+    {
+	if(!cuitr->text)
+	{
+	    st->errors->new_issue(st->errors,
+				  "'%s' was loaded in place, its source is not kept for cloning",
+				  ESSTEE_CONTEXT_ERROR,
+				  cuitr->source);
+	    goto error_free_resources;
+	}
+
+	struct compilation_unit_t *cu = st_parse_buffer(cuitr->source,
+							cuitr->text,
+							cuitr->text_size,
+							&(clone->parser));
+	if(!cu)
+	{
+	    st->errors->merge(st->errors, clone->parser.errors);
+	    goto error_free_resources;
+	}
+
+	add_compilation_unit(clone, cu);
+    }
+
+    if(st_link(clone) != ESSTEE_OK
+       || restore_checkpoint(clone, clone->errors, &state) != ESSTEE_OK)
+    {
+	st->errors->merge(st->errors, clone->errors);
+	goto error_free_resources;
+    }
+
+    free(state.bytes);
+    return clone;
+
+error_free_resources:
+    if(clone)
+    {
+	st_destroy(clone);
+    }
+    free(state.bytes);
+    return NULL;
+}
+
+static int start_profiling(
+    struct st_t *st)
+{
+    if(st->needs_linking)
+    {
+	st->errors->new_issue(st->errors,
+			      "cannot profile an unlinked instance",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+    
+    struct profiler_iface_t *profiler = st_new_profiler(st->errors);
+    if(!profiler)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    /* Built-in functions have no location and no statements */
+    struct function_iface_t *fitr = NULL;
+    for(fitr = st->functions; fitr != NULL; fitr = fitr->hh.next)
+    {
+	if(fitr->location && profiler->add_pou(profiler,
+					       ESSTEE_PROFILE_FUNCTION,
+					       fitr->identifier,
+					       fitr->location,
+					       st->errors) != ESSTEE_OK)
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    struct compilation_unit_t *cuitr = NULL;
+    for(cuitr = st->compilation_units; cuitr != NULL; cuitr = cuitr->hh.next)
+    {
+	struct function_block_iface_t *fbitr = NULL;
+	DL_FOREACH(cuitr->function_blocks, fbitr)
+	{
+	    if(profiler->add_pou(profiler,
+				 ESSTEE_PROFILE_FUNCTION_BLOCK,
+				 fbitr->identifier,
+				 fbitr->location,
+				 st->errors) != ESSTEE_OK)
+	    {
+		goto error_free_resources;
+	    }
+	}
+    }
+
+    struct program_iface_t *pitr = NULL;
+    for(pitr = st->programs; pitr != NULL; pitr = pitr->hh.next)
+    {
+	if(profiler->add_pou(profiler,
+			     ESSTEE_PROFILE_PROGRAM,
+			     pitr->identifier,
+			     pitr->location,
+			     st->errors) != ESSTEE_OK)
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    if(st->profiler)
+    {
+	st->profiler->destroy(st->profiler);
+    }
+    st->profiler = profiler;
+    st->cursor->set_profiler(st->cursor, profiler);
+
+    return ESSTEE_OK;
+    
+error_free_resources:
+    profiler->destroy(profiler);
+    return ESSTEE_ERROR;
+}
+
+int st_set_profiling(
+    struct st_t *st,
+    int enabled)
+{
+    int profiling_result = ESSTEE_OK;
+    if(enabled)
+    {
+	profiling_result = start_profiling(st);
+    }
+    else
+    {
+	st->cursor->set_profiler(st->cursor, NULL);
+    }
+
+    return profiling_result;
+}
+
+const struct st_profile_entry_t * st_fetch_profile_entry(
+    struct st_t *st,
+    st_bitflag_t filter)
+{
+    if(!st->profiler)
+    {
+	return NULL;
+    }
+    
+    return st->profiler->fetch_entry(st->profiler, filter);
+}
+
+const struct st_profile_call_t * st_fetch_profile_call(
+    struct st_t *st)
+{
+    if(!st->profiler)
+    {
+	return NULL;
+    }
+    
+    return st->profiler->fetch_call(st->profiler);
+}
+
+int st_set_cycle_limits(
+    struct st_t *st,
+    uint64_t max_steps,
+    uint64_t max_time_ns)
+{
+    st->cursor->set_cycle_limits(st->cursor, max_steps, max_time_ns);
+
+    return ESSTEE_OK;
+}
+
+int st_abort_cycle(
+    struct st_t *st)
+{
+    return st->cursor->abort_cycle(st->cursor,
+				   st->config,
+				   st->errors);
+}
+
+const struct st_cycle_stats_t * st_cycle_stats(
+    struct st_t *st)
+{
+    return st->cycle_stats->summary(st->cycle_stats);
+}
+
+void st_set_cycle_budget(
+    struct st_t *st,
+    uint64_t budget_ns)
+{
+    st->cycle_stats->set_budget(st->cycle_stats, budget_ns);
+}
+
+void st_reset_cycle_stats(
+    struct st_t *st)
+{
+    st->cycle_stats->reset(st->cycle_stats);
+}
+
+typedef struct invoke_iface_t * (*cursor_step_t)(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues);
+
+static const struct st_location_t * step(
+    struct st_t *st,
+    size_t step_offset)
+{
+    if(!st->main)
+    {
+	st->errors->new_issue(st->errors,
+			      "no program started",
+			      ESSTEE_CONTEXT_ERROR);
+	return NULL;
+    }
+
+    int was_at_cycle_start = st->cursor->at_cycle_start(st->cursor);
+    
+    cursor_step_t *step_function =
+	(cursor_step_t *)(((char *)st->cursor) + step_offset);
+
+    st->cursor->arm_watchdog(st->cursor);
+    struct invoke_iface_t *current = (*step_function)(st->cursor,
+						      st->systime,
+						      st->config,
+						      st->errors);
+    if(!current)
+    {
+	return NULL;
+    }
+
+    /* Stepping does not pass any time, but a completed cycle is still
+     * reported to the trace and the watches */
+    if(!was_at_cycle_start && st->cursor->at_cycle_start(st->cursor))
+    {
+	if(finish_cycle(st, 0) != ESSTEE_OK)
+	{
+	    return NULL;
+	}
+    }
+
+    return current->location;
+}
+
+const struct st_location_t * st_step(
+    struct st_t *st)
+{
+    return step(st, offsetof(struct cursor_iface_t, step));
+}
+
+const struct st_location_t * st_step_in(
+    struct st_t *st)
+{
+    return step(st, offsetof(struct cursor_iface_t, step_in));
+}
+
+const struct st_location_t * st_step_out(
+    struct st_t *st)
+{
+    return step(st, offsetof(struct cursor_iface_t, step_out));
+}
+
+const struct st_location_t * st_location(
+    struct st_t *st)
+{
+    if(!st->main)
+    {
+	return NULL;
+    }
+
+    return st->cursor->current_location(st->cursor);
+}
+
+/* A condition is parsed as a query of its own, linked to the given
+ * variables, so evaluating it at a breakpoint does not involve the
+ * parser */
+static struct queries_iface_t * compile_condition(
+    struct st_t *st,
+    const char *condition,
+    struct variable_iface_t *variables)
+{
+    struct queries_iface_t *queries = NULL;
+    char *query_string = NULL;
+    
+    size_t query_string_size = strlen(condition) + 3;
+    ALLOC_ARRAY_OR_ERROR_JUMP(
+	query_string,
+	char,
+	query_string_size,
+	st->errors,
+	error_free_resources);
+
+    snprintf(query_string, query_string_size, "? %s", condition);
+    
+    queries = st_parse_query_string(query_string, &(st->parser));
+    if(!queries)
+    {
+	st->errors->merge(st->errors, st->parser.errors);
+	goto error_free_resources;
+    }
+
+    int link_result = queries->link(queries,
+				    variables,
+				    st->functions,
+				    st->programs,
+				    st->config,
+				    st->errors);
+    if(link_result != ESSTEE_OK)
+    {
+	goto error_free_resources;
+    }
+
+    free(query_string);
+    return queries;
+
+error_free_resources:
+    if(queries)
+    {
+	queries->destroy(queries);
+    }
+    free(query_string);
+    return NULL;
+}
+
+int st_set_breakpoint(
+    struct st_t *st,
+    const char *source,
+    int line,
+    const char *condition)
+{
+    if(!st->main)
+    {
+	st->errors->new_issue(st->errors,
+			      "breakpoints need a started program",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    struct queries_iface_t *compiled_condition = NULL;
+    if(condition)
+    {
+	compiled_condition = compile_condition(st,
+					       condition,
+					       st->main->variables(st->main));
+	if(!compiled_condition)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    if(!st->breakpoints)
+    {
+	st->breakpoints = st_new_breakpoints(st->errors);
+	if(!st->breakpoints)
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    int set_result = st->breakpoints->set(st->breakpoints,
+					  source,
+					  line,
+					  compiled_condition,
+					  st->errors);
+    if(set_result != ESSTEE_OK)
+    {
+	goto error_free_resources;
+    }
+
+    return ESSTEE_OK;
+
+error_free_resources:
+    if(compiled_condition)
+    {
+	compiled_condition->destroy(compiled_condition);
+    }
+    return ESSTEE_ERROR;
+}
+
+int st_clear_breakpoint(
+    struct st_t *st,
+    const char *source,
+    int line)
+{
+    if(!st->breakpoints)
+    {
+	st->errors->new_issue(st->errors,
+			      "no breakpoint set on line %d",
+			      ESSTEE_ARGUMENT_ERROR,
+			      line);
+	return ESSTEE_ERROR;
+    }
+
+    return st->breakpoints->clear(st->breakpoints, source, line, st->errors);
+}
+
+/* Gives the element of the variable at the subscript, a list of
+ * integers separated by ',' */
+static const struct value_iface_t * subscript_element(
+    struct st_t *st,
+    struct variable_iface_t *variable,
+    char *subscript)
+{
+    struct st_location_t location;
+    memset(&location, 0, sizeof(struct st_location_t));
+
+    struct array_index_iface_t *index = st_create_array_index(st->config,
+							       st->errors);
+    if(!index)
+    {
+	return NULL;
+    }
+
+    const struct value_iface_t *element = NULL;
+    
+    char *saveptr = NULL;
+    for(char *number = strtok_r(subscript, ",", &saveptr);
+	number != NULL;
+	number = strtok_r(NULL, ",", &saveptr))
+    {
+	char *end = NULL;
+	long long n = strtoll(number, &end, 10);
+	if(end == number || *end != '\0')
+	{
+	    st->errors->new_issue(st->errors,
+				  "invalid array index '%s'",
+				  ESSTEE_ARGUMENT_ERROR,
+				  number);
+	    goto error_free_resources;
+	}
+
+	struct value_iface_t *value = st_new_typeless_integer_value(n,
+								    CONSTANT_VALUE,
+								    st->config,
+								    st->errors);
+	if(!value)
+	{
+	    goto error_free_resources;
+	}
+
+	struct expression_iface_t *expression =
+	    st_create_value_expression(value, &location, st->config, st->errors);
+	if(!expression)
+	{
+	    value->destroy(value);
+	    goto error_free_resources;
+	}
+
+	if(index->extend(index, expression, &location, st->config, st->errors) != ESSTEE_OK)
+	{
+	    expression->destroy(expression);
+	    goto error_free_resources;
+	}
+    }
+
+    if(!index->first_node)
+    {
+	st->errors->new_issue(st->errors,
+			      "an empty array index is not an element",
+			      ESSTEE_ARGUMENT_ERROR);
+    }
+    else if(!variable->index_value)
+    {
+	st->errors->new_issue(st->errors,
+			      "variable '%s' cannot be indexed",
+			      ESSTEE_ARGUMENT_ERROR,
+			      variable->identifier);
+    }
+    else
+    {
+	element = variable->index_value(variable, index, st->config, st->errors);
+    }
+
+error_free_resources:
+    index->destroy(index);
+    return element;
+}
+
+/* A watchpoint is set on a variable named as by st_watch, where the
+ * last part may have an array index, e.g. "[prog].table[2,3]" */
+int st_set_watchpoint(
+    struct st_t *st,
+    const char *target,
+    const char *condition)
+{
+    if(st->needs_linking)
+    {
+	st->errors->new_issue(st->errors,
+			      "cannot set a watchpoint in an unlinked instance",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    struct queries_iface_t *compiled_condition = NULL;
+    
+    char *path = strdup(target);
+    if(!path)
+    {
+	st->errors->memory_error(st->errors, __FILE__, __FUNCTION__, __LINE__);
+	return ESSTEE_ERROR;
+    }
+
+    /* The program of a path is given in brackets first */
+    char *subscript = strrchr(path, '[');
+    if(subscript == path)
+    {
+	subscript = NULL;
+    }
+    else if(subscript)
+    {
+	size_t subscript_length = strlen(subscript);
+	if(subscript[subscript_length-1] != ']')
+	{
+	    st->errors->new_issue(st->errors,
+				  "invalid array index in '%s'",
+				  ESSTEE_ARGUMENT_ERROR,
+				  target);
+	    goto error_free_resources;
+	}
+
+	subscript[subscript_length-1] = '\0';
+	*subscript++ = '\0';
+    }
+
+    struct variable_iface_t *variable = named_variable(st, path);
+    if(!variable)
+    {
+	goto error_free_resources;
+    }
+
+    const struct value_iface_t *element = NULL;
+    if(subscript)
+    {
+	element = subscript_element(st, variable, subscript);
+	if(!element)
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    if(condition)
+    {
+	/* The condition is given in the scope of the variable */
+	struct variable_iface_t *scope = st->global_variables;
+	if(path[0] == '[')
+	{
+	    struct program_iface_t *program = NULL;
+	    char *end = strchr(path, ']');
+	    *end = '\0';
+	    HASH_FIND_STR(st->programs, path + 1, program);
+	    scope = program->variables(program);
+	}
+	
+	compiled_condition = compile_condition(st, condition, scope);
+	if(!compiled_condition)
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    if(!st->breakpoints)
+    {
+	st->breakpoints = st_new_breakpoints(st->errors);
+	if(!st->breakpoints)
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    int watch_result = st->breakpoints->watch(st->breakpoints,
+					      target,
+					      variable,
+					      element,
+					      compiled_condition,
+					      st->errors);
+    if(watch_result != ESSTEE_OK)
+    {
+	goto error_free_resources;
+    }
+
+    free(path);
+    return ESSTEE_OK;
+    
+error_free_resources:
+    if(compiled_condition)
+    {
+	compiled_condition->destroy(compiled_condition);
+    }
+    free(path);
+    return ESSTEE_ERROR;
+}
+
+int st_clear_watchpoint(
+    struct st_t *st,
+    const char *target)
+{
+    if(!st->breakpoints)
+    {
+	st->errors->new_issue(st->errors,
+			      "no watchpoint set on '%s'",
+			      ESSTEE_ARGUMENT_ERROR,
+			      target);
+	return ESSTEE_ERROR;
+    }
+
+    return st->breakpoints->unwatch(st->breakpoints, target, st->errors);
+}
+
+int st_continue(
+    struct st_t *st,
+    uint64_t ms,
+    uint64_t max_cycles)
+{
+    if(!st->breakpoints || st->breakpoints->count(st->breakpoints) == 0)
+    {
+	if(max_cycles == 0)
+	{
+	    st->errors->new_issue(st->errors,
+				  "no breakpoints set, and no cycle limit given",
+				  ESSTEE_ARGUMENT_ERROR);
+	    return ESSTEE_ERROR;
+	}
+
+	/* Nothing to stop at, the cycles are run as usual */
+	for(uint64_t i = 0; i < max_cycles; i++)
+	{
+	    if(run_cycle(st, ms) != ESSTEE_OK)
+	    {
+		return ESSTEE_ERROR;
+	    }
+	}
+
+	return ESSTEE_FALSE;
+    }
+
+    if(!st->main)
+    {
+	st->errors->new_issue(st->errors,
+			      "no program started",
+			      ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    /* Only writes made while continuing hit watchpoints */
+    st->breakpoints->forget_writes(st->breakpoints);
+    
+    uint64_t cycles = 0;
+    while(1)
+    {
+	if(st->cursor->at_cycle_start(st->cursor))
+	{
+	    st->systime->clear_deadlines(st->systime);
+	}
+
+	st->cursor->arm_watchdog(st->cursor);
+	int run_result = st->cursor->run_to_breakpoint(st->cursor,
+						       st->breakpoints,
+						       st->systime,
+						       st->config,
+						       st->errors);
+	if(run_result != ESSTEE_FALSE)
+	{
+	    return run_result;
+	}
+
+	if(finish_cycle(st, ms) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+	cycles++;
+
+	/* A hit by the last statement of the cycle, or at the first
+	 * statement of the next, which is not stepped onto, leaves
+	 * the program at the start of the next cycle */
+	int hit_result = st->breakpoints->written(st->breakpoints,
+						  st->systime,
+						  st->config,
+						  st->errors);
+	if(hit_result == ESSTEE_FALSE)
+	{
+	    hit_result = st->breakpoints->hit(st->breakpoints,
+					      st->cursor->current_location(st->cursor),
+					      st->systime,
+					      st->config,
+					      st->errors);
+	}
+
+	if(hit_result != ESSTEE_FALSE)
+	{
+	    return hit_result;
+	}
+	
+	if(max_cycles > 0 && cycles >= max_cycles)
+	{
+	    return ESSTEE_FALSE;
+	}
+    }
+}
+
+int st_step_time(
+    struct st_t *st,
+    uint64_t ms)
+{
+    st->systime->add_time_ms(st->systime, ms);
+
+    return ESSTEE_OK;
+}
+
+
+void st_destroy(struct st_t *st)
+{
+    /* Ending a trace reports to the issue context, so the trace goes
+     * before the contexts */
+    st_trace_stop(st);
+    drop_watches(st);
+    drop_breakpoints(st);
+
+    if(st->profiler)
+    {
+	st->profiler->destroy(st->profiler);
+    }
+
+    struct compilation_unit_t *cuitr = NULL, *tmp = NULL;
+    HASH_ITER(hh, st->compilation_units, cuitr, tmp)
+    {
+	HASH_DEL(st->compilation_units, cuitr);
+	st_destroy_compilation_unit(cuitr);
+    }
+
+    yylex_destroy(st->parser.yyscanner);
+    st->parser.errors->destroy(st->parser.errors, ESSTEE_FILTER_ANY_ISSUE);
+
+    st->cycle_stats->destroy(st->cycle_stats);
+    st->cursor->destroy(st->cursor);
+    st->systime->destroy(st->systime);
+    st->direct_memory->destroy(st->direct_memory);
+    st_destroy_config(st->config);
+    st->errors->destroy(st->errors, ESSTEE_FILTER_ANY_ISSUE);
+
+    /* TODO: destructors for the linked elements */
+    free(st);
+}
+
+static void reset_linking(
+    struct st_t *st)
+{
+    struct compilation_unit_t *cuitr = NULL;
+    for(cuitr = st->compilation_units; cuitr != NULL; cuitr = cuitr->hh.next)
+    {
+	unlink_compilation_unit(st, cuitr);
+    }
+}
+
+static void drop_watches(
+    struct st_t *st)
+{
+    if(st->watcher)
+    {
+	st->watcher->destroy(st->watcher);
+	st->watcher = NULL;
+    }
+}
+
+static void drop_breakpoints(
+    struct st_t *st)
+{
+    if(st->breakpoints)
+    {
+	st->breakpoints->destroy(st->breakpoints);
+	st->breakpoints = NULL;
+    }
 }
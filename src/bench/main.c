@@ -0,0 +1,291 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee.
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Runs each given workload file in a process of its own, measuring
+ * parse and link time, first cycle latency, steady state cycles per
+ * second and peak memory use, and prints the results as JSON */
+
+#include <esstee/esstee.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define CYCLES 1
+#define PROGRAM 2
+
+#define CYCLE_TIME_MS 10
+
+static struct option long_options[] = {
+    {"cycles", required_argument, NULL, CYCLES},
+    {"program", required_argument, NULL, PROGRAM},
+    {0, 0, 0, 0}
+};
+
+struct bench_result_t {
+    double parse_ms;
+    double link_ms;
+    double first_cycle_us;
+    double cycles_per_sec;
+    long peak_rss_kb;
+    char error[256];
+};
+
+static double elapsed_ns(const struct timespec *start,
+			 const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) * 1e9
+	+ (double)(end->tv_nsec - start->tv_nsec);
+}
+
+static void first_error(struct st_t *st,
+			const char *what,
+			struct bench_result_t *result) {
+    const struct st_issue_t *issue = st_fetch_issue(st, ESSTEE_FILTER_ANY_ERROR);
+    snprintf(result->error,
+	     sizeof(result->error),
+	     "%s: %s",
+	     what,
+	     (issue) ? issue->message : "unknown error");
+}
+
+static void run_workload(const char *file,
+			 const char *program,
+			 int cycles,
+			 struct bench_result_t *result) {
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    struct st_t *st = st_new_instance(1024);
+    if(!st) {
+	snprintf(result->error, sizeof(result->error), "could not create instance");
+	return;
+    }
+
+    if(st_load_file(st, file) != ESSTEE_OK) {
+	first_error(st, "load failed", result);
+	return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result->parse_ms = elapsed_ns(&start, &end) / 1e6;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(st_link(st) != ESSTEE_OK) {
+	first_error(st, "link failed", result);
+	return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result->link_ms = elapsed_ns(&start, &end) / 1e6;
+
+    if(!st_start(st, program)) {
+	first_error(st, "start failed", result);
+	return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(st_run_cycle(st, CYCLE_TIME_MS) != ESSTEE_OK) {
+	first_error(st, "first cycle failed", result);
+	return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result->first_cycle_us = elapsed_ns(&start, &end) / 1e3;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < cycles; i++) {
+	if(st_run_cycle(st, CYCLE_TIME_MS) != ESSTEE_OK) {
+	    first_error(st, "cycle failed", result);
+	    return;
+	}
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double run_ns = elapsed_ns(&start, &end);
+    result->cycles_per_sec = (run_ns > 0.0) ? cycles * 1e9 / run_ns : 0.0;
+
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0) {
+	result->peak_rss_kb = usage.ru_maxrss;
+    }
+}
+
+/* Runs the workload in a child, so a crash is reported instead of
+ * ending the suite, and the peak memory use is the workload's own */
+static int bench_file(const char *file,
+		      const char *program,
+		      int cycles,
+		      struct bench_result_t *result) {
+    memset(result, 0, sizeof(struct bench_result_t));
+
+    int fds[2];
+    if(pipe(fds) != 0) {
+	snprintf(result->error, sizeof(result->error), "could not create pipe");
+	return EXIT_FAILURE;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if(pid < 0) {
+	close(fds[0]);
+	close(fds[1]);
+	snprintf(result->error, sizeof(result->error), "could not fork");
+	return EXIT_FAILURE;
+    }
+
+    if(pid == 0) {
+	close(fds[0]);
+	run_workload(file, program, cycles, result);
+	ssize_t written = write(fds[1], result, sizeof(struct bench_result_t));
+	_exit((written == sizeof(struct bench_result_t)) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(fds[1]);
+    ssize_t bytes_read = read(fds[0], result, sizeof(struct bench_result_t));
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    if(bytes_read != sizeof(struct bench_result_t)) {
+	memset(result, 0, sizeof(struct bench_result_t));
+	if(WIFSIGNALED(status)) {
+	    snprintf(result->error,
+		     sizeof(result->error),
+		     "workload terminated by signal %d",
+		     WTERMSIG(status));
+	}
+	else {
+	    snprintf(result->error, sizeof(result->error), "workload gave no result");
+	}
+    }
+
+    return (result->error[0] == '\0') ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void print_json_string(const char *string) {
+    putchar('"');
+    for(const char *c = string; *c != '\0'; c++) {
+	if(*c == '"' || *c == '\\') {
+	    putchar('\\');
+	    putchar(*c);
+	}
+	else if((unsigned char)*c < 0x20) {
+	    printf("\\u%04x", (unsigned char)*c);
+	}
+	else {
+	    putchar(*c);
+	}
+    }
+    putchar('"');
+}
+
+static void print_workload_name(const char *file) {
+    const char *name = strrchr(file, '/');
+    name = (name) ? name + 1 : file;
+
+    const char *suffix = strrchr(name, '.');
+    int length = (suffix) ? (int)(suffix - name) : (int)strlen(name);
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%.*s", length, name);
+    print_json_string(buffer);
+}
+
+int main(int argc, char * const argv[])
+{
+    /* Default options */
+    const char *program = "main";
+    int cycles = 1000;
+
+    int argument_parsing = 1;
+    while(argument_parsing)
+    {
+	int c = getopt_long_only(argc, argv, "", long_options, NULL);
+
+	switch(c)
+	{
+	case -1:
+	    argument_parsing = 0;
+	    break;
+
+	case CYCLES:
+	    cycles = atoi(optarg);
+	    break;
+
+	case PROGRAM:
+	    program = optarg;
+	    break;
+
+	default:
+	    break;
+	}
+    }
+
+    if(optind >= argc) {
+	fprintf(stderr, "no workload files given\n");
+	return EXIT_FAILURE;
+    }
+
+    if(cycles < 1) {
+	fprintf(stderr, "the number of cycles must be at least 1\n");
+	return EXIT_FAILURE;
+    }
+
+    int exit_status = EXIT_SUCCESS;
+
+    printf("{\n  \"cycles\": %d,\n  \"cycle_time_ms\": %d,\n  \"workloads\": [\n",
+	   cycles,
+	   CYCLE_TIME_MS);
+
+    for(int i = optind; i < argc; i++) {
+	struct bench_result_t result;
+	if(bench_file(argv[i], program, cycles, &result) != EXIT_SUCCESS) {
+	    exit_status = EXIT_FAILURE;
+	}
+
+	printf("    {\"name\": ");
+	print_workload_name(argv[i]);
+	printf(", \"file\": ");
+	print_json_string(argv[i]);
+
+	if(result.error[0] != '\0') {
+	    printf(", \"error\": ");
+	    print_json_string(result.error);
+	}
+	else {
+	    printf(", \"parse_ms\": %.3f, \"link_ms\": %.3f, \"first_cycle_us\": %.1f"
+		   ", \"cycles_per_sec\": %.1f, \"peak_rss_kb\": %ld",
+		   result.parse_ms,
+		   result.link_ms,
+		   result.first_cycle_us,
+		   result.cycles_per_sec,
+		   result.peak_rss_kb);
+	}
+
+	printf("}%s\n", (i + 1 < argc) ? "," : "");
+    }
+
+    printf("  ]\n}\n");
+
+    return exit_status;
+}
@@ -0,0 +1,551 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee.
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Measures ns/op of the value and type operations of every
+ * elementary type, an enumerated and a subrange type, and of the
+ * named reference pool and issue context. Each measurement is the
+ * fastest of a number of repeats of a fixed iteration count, so runs
+ * on the same machine can be compared */
+
+#define _GNU_SOURCE
+
+#include <elements/types.h>
+#include <elements/integers.h>
+#include <elements/enums.h>
+#include <elements/subrange.h>
+#include <util/config.h>
+#include <util/issue_context.h>
+#include <util/named_ref_pool.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <getopt.h>
+#include <utlist.h>
+
+#define ITERATIONS 1
+#define REPEATS 2
+#define CPU 3
+
+/* Value destructors are not implemented yet, so operations
+ * allocating values run fewer iterations to bound memory use */
+#define ALLOCATING_ITERATIONS_DIVISOR 100
+
+/* References and issues are measured in batches, each batch using a
+ * new pool or issue context */
+#define BATCH_SIZE 1000
+
+static struct option long_options[] = {
+    {"iterations", required_argument, NULL, ITERATIONS},
+    {"repeats", required_argument, NULL, REPEATS},
+    {"cpu", required_argument, NULL, CPU},
+    {0, 0, 0, 0}
+};
+
+struct subject_t {
+    const char *name;
+    struct type_iface_t *type;
+    struct value_iface_t *value;
+    struct value_iface_t *other_value;
+};
+
+struct micro_t {
+    struct config_iface_t *config;
+    struct issues_iface_t *issues;
+    long iterations;
+    int repeats;
+    int first_result;
+};
+
+typedef int (*value_operation_t)(
+    struct subject_t *subject,
+    struct micro_t *micro);
+
+static struct st_location_t bench_location = {
+    .source = "micro",
+    .first_line = 1,
+    .first_column = 1,
+    .last_line = 1,
+    .last_column = 1,
+    .prev = NULL,
+    .next = NULL,
+};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void print_result(struct micro_t *micro,
+			 const char *subject,
+			 const char *operation,
+			 double ns_per_op) {
+    printf("%s    {\"subject\": \"%s\", \"operation\": \"%s\", \"ns_per_op\": %.2f}",
+	   (micro->first_result) ? "" : ",\n",
+	   subject,
+	   operation,
+	   ns_per_op);
+    micro->first_result = 0;
+}
+
+/**************************************************************************/
+/* Value and type operations                                              */
+/**************************************************************************/
+static int op_assign(struct subject_t *s, struct micro_t *micro) {
+    return s->value->assign(s->value, s->other_value, micro->config, micro->issues);
+}
+
+static int op_compare(struct subject_t *s, struct micro_t *micro) {
+    return s->value->equals(s->value, s->other_value, micro->config, micro->issues);
+}
+
+static int op_plus(struct subject_t *s, struct micro_t *micro) {
+    return s->value->plus(s->value, s->other_value, micro->config, micro->issues);
+}
+
+static int op_and(struct subject_t *s, struct micro_t *micro) {
+    return s->value->and(s->value, s->other_value, micro->config, micro->issues);
+}
+
+static int op_create_temp_from(struct subject_t *s, struct micro_t *micro) {
+    struct value_iface_t *temporary = s->value->create_temp_from(s->value, micro->issues);
+    if(!temporary)
+    {
+	return ESSTEE_ERROR;
+    }
+    temporary->destroy(temporary);
+    return ESSTEE_OK;
+}
+
+static int op_can_hold(struct subject_t *s, struct micro_t *micro) {
+    return s->type->can_hold(s->type, s->other_value, micro->config, micro->issues);
+}
+
+static int op_display(struct subject_t *s, struct micro_t *micro) {
+    char buffer[128];
+    return s->value->display(s->value, buffer, sizeof(buffer), micro->config);
+}
+
+static void measure_value_operation(struct micro_t *micro,
+				    struct subject_t *subject,
+				    const char *operation_name,
+				    value_operation_t operation,
+				    long iterations) {
+    /* A first call outside the measurement, both to warm up and to
+     * leave out operations which fail for the subject */
+    int probe_result = operation(subject, micro);
+    int failed = (probe_result == ESSTEE_ERROR)
+	|| micro->issues->unfetched_issues(micro->issues, ESSTEE_FILTER_ANY_ERROR) > 0;
+
+    while(micro->issues->fetch_and_ignore(micro->issues, ESSTEE_FILTER_ANY_ISSUE))
+    {
+	;
+    }
+
+    if(failed)
+    {
+	fprintf(stderr, "%s %s: failed, not measured\n", subject->name, operation_name);
+	return;
+    }
+
+    double best_ns = -1.0;
+    for(int r = 0; r < micro->repeats; r++) {
+	double start = now_ns();
+	for(long i = 0; i < iterations; i++) {
+	    operation(subject, micro);
+	}
+	double run_ns = now_ns() - start;
+
+	if(best_ns < 0.0 || run_ns < best_ns) {
+	    best_ns = run_ns;
+	}
+    }
+
+    print_result(micro, subject->name, operation_name, best_ns / (double)iterations);
+}
+
+static void measure_subject(struct micro_t *micro,
+			    struct subject_t *subject) {
+    /* Only operations the value or type implements are measured */
+    if(subject->value->assign) {
+	measure_value_operation(micro, subject, "assign", op_assign, micro->iterations);
+    }
+
+    if(subject->value->equals) {
+	measure_value_operation(micro, subject, "compare", op_compare, micro->iterations);
+    }
+
+    if(subject->value->plus) {
+	measure_value_operation(micro, subject, "plus", op_plus, micro->iterations);
+    }
+    else if(subject->value->and) {
+	measure_value_operation(micro, subject, "and", op_and, micro->iterations);
+    }
+
+    if(subject->value->create_temp_from) {
+	long allocating_iterations = micro->iterations / ALLOCATING_ITERATIONS_DIVISOR;
+	measure_value_operation(micro,
+				subject,
+				"create_temp_from",
+				op_create_temp_from,
+				(allocating_iterations > 0) ? allocating_iterations : 1);
+    }
+
+    if(subject->type->can_hold) {
+	measure_value_operation(micro, subject, "can_hold", op_can_hold, micro->iterations);
+    }
+
+    if(subject->value->display) {
+	measure_value_operation(micro, subject, "display", op_display, micro->iterations);
+    }
+}
+
+static int init_subject(struct micro_t *micro,
+			struct subject_t *subject,
+			const char *name,
+			struct type_iface_t *type) {
+    subject->name = name;
+    subject->type = type;
+    subject->value = type->create_value_of(type, micro->config, micro->issues);
+    subject->other_value = type->create_value_of(type, micro->config, micro->issues);
+
+    if(!subject->value || !subject->other_value) {
+	return ESSTEE_ERROR;
+    }
+
+    /* As for variables, values get their defaults when reset */
+    if(type->reset_value_of(type, subject->value, micro->config, micro->issues) != ESSTEE_OK
+       || type->reset_value_of(type, subject->other_value, micro->config, micro->issues) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
+}
+
+static void measure_elementary_types(struct micro_t *micro,
+				     struct type_iface_t *types) {
+    struct type_iface_t *itr = NULL;
+    DL_FOREACH(types, itr)
+    {
+	struct subject_t subject;
+	if(init_subject(micro, &subject, itr->identifier, itr) != ESSTEE_OK) {
+	    fprintf(stderr, "%s: could not create values\n", itr->identifier);
+	    continue;
+	}
+
+	measure_subject(micro, &subject);
+    }
+}
+
+static void measure_enum_type(struct micro_t *micro) {
+    struct enum_group_iface_t *group = st_create_enum_group(micro->config, micro->issues);
+    if(!group) {
+	return;
+    }
+
+    const char *items[] = {"IDLE", "RUNNING", "STOPPED"};
+    for(size_t i = 0; i < sizeof(items)/sizeof(items[0]); i++) {
+	char *identifier = strdup(items[i]);
+	if(!identifier
+	   || group->extend(group, identifier, &bench_location, micro->config, micro->issues) != ESSTEE_OK) {
+	    fprintf(stderr, "enum: could not create group\n");
+	    return;
+	}
+    }
+
+    struct type_iface_t *type = st_create_enum_type(group,
+						    "RUNNING",
+						    &bench_location,
+						    micro->config,
+						    micro->issues);
+
+    struct subject_t subject;
+    if(!type || init_subject(micro, &subject, "enum", type) != ESSTEE_OK) {
+	fprintf(stderr, "enum: could not create values\n");
+	return;
+    }
+
+    measure_subject(micro, &subject);
+}
+
+static void measure_subrange_type(struct micro_t *micro,
+				  struct type_iface_t *types) {
+    struct type_iface_t *storage_type = NULL;
+    struct type_iface_t *itr = NULL;
+    DL_FOREACH(types, itr)
+    {
+	if(strcmp(itr->identifier, "INT") == 0) {
+	    storage_type = itr;
+	}
+    }
+
+    struct named_ref_pool_iface_t *type_refs = st_new_named_ref_pool(micro->issues);
+    struct value_iface_t *min = st_new_typeless_integer_value(-1000, 0, micro->config, micro->issues);
+    struct value_iface_t *max = st_new_typeless_integer_value(1000, 0, micro->config, micro->issues);
+    char *storage_identifier = strdup("INT");
+
+    if(!storage_type || !type_refs || !min || !max || !storage_identifier) {
+	fprintf(stderr, "subrange: could not create type\n");
+	return;
+    }
+
+    struct subrange_iface_t *subrange = st_create_subrange(min,
+							   &bench_location,
+							   max,
+							   &bench_location,
+							   &bench_location,
+							   micro->config,
+							   micro->issues);
+
+    struct type_iface_t *type = (!subrange) ? NULL : st_create_subrange_type(
+	storage_identifier,
+	&bench_location,
+	subrange,
+	NULL,
+	NULL,
+	type_refs,
+	micro->config,
+	micro->issues);
+
+    if(!type
+       || type_refs->resolve(type_refs, "INT", storage_type) != ESSTEE_OK
+       || type_refs->trigger_resolve_callbacks(type_refs, micro->config, micro->issues) != ESSTEE_OK) {
+	fprintf(stderr, "subrange: could not create type\n");
+	return;
+    }
+
+    struct subject_t subject;
+    if(init_subject(micro, &subject, "subrange", type) != ESSTEE_OK) {
+	fprintf(stderr, "subrange: could not create values\n");
+	return;
+    }
+
+    measure_subject(micro, &subject);
+}
+
+/**************************************************************************/
+/* Named reference pool and issue context                                 */
+/**************************************************************************/
+static int bench_resolved(
+    void *referrer,
+    void *target,
+    st_bitflag_t remark,
+    const char *identifier,
+    const struct st_location_t *location,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    *((void **)referrer) = target;
+    return ESSTEE_OK;
+}
+
+static void measure_named_ref_pool(struct micro_t *micro) {
+    static char identifiers[BATCH_SIZE][16];
+    static void *referrers[BATCH_SIZE];
+
+    for(int i = 0; i < BATCH_SIZE; i++) {
+	snprintf(identifiers[i], sizeof(identifiers[i]), "var_%d", i);
+    }
+
+    long batches = micro->iterations / (BATCH_SIZE * ALLOCATING_ITERATIONS_DIVISOR);
+    batches = (batches > 0) ? batches : 1;
+
+    double best_add_ns = -1.0, best_resolve_ns = -1.0, best_trigger_ns = -1.0;
+    for(int r = 0; r < micro->repeats; r++) {
+	double add_ns = 0.0, resolve_ns = 0.0, trigger_ns = 0.0;
+
+	for(long b = 0; b < batches; b++) {
+	    struct named_ref_pool_iface_t *pool = st_new_named_ref_pool(micro->issues);
+	    if(!pool) {
+		return;
+	    }
+
+	    double start = now_ns();
+	    for(int i = 0; i < BATCH_SIZE; i++) {
+		pool->add(pool,
+			  identifiers[i],
+			  &(referrers[i]),
+			  &bench_location,
+			  bench_resolved,
+			  micro->issues);
+	    }
+	    double after_add = now_ns();
+
+	    for(int i = 0; i < BATCH_SIZE; i++) {
+		pool->resolve(pool, identifiers[i], identifiers[i]);
+	    }
+	    double after_resolve = now_ns();
+
+	    pool->trigger_resolve_callbacks(pool, micro->config, micro->issues);
+	    double after_trigger = now_ns();
+
+	    pool->destroy(pool);
+
+	    add_ns += after_add - start;
+	    resolve_ns += after_resolve - after_add;
+	    trigger_ns += after_trigger - after_resolve;
+	}
+
+	if(best_add_ns < 0.0 || add_ns < best_add_ns) {
+	    best_add_ns = add_ns;
+	}
+	if(best_resolve_ns < 0.0 || resolve_ns < best_resolve_ns) {
+	    best_resolve_ns = resolve_ns;
+	}
+	if(best_trigger_ns < 0.0 || trigger_ns < best_trigger_ns) {
+	    best_trigger_ns = trigger_ns;
+	}
+    }
+
+    double references = (double)batches * BATCH_SIZE;
+    print_result(micro, "named_ref_pool", "add", best_add_ns / references);
+    print_result(micro, "named_ref_pool", "resolve", best_resolve_ns / references);
+    print_result(micro, "named_ref_pool", "trigger_resolve_callbacks", best_trigger_ns / references);
+}
+
+static void measure_issue_context(struct micro_t *micro) {
+    long batches = micro->iterations / (BATCH_SIZE * ALLOCATING_ITERATIONS_DIVISOR);
+    batches = (batches > 0) ? batches : 1;
+
+    double best_new_ns = -1.0, best_fetch_ns = -1.0;
+    for(int r = 0; r < micro->repeats; r++) {
+	double new_ns = 0.0, fetch_ns = 0.0;
+
+	for(long b = 0; b < batches; b++) {
+	    struct issues_iface_t *issues = st_new_issue_context();
+	    if(!issues) {
+		return;
+	    }
+
+	    double start = now_ns();
+	    for(int i = 0; i < BATCH_SIZE; i++) {
+		issues->new_issue(issues,
+				  "issue number %d",
+				  ESSTEE_CONTEXT_ERROR,
+				  i);
+	    }
+	    double after_new = now_ns();
+
+	    while(issues->fetch(issues, ESSTEE_FILTER_ANY_ISSUE))
+	    {
+		;
+	    }
+	    double after_fetch = now_ns();
+
+	    issues->destroy(issues, ESSTEE_FILTER_ANY_ISSUE);
+
+	    new_ns += after_new - start;
+	    fetch_ns += after_fetch - after_new;
+	}
+
+	if(best_new_ns < 0.0 || new_ns < best_new_ns) {
+	    best_new_ns = new_ns;
+	}
+	if(best_fetch_ns < 0.0 || fetch_ns < best_fetch_ns) {
+	    best_fetch_ns = fetch_ns;
+	}
+    }
+
+    double issues = (double)batches * BATCH_SIZE;
+    print_result(micro, "issue_context", "new_issue", best_new_ns / issues);
+    print_result(micro, "issue_context", "fetch", best_fetch_ns / issues);
+}
+
+int main(int argc, char * const argv[])
+{
+    /* Default options */
+    long iterations = 1000000;
+    int repeats = 5;
+    int cpu = -1;
+
+    int argument_parsing = 1;
+    while(argument_parsing)
+    {
+	int c = getopt_long_only(argc, argv, "", long_options, NULL);
+
+	switch(c)
+	{
+	case -1:
+	    argument_parsing = 0;
+	    break;
+
+	case ITERATIONS:
+	    iterations = atol(optarg);
+	    break;
+
+	case REPEATS:
+	    repeats = atoi(optarg);
+	    break;
+
+	case CPU:
+	    cpu = atoi(optarg);
+	    break;
+
+	default:
+	    break;
+	}
+    }
+
+    if(iterations < 1 || repeats < 1) {
+	fprintf(stderr, "iterations and repeats must be at least 1\n");
+	return EXIT_FAILURE;
+    }
+
+    /* Pinning to one cpu avoids migrations during the measurement */
+    if(cpu >= 0) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if(sched_setaffinity(0, sizeof(set), &set) != 0) {
+	    fprintf(stderr, "could not pin to cpu %d\n", cpu);
+	    return EXIT_FAILURE;
+	}
+    }
+
+    struct micro_t micro = {
+	.config = st_new_config(),
+	.issues = st_new_issue_context(),
+	.iterations = iterations,
+	.repeats = repeats,
+	.first_result = 1,
+    };
+
+    struct type_iface_t *types = st_new_elementary_types();
+    if(!micro.config || !micro.issues || !types) {
+	fprintf(stderr, "could not set up the benchmark\n");
+	return EXIT_FAILURE;
+    }
+
+    printf("{\n  \"iterations\": %ld,\n  \"repeats\": %d,\n  \"results\": [\n",
+	   iterations,
+	   repeats);
+
+    measure_elementary_types(&micro, types);
+    measure_enum_type(&micro);
+    measure_subrange_type(&micro, types);
+    measure_named_ref_pool(&micro);
+    measure_issue_context(&micro);
+
+    printf("\n  ]\n}\n");
+
+    return EXIT_SUCCESS;
+}
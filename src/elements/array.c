@@ -19,7 +19,9 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <elements/array.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 #include <elements/values.h>
+#include <statements/invariants.h>
 
 #include <utlist.h>
 #include <stdio.h>
@@ -275,6 +277,66 @@ int array_index_constant_reference(
     return ai->constant_reference;
 }
 
+static int array_index_invariant(
+    struct array_index_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct array_index_t *ai =
+	CONTAINER_OF(self, struct array_index_t, array_index);
+
+    struct index_node_t *itr = NULL;
+    DL_FOREACH(ai->nodes, itr)
+    {
+	if(!itr->expression->invariant)
+	{
+	    return ESSTEE_FALSE;
+	}
+    }
+
+    /* Unless the whole index is invariant, each expression is either
+     * hoisted, or hoists its own invariant parts */
+    int all_invariant = ESSTEE_TRUE;
+    st_loop_invariants_suspend(invariants);
+    DL_FOREACH(ai->nodes, itr)
+    {
+	int invariant_result = itr->expression->invariant(itr->expression,
+							  invariants,
+							  issues);
+	if(invariant_result != ESSTEE_TRUE)
+	{
+	    all_invariant = invariant_result;
+	    break;
+	}
+    }
+    st_loop_invariants_resume(invariants);
+
+    if(all_invariant != ESSTEE_FALSE)
+    {
+	return all_invariant;
+    }
+
+    DL_FOREACH(ai->nodes, itr)
+    {
+	int invariant_result = itr->expression->invariant(itr->expression,
+							  invariants,
+							  issues);
+	if(invariant_result == ESSTEE_TRUE)
+	{
+	    invariant_result = st_loop_invariants_hoist(invariants,
+							itr->expression,
+							issues);
+	}
+
+	if(invariant_result == ESSTEE_ERROR)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return ESSTEE_FALSE;
+}
+
 struct array_index_iface_t * st_create_array_index(
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
@@ -297,6 +359,7 @@ struct array_index_iface_t * st_create_array_index(
     ai->array_index.clone = array_index_clone;
     ai->array_index.extend = array_index_extend;
     ai->array_index.constant_reference = array_index_constant_reference;
+    ai->array_index.invariant = array_index_invariant;
     ai->array_index.destroy = array_index_destroy;
     ai->array_index.first_node = NULL;
 
@@ -755,36 +818,48 @@ static int assign_array_initializer(
 /**************************************************************************/
 /* Value interface                                                        */
 /**************************************************************************/
-static int array_value_assignable_from(
-    const struct value_iface_t *self,
-    const struct value_iface_t *other_value,
-    const struct config_iface_t *config,
-    struct issues_iface_t *issues)
+/* Arrays of the same type, or with the same element type and
+ * dimensions, can be assigned to each other as a whole */
+static int array_values_compatible(
+    const struct array_value_t *av,
+    const struct array_value_t *other)
 {
-    const struct array_value_t *av =
-	CONTAINER_OF(self, struct array_value_t, value);
+    const struct type_iface_t *vt =
+	TYPE_ANCESTOR(av->type);
+    const struct type_iface_t *ot =
+	TYPE_ANCESTOR(other->type);
 
-    if(!other_value->array_initializer)
+    if(vt == ot)
     {
-	issues->new_issue(
-	    issues,
-	    "the complete array can only be assigned an initializer in initialization",
-	    ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_TRUE;
+    }
+
+    const struct array_type_t *at =
+	CONTAINER_OF(vt, struct array_type_t, type);
+    const struct array_type_t *oat =
+	CONTAINER_OF(ot, struct array_type_t, type);
+
+    const struct type_iface_t *element_type =
+	TYPE_ANCESTOR(at->arrayed_type);
+    const struct type_iface_t *other_element_type =
+	TYPE_ANCESTOR(oat->arrayed_type);
 
+    if(element_type != other_element_type)
+    {
 	return ESSTEE_FALSE;
     }
-    
-    int type_can_hold = av->type->can_hold(av->type,
-					   other_value,
-					   config,
-					   issues);
 
-    if(type_can_hold != ESSTEE_TRUE)
+    const struct range_node_t *range = at->ranges->nodes;
+    const struct range_node_t *other_range = oat->ranges->nodes;
+    for(; range && other_range; range = range->next, other_range = other_range->next)
     {
-	return type_can_hold;
+	if(range->entries != other_range->entries)
+	{
+	    return ESSTEE_FALSE;
+	}
     }
 
-    return ESSTEE_TRUE;
+    return (!range && !other_range) ? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
 static int array_value_assign(
@@ -796,6 +871,38 @@ static int array_value_assign(
     const struct array_value_t *av =
 	CONTAINER_OF(self, struct array_value_t, value);
 
+    /* Whole array, compatibility has been verified so each element
+     * is assigned directly from the matching one */
+    if(new_value->assign == array_value_assign)
+    {
+	const struct array_value_t *other =
+	    CONTAINER_OF(new_value, struct array_value_t, value);
+
+	if(other == av)
+	{
+	    return ESSTEE_OK;
+	}
+
+	const struct type_iface_t *vt =
+	    TYPE_ANCESTOR(av->type);
+	const struct array_type_t *at =
+	    CONTAINER_OF(vt, struct array_type_t, type);
+
+	for(size_t i = 0; i < at->total_elements; i++)
+	{
+	    int assign_result = av->elements[i]->assign(av->elements[i],
+							other->elements[i],
+							config,
+							issues);
+	    if(assign_result != ESSTEE_OK)
+	    {
+		return assign_result;
+	    }
+	}
+
+	return ESSTEE_OK;
+    }
+
     const struct array_initializer_iface_t *initializer =
 	new_value->array_initializer(new_value);
 
@@ -815,6 +922,56 @@ static int array_value_assign(
     return ESSTEE_OK;
 }
 
+static int array_value_assignable_from(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct array_value_t *av =
+	CONTAINER_OF(self, struct array_value_t, value);
+
+    if(other_value->assign == array_value_assign)
+    {
+	const struct array_value_t *other =
+	    CONTAINER_OF(other_value, struct array_value_t, value);
+
+	if(array_values_compatible(av, other) != ESSTEE_TRUE)
+	{
+	    issues->new_issue(
+		issues,
+		"an array can only be assigned an array of the same element type and dimensions",
+		ESSTEE_TYPE_ERROR);
+
+	    return ESSTEE_FALSE;
+	}
+
+	return ESSTEE_TRUE;
+    }
+
+    if(!other_value->array_initializer)
+    {
+	issues->new_issue(
+	    issues,
+	    "the complete array can only be assigned an initializer or another array",
+	    ESSTEE_CONTEXT_ERROR);
+
+	return ESSTEE_FALSE;
+    }
+    
+    int type_can_hold = av->type->can_hold(av->type,
+					   other_value,
+					   config,
+					   issues);
+
+    if(type_can_hold != ESSTEE_TRUE)
+    {
+	return type_can_hold;
+    }
+
+    return ESSTEE_TRUE;
+}
+
 static int array_value_display(
     const struct value_iface_t *self,
     char *buffer,
@@ -902,6 +1059,13 @@ static struct value_iface_t * array_value_index(
 
     size_t elements_offset = 0;
 
+    /* An index without elements is a prototype index, it addresses
+     * the first element as a stand in for any element */
+    if(!array_index->first_node)
+    {
+	return av->elements[0];
+    }
+
     for(index_itr = array_index->first_node; index_itr != NULL; index_itr = index_itr->next)
     {
 	const struct value_iface_t *index_value =
@@ -1017,6 +1181,78 @@ static void array_value_destroy(
     /* TODO: array value destructor */
 }
 
+static int array_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct array_value_t *av =
+	CONTAINER_OF(self, struct array_value_t, value);
+
+    const struct type_iface_t *vt =
+	TYPE_ANCESTOR(av->type);
+
+    struct array_type_t *at =
+	CONTAINER_OF(vt, struct array_type_t, type);
+
+    for(size_t i = 0; i < at->total_elements; i++)
+    {
+	if(!av->elements[i]->checkpoint)
+	{
+	    issues->new_issue(issues,
+			      "array element cannot be checkpointed",
+			      ESSTEE_CONTEXT_ERROR);
+	    return ESSTEE_ERROR;
+	}
+	
+	int checkpoint_result = av->elements[i]->checkpoint(av->elements[i],
+							    checkpoint,
+							    issues);
+	if(checkpoint_result != ESSTEE_OK)
+	{
+	    return checkpoint_result;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+static int array_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct array_value_t *av =
+	CONTAINER_OF(self, struct array_value_t, value);
+
+    const struct type_iface_t *vt =
+	TYPE_ANCESTOR(av->type);
+
+    struct array_type_t *at =
+	CONTAINER_OF(vt, struct array_type_t, type);
+
+    for(size_t i = 0; i < at->total_elements; i++)
+    {
+	if(!av->elements[i]->restore)
+	{
+	    issues->new_issue(issues,
+			      "array element cannot be restored",
+			      ESSTEE_CONTEXT_ERROR);
+	    return ESSTEE_ERROR;
+	}
+
+	int restore_result = av->elements[i]->restore(av->elements[i],
+						      checkpoint,
+						      issues);
+	if(restore_result != ESSTEE_OK)
+	{
+	    return restore_result;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
 /**************************************************************************/
 /* Type interface                                                         */
 /**************************************************************************/
@@ -1070,6 +1306,8 @@ static struct value_iface_t * array_type_create_value_of(
     av->value.type_of = array_value_type_of;
     av->value.index = array_value_index;
     av->value.destroy = array_value_destroy;
+    av->value.checkpoint = array_value_checkpoint;
+    av->value.restore = array_value_restore;
     av->value.class = st_general_value_empty_class;
     av->value.override_type = array_value_override_type;
 
@@ -1324,3 +1562,25 @@ error_free_resources:
     free(at);
     return NULL;
 }
+
+struct value_iface_t * const * st_array_value_elements(
+    const struct value_iface_t *value,
+    size_t *count)
+{
+    if(value->assign != array_value_assign)
+    {
+	return NULL;
+    }
+
+    const struct array_value_t *av =
+	CONTAINER_OF(value, struct array_value_t, value);
+
+    const struct type_iface_t *vt =
+	TYPE_ANCESTOR(av->type);
+    const struct array_type_t *at =
+	CONTAINER_OF(vt, struct array_type_t, type);
+
+    *count = at->total_elements;
+    
+    return av->elements;
+}
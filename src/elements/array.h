@@ -83,3 +83,9 @@ struct type_iface_t * st_create_array_type(
     struct named_ref_pool_iface_t *type_refs,
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
+
+/* Gives the elements of an array value in storage order, or NULL if
+ * the value is not an array */
+struct value_iface_t * const * st_array_value_elements(
+    const struct value_iface_t *value,
+    size_t *count);
@@ -18,14 +18,20 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <elements/builtins.h>
+#include <elements/array.h>
 #include <elements/integers.h>
+#include <elements/reals.h>
+#include <elements/strings.h>
 #include <elements/variable.h>
+#include <expressions/iexpression.h>
 #include <statements/iinvoke.h>
 #include <util/iissues.h>
 #include <util/macros.h>
 
+#include <utlist.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
 /**************************************************************************/
 /* Integer cast function                                                  */
@@ -34,6 +40,8 @@ struct integer_cast_t {
     struct function_iface_t function;
     struct variable_iface_t *in;
     struct variable_iface_t *out;
+    const struct type_iface_t *from_type;
+    const struct type_iface_t *to_type;
     char *name;
 };
 
@@ -115,6 +123,34 @@ static int integer_cast_step(
     return INVOKE_RESULT_FINISHED;
 }
 
+/* In place of an invocation the argument is cast directly, after the
+ * range check assigning it to the input would have made */
+static int integer_cast_intrinsic(
+    struct function_iface_t *self,
+    struct value_iface_t *result,
+    const struct value_iface_t *argument,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct integer_cast_t *ic =
+	CONTAINER_OF(self, struct integer_cast_t, function);
+
+    int from_can_hold = ic->from_type->can_hold(ic->from_type,
+						argument,
+						config,
+						issues);
+    if(from_can_hold != ESSTEE_TRUE)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return ic->to_type->cast_value_of(ic->to_type,
+				      result,
+				      argument,
+				      config,
+				      issues);
+}
+
 static int integer_cast_reset(
     struct function_iface_t *self,
     const struct config_iface_t *config,
@@ -135,10 +171,17 @@ static const struct value_iface_t * integer_cast_result_value(
 static void integer_cast_destroy(
     struct function_iface_t *self)
 {
-    /* TODO: integer cast destructor */
+    struct integer_cast_t *ic =
+	CONTAINER_OF(self, struct integer_cast_t, function);
+
+    ic->in->destroy(ic->in);
+    ic->out->destroy(ic->out);
+    free(ic->name);
+    free(ic);
 }
 
 
+
 static const char * cast_integer_types[] = {
     "BOOL",
     "SINT",
@@ -192,6 +235,15 @@ static struct function_iface_t * create_integer_cast(
     {
 	goto error_free_resources;
     }
+
+    /* The input is a hash of its own, so it can be named in calls */
+    struct variable_iface_t *in_hash = NULL;
+    HASH_ADD_KEYPTR(
+	hh,
+	in_hash,
+	in_var->identifier,
+	strlen(in_var->identifier),
+	in_var);
     
     out_var = st_create_variable_type("OUT",
 				      NULL,
@@ -231,6 +283,8 @@ static struct function_iface_t * create_integer_cast(
     cast->name = name;
     cast->in = in_var;
     cast->out = out_var;
+    cast->from_type = from_type;
+    cast->to_type = to_type;
 
     memset(&(cast->function), 0, sizeof(struct function_iface_t));
     cast->function.finalize_header = integer_cast_finalize_header;
@@ -239,6 +293,7 @@ static struct function_iface_t * create_integer_cast(
     cast->function.step = integer_cast_step;
     cast->function.reset = integer_cast_reset;
     cast->function.result_value = integer_cast_result_value;
+    cast->function.intrinsic = integer_cast_intrinsic;
     cast->function.destroy = integer_cast_destroy;
 
     cast->function.identifier = cast->name;
@@ -246,48 +301,1602 @@ static struct function_iface_t * create_integer_cast(
     return &(cast->function);
 
 error_free_resources:
-    /* TODO: determine what to destroy */
+    if(in_var)
+    {
+	in_var->destroy(in_var);
+    }
+    if(out_var)
+    {
+	out_var->destroy(out_var);
+    }
+    free(name);
+    free(cast);
     return NULL;
 }
 
-struct function_iface_t * st_new_builtin_functions(
-    struct type_iface_t *builtin_types)
+/**************************************************************************/
+/* Native functions                                                       */
+/**************************************************************************/
+/* A native function runs a kernel in C on the values of its inputs and
+ * writes the result into a value of its own. Inputs are normally
+ * assigned from the parameters of each call, a function that only
+ * reads large inputs, like arrays, can instead have the kernel read the
+ * parameter values directly. */
+#define NATIVE_FUNCTION_MAX_INPUTS 5
+
+typedef int (*native_kernel_t)(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues);
+
+struct native_function_t {
+    struct function_iface_t function;
+    native_kernel_t kernel;
+    struct variable_iface_t *variables;
+    struct variable_iface_t *inputs[NATIVE_FUNCTION_MAX_INPUTS];
+    const struct value_iface_t *input_values[NATIVE_FUNCTION_MAX_INPUTS];
+    size_t inputs_count;
+    int inputs_by_reference;
+    struct value_iface_t *result;
+    struct native_function_t *next_variant;
+    char *name;
+};
+
+static int native_function_verify_invoke(
+    struct function_iface_t *self,
+    struct invoke_parameters_iface_t *parameters,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
 {
-    struct function_iface_t *functions = NULL;
+    if(!parameters)
+    {
+	issues->new_issue(issues,
+			  "missing arguments to function %s",
+			  ESSTEE_ARGUMENT_ERROR,
+			  self->identifier);
 
-    size_t num_cast_types =
-    	sizeof(cast_integer_types)/sizeof(const char *);
+	return ESSTEE_ERROR;
+    }
 
-    for(int i=0; i < num_cast_types; i++)
+    struct native_function_t *nf =
+	CONTAINER_OF(self, struct native_function_t, function);
+
+    return parameters->verify(parameters,
+			      nf->variables,
+			      config,
+			      issues);
+}
+
+static int native_function_step(
+    struct function_iface_t *self,
+    struct invoke_parameters_iface_t *parameters,
+    struct cursor_iface_t *cursor,
+    const struct systime_iface_t *time,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct native_function_t *nf =
+	CONTAINER_OF(self, struct native_function_t, function);
+
+    if(nf->inputs_by_reference)
     {
-    	const char *from_name = cast_integer_types[i];
-	
-    	for(int j=0; j < num_cast_types; j++)
-    	{
-    	    const char *to_name = cast_integer_types[j];
+	for(size_t i = 0; i < nf->inputs_count; i++)
+	{
+	    nf->input_values[i] = parameters->value_of(parameters,
+						       nf->inputs[i]->identifier,
+						       i);
+	    if(!nf->input_values[i])
+	    {
+		issues->new_issue(issues,
+				  "missing argument %s to function %s",
+				  ESSTEE_ARGUMENT_ERROR,
+				  nf->inputs[i]->identifier,
+				  self->identifier);
 
-    	    if(from_name == to_name) // Yes, comparing pointers not content
-    	    {
-    		continue;
-    	    }
+		return INVOKE_RESULT_ERROR;
+	    }
+	}
+    }
+    else
+    {
+	/* Inputs not given in the call start from their defaults */
+	for(size_t i = 0; i < nf->inputs_count; i++)
+	{
+	    if(nf->inputs[i]->reset(nf->inputs[i], config, issues) != ESSTEE_OK)
+	    {
+		return INVOKE_RESULT_ERROR;
+	    }
+	}
 
-    	    struct function_iface_t *cast_function =
-    	    	create_integer_cast(from_name,
-    	    			    to_name,
-    	    			    builtin_types);
+	int input_assign_result = parameters->assign_from(parameters,
+							  nf->variables,
+							  config,
+							  issues);
+	if(input_assign_result != ESSTEE_OK)
+	{
+	    return INVOKE_RESULT_ERROR;
+	}
+    }
 
-    	    if(!cast_function)
-    	    {
-    	    	goto error_free_resources;
-    	    }
+    if(nf->kernel(nf->result, nf->input_values, config, issues) != ESSTEE_OK)
+    {
+	return INVOKE_RESULT_ERROR;
+    }
 
-    	    HASH_ADD_KEYPTR(
-    		hh,
-    		functions,
-    		cast_function->identifier,
-    		strlen(cast_function->identifier),
-    		cast_function);
-    	}
+    return INVOKE_RESULT_FINISHED;
+}
+
+static const struct value_iface_t * native_function_result_value(
+    struct function_iface_t *self)
+{
+    struct native_function_t *nf =
+	CONTAINER_OF(self, struct native_function_t, function);
+
+    return nf->result;
+}
+
+static void native_function_destroy(
+    struct function_iface_t *self)
+{
+    struct native_function_t *nf =
+	CONTAINER_OF(self, struct native_function_t, function);
+
+    HASH_CLEAR(hh, nf->variables);
+
+    for(size_t i = 0; i < nf->inputs_count; i++)
+    {
+	nf->inputs[i]->destroy(nf->inputs[i]);
+    }
+
+    if(nf->result)
+    {
+	nf->result->destroy(nf->result);
+    }
+
+    free(nf->name);
+    free(nf);
+}
+
+static struct native_function_t * create_native_function(
+    const char *name,
+    const struct type_iface_t *result_type,
+    const char * const *input_names,
+    const struct type_iface_t * const *input_types,
+    native_kernel_t kernel,
+    int inputs_by_reference)
+{
+    struct native_function_t *nf = NULL;
+
+    ALLOC_OR_JUMP(
+	nf,
+	struct native_function_t,
+	error_free_resources);
+
+    memset(nf, 0, sizeof(struct native_function_t));
+
+    STRDUP_OR_JUMP(
+	nf->name,
+	name,
+	error_free_resources);
+
+    nf->kernel = kernel;
+    nf->inputs_by_reference = inputs_by_reference;
+
+    struct variable_iface_t *input_list = NULL;
+    for(size_t i = 0; i < NATIVE_FUNCTION_MAX_INPUTS && input_names[i]; i++)
+    {
+	struct variable_iface_t *input = st_create_variable_type(
+	    (char *)input_names[i],
+	    NULL,
+	    input_types[i],
+	    INPUT_VAR_CLASS,
+	    NULL,
+	    NULL);
+	if(!input)
+	{
+	    goto error_free_resources;
+	}
+
+	if(input->create(input, NULL, NULL) != ESSTEE_OK)
+	{
+	    input->destroy(input);
+	    goto error_free_resources;
+	}
+
+	DL_APPEND(input_list, input);
+	nf->inputs[nf->inputs_count] = input;
+	nf->input_values[nf->inputs_count] = input->value(input);
+	nf->inputs_count++;
+    }
+
+    /* Named parameters are looked up by hash, unnamed ones follow the
+     * list order */
+    struct variable_iface_t *itr = NULL;
+    DL_FOREACH(input_list, itr)
+    {
+	HASH_ADD_KEYPTR(
+	    hh,
+	    nf->variables,
+	    itr->identifier,
+	    strlen(itr->identifier),
+	    itr);
+    }
+
+    nf->result = result_type->create_value_of(result_type, NULL, NULL);
+    if(!nf->result)
+    {
+	goto error_free_resources;
+    }
+
+    nf->function.finalize_header = integer_cast_finalize_header;
+    nf->function.finalize_statements = integer_cast_finalize_statements;
+    nf->function.verify_invoke = native_function_verify_invoke;
+    nf->function.step = native_function_step;
+    nf->function.reset = integer_cast_reset;
+    nf->function.result_value = native_function_result_value;
+    nf->function.destroy = native_function_destroy;
+
+    nf->function.identifier = nf->name;
+
+    return nf;
+
+error_free_resources:
+    if(nf)
+    {
+	native_function_destroy(&(nf->function));
+    }
+    return NULL;
+}
+
+/**************************************************************************/
+/* String functions                                                       */
+/**************************************************************************/
+/* The string functions work directly on the text and length of their
+ * inputs. A position P counts from 1, lengths and positions outside the
+ * input are clamped to it. Each function has a STRING and a WSTRING
+ * variant, named like LEN_STRING and LEN_WSTRING. Invoked by its plain
+ * name the variant is chosen by the type of the first string argument.
+ * Positions and lengths in a WSTRING count characters, not the bytes
+ * of its UTF-8 encoding. */
+struct string_function_spec_t {
+    const char *name;
+    const char *result_type;
+    const char *input_names[NATIVE_FUNCTION_MAX_INPUTS];
+    const char *input_types[NATIVE_FUNCTION_MAX_INPUTS];
+    native_kernel_t kernel;
+};
+
+static const char * string_types[] = {
+    "STRING",
+    "WSTRING",
+};
+
+#define STRING_TYPES_COUNT (sizeof(string_types)/sizeof(const char *))
+
+static int input_wide(
+    const struct value_iface_t *input)
+{
+    const struct type_iface_t *input_type = input->type_of(input);
+
+    return ST_FLAG_IS_SET(input_type->class(input_type), WSTRING_TYPE);
+}
+
+/* Gives the text of a string input, with its length in bytes and, if
+ * asked for, in characters */
+static const char * input_text(
+    const struct value_iface_t *input,
+    size_t *length,
+    size_t *characters,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const char *text = st_string_value_text(input, length, config, issues);
+
+    if(characters)
+    {
+	*characters = st_text_characters(text, *length, input_wide(input));
+    }
+
+    return text;
+}
+
+/* Gives the number of bytes the first characters of an input make up */
+static size_t input_offset(
+    const struct value_iface_t *input,
+    const char *text,
+    size_t length,
+    size_t characters)
+{
+    return st_text_offset(text, length, characters, input_wide(input));
+}
+
+/* Gives an integer input clamped to [min, max] */
+static size_t input_clamped(
+    const struct value_iface_t *input,
+    int64_t min,
+    size_t max,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int64_t number = input->integer(input, config, issues);
+
+    if(number < min)
+    {
+	number = min;
+    }
+
+    return ((uint64_t)number > max) ? max : (size_t)number;
+}
+
+static int string_len(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, characters = 0;
+    input_text(inputs[0], &length, &characters, config, issues);
+
+    return st_integer_value_set(result, (int64_t)characters);
+}
+
+static int string_concat(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t first_length = 0, second_length = 0;
+    const char *first = input_text(inputs[0], &first_length, NULL, config, issues);
+    const char *second = input_text(inputs[1], &second_length, NULL, config, issues);
+
+    st_string_value_write(result, 0, first, first_length);
+    return st_string_value_write(result, first_length, second, second_length);
+}
+
+static int string_left(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, characters = 0;
+    const char *text = input_text(inputs[0], &length, &characters, config, issues);
+    size_t count = input_clamped(inputs[1], 0, characters, config, issues);
+    size_t end = input_offset(inputs[0], text, length, count);
+
+    return st_string_value_write(result, 0, text, end);
+}
+
+static int string_right(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, characters = 0;
+    const char *text = input_text(inputs[0], &length, &characters, config, issues);
+    size_t count = input_clamped(inputs[1], 0, characters, config, issues);
+    size_t start = input_offset(inputs[0], text, length, characters - count);
+
+    return st_string_value_write(result, 0, text + start, length - start);
+}
+
+static int string_mid(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, characters = 0;
+    const char *text = input_text(inputs[0], &length, &characters, config, issues);
+    size_t start = input_clamped(inputs[2], 1, characters + 1, config, issues) - 1;
+    size_t count = input_clamped(inputs[1], 0, characters - start, config, issues);
+    size_t first = input_offset(inputs[0], text, length, start);
+    size_t end = input_offset(inputs[0], text, length, start + count);
+
+    return st_string_value_write(result, 0, text + first, end - first);
+}
+
+static int string_find(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, pattern_length = 0;
+    const char *text = input_text(inputs[0], &length, NULL, config, issues);
+    const char *pattern = input_text(inputs[1], &pattern_length, NULL, config, issues);
+
+    if(pattern_length == 0 || pattern_length > length)
+    {
+	return st_integer_value_set(result, 0);
+    }
+
+    const char *itr = text;
+    const char *last = text + length - pattern_length;
+    while(itr <= last)
+    {
+	itr = memchr(itr, pattern[0], (size_t)(last - itr) + 1);
+	if(!itr)
+	{
+	    break;
+	}
+
+	if(memcmp(itr + 1, pattern + 1, pattern_length - 1) == 0)
+	{
+	    /* A match starts at a character, as the pattern does */
+	    size_t before = st_text_characters(text,
+					       (size_t)(itr - text),
+					       input_wide(inputs[0]));
+
+	    return st_integer_value_set(result, (int64_t)before + 1);
+	}
+
+	itr++;
+    }
+
+    return st_integer_value_set(result, 0);
+}
+
+static int string_insert(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, characters = 0, insert_length = 0;
+    const char *text = input_text(inputs[0], &length, &characters, config, issues);
+    const char *insert = input_text(inputs[1], &insert_length, NULL, config, issues);
+    size_t after = input_clamped(inputs[2], 0, characters, config, issues);
+    size_t split = input_offset(inputs[0], text, length, after);
+
+    st_string_value_write(result, 0, text, split);
+    st_string_value_write(result, split, insert, insert_length);
+    return st_string_value_write(result,
+				 split + insert_length,
+				 text + split,
+				 length - split);
+}
+
+static int string_delete(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, characters = 0;
+    const char *text = input_text(inputs[0], &length, &characters, config, issues);
+    size_t start = input_clamped(inputs[2], 1, characters + 1, config, issues) - 1;
+    size_t count = input_clamped(inputs[1], 0, characters - start, config, issues);
+    size_t first = input_offset(inputs[0], text, length, start);
+    size_t end = input_offset(inputs[0], text, length, start + count);
+
+    st_string_value_write(result, 0, text, first);
+    return st_string_value_write(result,
+				 first,
+				 text + end,
+				 length - end);
+}
+
+static int string_replace(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t length = 0, characters = 0, replacement_length = 0;
+    const char *text = input_text(inputs[0], &length, &characters, config, issues);
+    const char *replacement = input_text(inputs[1], &replacement_length, NULL, config, issues);
+    size_t start = input_clamped(inputs[3], 1, characters + 1, config, issues) - 1;
+    size_t count = input_clamped(inputs[2], 0, characters - start, config, issues);
+    size_t first = input_offset(inputs[0], text, length, start);
+    size_t end = input_offset(inputs[0], text, length, start + count);
+
+    st_string_value_write(result, 0, text, first);
+    st_string_value_write(result, first, replacement, replacement_length);
+    return st_string_value_write(result,
+				 first + replacement_length,
+				 text + end,
+				 length - end);
+}
+
+/* A NULL type is the string type of the variant */
+static const struct string_function_spec_t string_functions[] = {
+    { "LEN", "INT", { "IN" }, { NULL }, string_len },
+    { "CONCAT", NULL, { "IN1", "IN2" }, { NULL, NULL }, string_concat },
+    { "LEFT", NULL, { "IN", "L" }, { NULL, "INT" }, string_left },
+    { "RIGHT", NULL, { "IN", "L" }, { NULL, "INT" }, string_right },
+    { "MID", NULL, { "IN", "L", "P" }, { NULL, "INT", "INT" }, string_mid },
+    { "FIND", "INT", { "IN1", "IN2" }, { NULL, NULL }, string_find },
+    { "INSERT", NULL, { "IN1", "IN2", "P" }, { NULL, NULL, "INT" }, string_insert },
+    { "DELETE", NULL, { "IN", "L", "P" }, { NULL, "INT", "INT" }, string_delete },
+    { "REPLACE", NULL, { "IN1", "IN2", "L", "P" }, { NULL, NULL, "INT", "INT" }, string_replace },
+};
+
+struct string_function_t {
+    struct function_iface_t function;
+    const struct string_function_spec_t *spec;
+    struct function_iface_t *variants[STRING_TYPES_COUNT];
+};
+
+static struct function_iface_t * string_function_overload(
+    struct function_iface_t *self,
+    const struct invoke_parameters_iface_t *parameters,
+    struct issues_iface_t *issues)
+{
+    struct string_function_t *sf =
+	CONTAINER_OF(self, struct string_function_t, function);
+
+    const struct string_function_spec_t *spec = sf->spec;
+
+    for(size_t i = 0; parameters && i < NATIVE_FUNCTION_MAX_INPUTS && spec->input_names[i]; i++)
+    {
+	if(spec->input_types[i])
+	{
+	    continue;
+	}
+
+	const struct value_iface_t *value =
+	    parameters->value_of(parameters, spec->input_names[i], i);
+
+	const struct type_iface_t *value_type =
+	    (value && value->type_of) ? value->type_of(value) : NULL;
+
+	if(!value_type)
+	{
+	    continue;
+	}
+
+	st_bitflag_t value_class = value_type->class(value_type);
+
+	if(ST_FLAG_IS_SET(value_class, WSTRING_TYPE))
+	{
+	    return sf->variants[1];
+	}
+	else if(ST_FLAG_IS_SET(value_class, STRING_TYPE))
+	{
+	    return sf->variants[0];
+	}
+
+	issues->new_issue(
+	    issues,
+	    "%s has no variant for type '%s'",
+	    ESSTEE_TYPE_ERROR,
+	    spec->name,
+	    (value_type->identifier) ? value_type->identifier : "anonymous type");
+
+	return NULL;
+    }
+
+    return sf->variants[0];
+}
+
+/* The variants are functions of their own, destroyed as such */
+static void string_function_destroy(
+    struct function_iface_t *self)
+{
+    struct string_function_t *sf =
+	CONTAINER_OF(self, struct string_function_t, function);
+
+    free(sf);
+}
+
+static struct function_iface_t * create_string_variant(
+    const struct string_function_spec_t *spec,
+    const struct type_iface_t *variant_type,
+    struct type_iface_t *builtin_types)
+{
+    char name_buffer[32];
+    struct type_iface_t *result_type = NULL;
+    const struct type_iface_t *input_types[NATIVE_FUNCTION_MAX_INPUTS];
+
+    if(spec->result_type)
+    {
+	HASH_FIND_STR(builtin_types, spec->result_type, result_type);
+	if(!result_type)
+	{
+	    return NULL;
+	}
+    }
+
+    for(size_t i = 0; i < NATIVE_FUNCTION_MAX_INPUTS && spec->input_names[i]; i++)
+    {
+	if(!spec->input_types[i])
+	{
+	    input_types[i] = variant_type;
+	    continue;
+	}
+
+	struct type_iface_t *input_type = NULL;
+	HASH_FIND_STR(builtin_types, spec->input_types[i], input_type);
+	if(!input_type)
+	{
+	    return NULL;
+	}
+
+	input_types[i] = input_type;
+    }
+
+    snprintf(
+	name_buffer,
+	sizeof(name_buffer),
+	"%s_%s",
+	spec->name,
+	variant_type->identifier);
+
+    struct native_function_t *variant = create_native_function(
+	name_buffer,
+	(result_type) ? result_type : variant_type,
+	spec->input_names,
+	input_types,
+	spec->kernel,
+	0);
+    if(!variant)
+    {
+	return NULL;
+    }
+
+    return &(variant->function);
+}
+
+static struct string_function_t * create_string_function(
+    const struct string_function_spec_t *spec,
+    struct type_iface_t *builtin_types)
+{
+    struct string_function_t *sf = NULL;
+
+    ALLOC_OR_JUMP(
+	sf,
+	struct string_function_t,
+	error_free_resources);
+
+    memset(sf, 0, sizeof(struct string_function_t));
+    sf->spec = spec;
+
+    for(size_t t = 0; t < STRING_TYPES_COUNT; t++)
+    {
+	struct type_iface_t *variant_type = NULL;
+	HASH_FIND_STR(builtin_types, string_types[t], variant_type);
+	if(!variant_type)
+	{
+	    goto error_free_resources;
+	}
+
+	sf->variants[t] = create_string_variant(spec,
+						variant_type,
+						builtin_types);
+	if(!sf->variants[t])
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    sf->function.finalize_header = integer_cast_finalize_header;
+    sf->function.finalize_statements = integer_cast_finalize_statements;
+    sf->function.reset = integer_cast_reset;
+    sf->function.overload = string_function_overload;
+    sf->function.destroy = string_function_destroy;
+
+    sf->function.identifier = spec->name;
+
+    return sf;
+
+error_free_resources:
+    for(size_t t = 0; sf && t < STRING_TYPES_COUNT; t++)
+    {
+	if(sf->variants[t])
+	{
+	    sf->variants[t]->destroy(sf->variants[t]);
+	}
+    }
+    free(sf);
+    return NULL;
+}
+
+/**************************************************************************/
+/* Numeric functions                                                      */
+/**************************************************************************/
+/* Each numeric function has one typed variant per numeric type it
+ * applies to, named like ABS_INT and SQRT_LREAL. Invoked by its plain
+ * name the variant is chosen by the type of the first typed argument
+ * of the generic inputs. */
+static const char * numeric_types[] = {
+    "INT",
+    "DINT",
+    "LINT",
+    "REAL",
+    "LREAL",
+};
+
+#define NUMERIC_TYPES_COUNT (sizeof(numeric_types)/sizeof(const char *))
+#define NUMERIC_REAL_TYPES_START 3
+
+/* A result that is not a number, from inputs that are, means the
+ * inputs are outside the domain of the function */
+static int real_result_of(
+    struct value_iface_t *result,
+    int input_is_nan,
+    double number,
+    struct issues_iface_t *issues)
+{
+    if(isnan(number) && !input_is_nan)
+    {
+	issues->new_issue(
+	    issues,
+	    "argument outside the domain of the function",
+	    ESSTEE_ARGUMENT_ERROR);
+
+	return ESSTEE_ERROR;
+    }
+
+    return st_real_value_set(result, number);
+}
+
+static int real_function(
+    struct value_iface_t *result,
+    const struct value_iface_t *input,
+    double (*function)(double),
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    double in = input->real(input, config, issues);
+
+    return real_result_of(result, isnan(in), function(in), issues);
+}
+
+static int numeric_abs_integer(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int64_t in = inputs[0]->integer(inputs[0], config, issues);
+
+    return st_integer_value_set(result, (in < 0) ? -in : in);
+}
+
+static int numeric_abs_real(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return st_real_value_set(result, fabs(inputs[0]->real(inputs[0], config, issues)));
+}
+
+static int numeric_sqrt(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], sqrt, config, issues);
+}
+
+static int numeric_ln(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], log, config, issues);
+}
+
+static int numeric_log(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], log10, config, issues);
+}
+
+static int numeric_exp(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], exp, config, issues);
+}
+
+static int numeric_sin(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], sin, config, issues);
+}
+
+static int numeric_cos(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], cos, config, issues);
+}
+
+static int numeric_tan(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], tan, config, issues);
+}
+
+static int numeric_asin(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], asin, config, issues);
+}
+
+static int numeric_acos(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], acos, config, issues);
+}
+
+static int numeric_atan(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return real_function(result, inputs[0], atan, config, issues);
+}
+
+static int numeric_expt(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    double base = inputs[0]->real(inputs[0], config, issues);
+    double exponent = inputs[1]->real(inputs[1], config, issues);
+
+    return real_result_of(result,
+			  isnan(base) || isnan(exponent),
+			  pow(base, exponent),
+			  issues);
+}
+
+static int numeric_min_integer(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int64_t in1 = inputs[0]->integer(inputs[0], config, issues);
+    int64_t in2 = inputs[1]->integer(inputs[1], config, issues);
+
+    return st_integer_value_set(result, (in1 < in2) ? in1 : in2);
+}
+
+static int numeric_min_real(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    double in1 = inputs[0]->real(inputs[0], config, issues);
+    double in2 = inputs[1]->real(inputs[1], config, issues);
+
+    return st_real_value_set(result, (in1 < in2) ? in1 : in2);
+}
+
+static int numeric_max_integer(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int64_t in1 = inputs[0]->integer(inputs[0], config, issues);
+    int64_t in2 = inputs[1]->integer(inputs[1], config, issues);
+
+    return st_integer_value_set(result, (in1 > in2) ? in1 : in2);
+}
+
+static int numeric_max_real(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    double in1 = inputs[0]->real(inputs[0], config, issues);
+    double in2 = inputs[1]->real(inputs[1], config, issues);
+
+    return st_real_value_set(result, (in1 > in2) ? in1 : in2);
+}
+
+static int numeric_limit_integer(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int64_t mn = inputs[0]->integer(inputs[0], config, issues);
+    int64_t in = inputs[1]->integer(inputs[1], config, issues);
+    int64_t mx = inputs[2]->integer(inputs[2], config, issues);
+
+    in = (in > mx) ? mx : in;
+    return st_integer_value_set(result, (in < mn) ? mn : in);
+}
+
+static int numeric_limit_real(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    double mn = inputs[0]->real(inputs[0], config, issues);
+    double in = inputs[1]->real(inputs[1], config, issues);
+    double mx = inputs[2]->real(inputs[2], config, issues);
+
+    in = (in > mx) ? mx : in;
+    return st_real_value_set(result, (in < mn) ? mn : in);
+}
+
+/* Selections copy the chosen input as it is, whatever its type */
+static int numeric_sel(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int g = inputs[0]->bool(inputs[0], config, issues);
+    const struct value_iface_t *selected = (g == ESSTEE_TRUE) ? inputs[2] : inputs[1];
+
+    return result->assign(result, selected, config, issues);
+}
+
+static int numeric_mux(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int64_t k = inputs[0]->integer(inputs[0], config, issues);
+
+    if(k < 0 || k > NATIVE_FUNCTION_MAX_INPUTS - 2)
+    {
+	issues->new_issue(
+	    issues,
+	    "selector K outside the inputs of MUX",
+	    ESSTEE_ARGUMENT_ERROR);
+
+	return ESSTEE_ERROR;
+    }
+
+    return result->assign(result, inputs[k + 1], config, issues);
+}
+
+static int numeric_move(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return result->assign(result, inputs[0], config, issues);
+}
+
+/* An input type of NULL marks a generic input, of the variant type */
+struct numeric_function_spec_t {
+    const char *name;
+    const char *input_names[NATIVE_FUNCTION_MAX_INPUTS];
+    const char *input_types[NATIVE_FUNCTION_MAX_INPUTS];
+    native_kernel_t integer_kernel;
+    native_kernel_t real_kernel;
+};
+
+static const struct numeric_function_spec_t numeric_functions[] = {
+    { "ABS", { "IN" }, { NULL }, numeric_abs_integer, numeric_abs_real },
+    { "SQRT", { "IN" }, { NULL }, NULL, numeric_sqrt },
+    { "LN", { "IN" }, { NULL }, NULL, numeric_ln },
+    { "LOG", { "IN" }, { NULL }, NULL, numeric_log },
+    { "EXP", { "IN" }, { NULL }, NULL, numeric_exp },
+    { "SIN", { "IN" }, { NULL }, NULL, numeric_sin },
+    { "COS", { "IN" }, { NULL }, NULL, numeric_cos },
+    { "TAN", { "IN" }, { NULL }, NULL, numeric_tan },
+    { "ASIN", { "IN" }, { NULL }, NULL, numeric_asin },
+    { "ACOS", { "IN" }, { NULL }, NULL, numeric_acos },
+    { "ATAN", { "IN" }, { NULL }, NULL, numeric_atan },
+    { "EXPT", { "IN1", "IN2" }, { NULL, NULL }, NULL, numeric_expt },
+    { "MIN", { "IN1", "IN2" }, { NULL, NULL }, numeric_min_integer, numeric_min_real },
+    { "MAX", { "IN1", "IN2" }, { NULL, NULL }, numeric_max_integer, numeric_max_real },
+    { "LIMIT", { "MN", "IN", "MX" }, { NULL, NULL, NULL }, numeric_limit_integer, numeric_limit_real },
+    { "SEL", { "G", "IN0", "IN1" }, { "BOOL", NULL, NULL }, numeric_sel, numeric_sel },
+    { "MUX", { "K", "IN0", "IN1", "IN2", "IN3" }, { "INT", NULL, NULL, NULL, NULL }, numeric_mux, numeric_mux },
+    { "MOVE", { "IN" }, { NULL }, numeric_move, numeric_move },
+};
+
+struct numeric_function_t {
+    struct function_iface_t function;
+    const struct numeric_function_spec_t *spec;
+    const struct type_iface_t *variant_types[NUMERIC_TYPES_COUNT];
+    struct function_iface_t *variants[NUMERIC_TYPES_COUNT];
+};
+
+static struct function_iface_t * numeric_function_overload(
+    struct function_iface_t *self,
+    const struct invoke_parameters_iface_t *parameters,
+    struct issues_iface_t *issues)
+{
+    struct numeric_function_t *nf =
+	CONTAINER_OF(self, struct numeric_function_t, function);
+
+    const struct numeric_function_spec_t *spec = nf->spec;
+    const struct value_iface_t *typeless = NULL;
+    
+    for(size_t i = 0; parameters && i < NATIVE_FUNCTION_MAX_INPUTS && spec->input_names[i]; i++)
+    {
+	if(spec->input_types[i])
+	{
+	    continue;
+	}
+
+	const struct value_iface_t *value =
+	    parameters->value_of(parameters, spec->input_names[i], i);
+
+	if(!value)
+	{
+	    continue;
+	}
+
+	/* Temporary values, like the results of expressions, have no
+	 * type, the expression gives the type it is computed in */
+	const struct type_iface_t *value_type =
+	    (value->type_of) ? value->type_of(value) : NULL;
+
+	if(!value_type)
+	{
+	    const struct expression_iface_t *expression =
+		parameters->expression_of(parameters, spec->input_names[i], i);
+
+	    if(expression && expression->result_type)
+	    {
+		value_type = expression->result_type(expression);
+	    }
+	}
+
+	if(!value_type)
+	{
+	    typeless = (typeless) ? typeless : value;
+	    continue;
+	}
+
+	st_bitflag_t value_class =
+	    value_type->class(value_type) & (~(DERIVED_TYPE|SUBRANGE_TYPE));
+
+	for(size_t t = 0; t < NUMERIC_TYPES_COUNT; t++)
+	{
+	    const struct type_iface_t *variant_type = nf->variant_types[t];
+	    
+	    if(nf->variants[t] && variant_type->class(variant_type) == value_class)
+	    {
+		return nf->variants[t];
+	    }
+	}
+
+	issues->new_issue(
+	    issues,
+	    "%s has no variant for type '%s'",
+	    ESSTEE_TYPE_ERROR,
+	    spec->name,
+	    (value_type->identifier) ? value_type->identifier : "anonymous type");
+
+	return NULL;
+    }
+
+    /* Only literals and temporaries of literals given, those default
+     * to INT and REAL */
+    if(typeless && typeless->integer && nf->variants[0])
+    {
+	return nf->variants[0];
+    }
+    else if(typeless && typeless->real && nf->variants[NUMERIC_REAL_TYPES_START])
+    {
+	return nf->variants[NUMERIC_REAL_TYPES_START];
+    }
+
+    issues->new_issue(
+	issues,
+	"the type of the arguments to %s cannot be determined",
+	ESSTEE_TYPE_ERROR,
+	spec->name);
+
+    return NULL;
+}
+
+/* The variants are functions of their own, destroyed as such */
+static void numeric_function_destroy(
+    struct function_iface_t *self)
+{
+    struct numeric_function_t *nf =
+	CONTAINER_OF(self, struct numeric_function_t, function);
+
+    free(nf);
+}
+
+static struct function_iface_t * create_numeric_variant(
+    const struct numeric_function_spec_t *spec,
+    const struct type_iface_t *variant_type,
+    native_kernel_t kernel,
+    struct type_iface_t *builtin_types)
+{
+    char name_buffer[32];
+    const struct type_iface_t *input_types[NATIVE_FUNCTION_MAX_INPUTS];
+
+    for(size_t i = 0; i < NATIVE_FUNCTION_MAX_INPUTS && spec->input_names[i]; i++)
+    {
+	if(!spec->input_types[i])
+	{
+	    input_types[i] = variant_type;
+	    continue;
+	}
+	
+	struct type_iface_t *input_type = NULL;
+	HASH_FIND_STR(builtin_types, spec->input_types[i], input_type);
+	if(!input_type)
+	{
+	    return NULL;
+	}
+
+	input_types[i] = input_type;
+    }
+
+    snprintf(
+	name_buffer,
+	sizeof(name_buffer),
+	"%s_%s",
+	spec->name,
+	variant_type->identifier);
+
+    struct native_function_t *variant = create_native_function(name_buffer,
+							       variant_type,
+							       spec->input_names,
+							       input_types,
+							       kernel,
+							       0);
+    if(!variant)
+    {
+	return NULL;
+    }
+
+    return &(variant->function);
+}
+
+static struct numeric_function_t * create_numeric_function(
+    const struct numeric_function_spec_t *spec,
+    struct type_iface_t *builtin_types)
+{
+    struct numeric_function_t *nf = NULL;
+
+    ALLOC_OR_JUMP(
+	nf,
+	struct numeric_function_t,
+	error_free_resources);
+
+    memset(nf, 0, sizeof(struct numeric_function_t));
+    nf->spec = spec;
+
+    for(size_t t = 0; t < NUMERIC_TYPES_COUNT; t++)
+    {
+	native_kernel_t kernel = (t < NUMERIC_REAL_TYPES_START) ?
+	    spec->integer_kernel : spec->real_kernel;
+
+	if(!kernel)
+	{
+	    continue;
+	}
+
+	struct type_iface_t *variant_type = NULL;
+	HASH_FIND_STR(builtin_types, numeric_types[t], variant_type);
+	if(!variant_type)
+	{
+	    goto error_free_resources;
+	}
+
+	nf->variant_types[t] = variant_type;
+	nf->variants[t] = create_numeric_variant(spec,
+						 variant_type,
+						 kernel,
+						 builtin_types);
+	if(!nf->variants[t])
+	{
+	    goto error_free_resources;
+	}
+    }
+
+    nf->function.finalize_header = integer_cast_finalize_header;
+    nf->function.finalize_statements = integer_cast_finalize_statements;
+    nf->function.reset = integer_cast_reset;
+    nf->function.overload = numeric_function_overload;
+    nf->function.destroy = numeric_function_destroy;
+
+    nf->function.identifier = spec->name;
+
+    return nf;
+
+error_free_resources:
+    for(size_t t = 0; nf && t < NUMERIC_TYPES_COUNT; t++)
+    {
+	if(nf->variants[t])
+	{
+	    nf->variants[t]->destroy(nf->variants[t]);
+	}
+    }
+    free(nf);
+    return NULL;
+}
+
+/**************************************************************************/
+/* Array reductions                                                       */
+/**************************************************************************/
+/* The reductions read the elements of their array arguments in place,
+ * the arrays are not copied into inputs. A variant is made for each
+ * array type the reduction is invoked with, its result is REAL or LREAL
+ * after the element type. */
+static int reduce_sum(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t count = 0;
+    struct value_iface_t * const *elements =
+	st_array_value_elements(inputs[0], &count);
+
+    double sum = 0.0;
+    for(size_t i = 0; i < count; i++)
+    {
+	sum += elements[i]->real(elements[i], config, issues);
+    }
+
+    return st_real_value_set(result, sum);
+}
+
+static int reduce_min(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t count = 0;
+    struct value_iface_t * const *elements =
+	st_array_value_elements(inputs[0], &count);
+
+    double min = elements[0]->real(elements[0], config, issues);
+    for(size_t i = 1; i < count; i++)
+    {
+	double element = elements[i]->real(elements[i], config, issues);
+	min = (element < min) ? element : min;
+    }
+
+    return st_real_value_set(result, min);
+}
+
+static int reduce_max(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t count = 0;
+    struct value_iface_t * const *elements =
+	st_array_value_elements(inputs[0], &count);
+
+    double max = elements[0]->real(elements[0], config, issues);
+    for(size_t i = 1; i < count; i++)
+    {
+	double element = elements[i]->real(elements[i], config, issues);
+	max = (element > max) ? element : max;
+    }
+
+    return st_real_value_set(result, max);
+}
+
+static int reduce_dot(
+    struct value_iface_t *result,
+    const struct value_iface_t * const *inputs,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t count = 0, other_count = 0;
+    struct value_iface_t * const *elements =
+	st_array_value_elements(inputs[0], &count);
+    struct value_iface_t * const *other_elements =
+	st_array_value_elements(inputs[1], &other_count);
+
+    double dot = 0.0;
+    for(size_t i = 0; i < count && i < other_count; i++)
+    {
+	dot += elements[i]->real(elements[i], config, issues)
+	    * other_elements[i]->real(other_elements[i], config, issues);
+    }
+
+    return st_real_value_set(result, dot);
+}
+
+struct reduction_spec_t {
+    const char *name;
+    const char *input_names[NATIVE_FUNCTION_MAX_INPUTS];
+    native_kernel_t kernel;
+};
+
+static const struct reduction_spec_t reductions[] = {
+    { "ARRAY_SUM", { "IN" }, reduce_sum },
+    { "ARRAY_MIN", { "IN" }, reduce_min },
+    { "ARRAY_MAX", { "IN" }, reduce_max },
+    { "ARRAY_DOT", { "IN1", "IN2" }, reduce_dot },
+};
+
+struct reduction_t {
+    struct function_iface_t function;
+    const struct reduction_spec_t *spec;
+    struct type_iface_t *builtin_types;
+    struct native_function_t *variants;
+};
+
+static struct function_iface_t * reduction_overload(
+    struct function_iface_t *self,
+    const struct invoke_parameters_iface_t *parameters,
+    struct issues_iface_t *issues)
+{
+    struct reduction_t *rf =
+	CONTAINER_OF(self, struct reduction_t, function);
+
+    const struct value_iface_t *value = (parameters) ?
+	parameters->value_of(parameters, rf->spec->input_names[0], 0) : NULL;
+
+    size_t count = 0;
+    struct value_iface_t * const *elements = (value) ?
+	st_array_value_elements(value, &count) : NULL;
+
+    if(!elements || !elements[0]->real || !elements[0]->type_of)
+    {
+	issues->new_issue(
+	    issues,
+	    "%s can only be invoked with arrays of REAL or LREAL",
+	    ESSTEE_TYPE_ERROR,
+	    rf->spec->name);
+
+	return NULL;
+    }
+
+    const struct type_iface_t *array_type = value->type_of(value);
+
+    struct native_function_t *itr = NULL;
+    for(itr = rf->variants; itr != NULL; itr = itr->next_variant)
+    {
+	const struct value_iface_t *input = itr->inputs[0]->value(itr->inputs[0]);
+	
+	if(input->type_of(input) == array_type)
+	{
+	    return &(itr->function);
+	}
+    }
+
+    const struct type_iface_t *element_type = elements[0]->type_of(elements[0]);
+    st_bitflag_t element_class = element_type->class(element_type);
+
+    struct type_iface_t *result_type = NULL;
+    HASH_FIND_STR(rf->builtin_types,
+		  (ST_FLAG_IS_SET(element_class, LREAL_TYPE)) ? "LREAL" : "REAL",
+		  result_type);
+    if(!result_type)
+    {
+	issues->internal_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	return NULL;
+    }
+
+    const struct type_iface_t *input_types[NATIVE_FUNCTION_MAX_INPUTS] = {
+	array_type,
+	array_type,
+    };
+
+    struct native_function_t *variant = create_native_function(rf->spec->name,
+							       result_type,
+							       rf->spec->input_names,
+							       input_types,
+							       rf->spec->kernel,
+							       1);
+    if(!variant)
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	return NULL;
+    }
+
+    variant->next_variant = rf->variants;
+    rf->variants = variant;
+
+    return &(variant->function);
+}
+
+static void reduction_destroy(
+    struct function_iface_t *self)
+{
+    struct reduction_t *rf =
+	CONTAINER_OF(self, struct reduction_t, function);
+
+    struct native_function_t *itr = rf->variants;
+    while(itr)
+    {
+	struct native_function_t *next = itr->next_variant;
+	native_function_destroy(&(itr->function));
+	itr = next;
+    }
+
+    free(rf);
+}
+
+static struct reduction_t * create_reduction(
+    const struct reduction_spec_t *spec,
+    struct type_iface_t *builtin_types)
+{
+    struct reduction_t *rf = NULL;
+
+    ALLOC_OR_JUMP(
+	rf,
+	struct reduction_t,
+	error_free_resources);
+
+    memset(rf, 0, sizeof(struct reduction_t));
+    rf->spec = spec;
+    rf->builtin_types = builtin_types;
+
+    rf->function.finalize_header = integer_cast_finalize_header;
+    rf->function.finalize_statements = integer_cast_finalize_statements;
+    rf->function.reset = integer_cast_reset;
+    rf->function.overload = reduction_overload;
+    rf->function.destroy = reduction_destroy;
+
+    rf->function.identifier = spec->name;
+
+    return rf;
+
+error_free_resources:
+    return NULL;
+}
+
+struct function_iface_t * st_new_builtin_functions(
+    struct type_iface_t *builtin_types)
+{
+    struct function_iface_t *functions = NULL;
+
+    size_t num_cast_types =
+    	sizeof(cast_integer_types)/sizeof(const char *);
+
+    for(int i=0; i < num_cast_types; i++)
+    {
+    	const char *from_name = cast_integer_types[i];
+	
+    	for(int j=0; j < num_cast_types; j++)
+    	{
+    	    const char *to_name = cast_integer_types[j];
+
+    	    if(from_name == to_name) // Yes, comparing pointers not content
+    	    {
+    		continue;
+    	    }
+
+    	    struct function_iface_t *cast_function =
+    	    	create_integer_cast(from_name,
+    	    			    to_name,
+    	    			    builtin_types);
+
+    	    if(!cast_function)
+    	    {
+    	    	goto error_free_resources;
+    	    }
+
+    	    HASH_ADD_KEYPTR(
+    		hh,
+    		functions,
+    		cast_function->identifier,
+    		strlen(cast_function->identifier),
+    		cast_function);
+    	}
+    }
+
+    size_t num_string_functions =
+	sizeof(string_functions)/sizeof(struct string_function_spec_t);
+
+    for(int i=0; i < num_string_functions; i++)
+    {
+	struct string_function_t *string_function =
+	    create_string_function(&(string_functions[i]), builtin_types);
+
+	if(!string_function)
+	{
+	    goto error_free_resources;
+	}
+
+	HASH_ADD_KEYPTR(
+	    hh,
+	    functions,
+	    string_function->function.identifier,
+	    strlen(string_function->function.identifier),
+	    &(string_function->function));
+
+	for(int t=0; t < STRING_TYPES_COUNT; t++)
+	{
+	    struct function_iface_t *variant = string_function->variants[t];
+
+	    HASH_ADD_KEYPTR(
+		hh,
+		functions,
+		variant->identifier,
+		strlen(variant->identifier),
+		variant);
+	}
+    }
+
+    size_t num_numeric_functions =
+	sizeof(numeric_functions)/sizeof(struct numeric_function_spec_t);
+
+    for(int i=0; i < num_numeric_functions; i++)
+    {
+	struct numeric_function_t *numeric_function =
+	    create_numeric_function(&(numeric_functions[i]), builtin_types);
+
+	if(!numeric_function)
+	{
+	    goto error_free_resources;
+	}
+
+	HASH_ADD_KEYPTR(
+	    hh,
+	    functions,
+	    numeric_function->function.identifier,
+	    strlen(numeric_function->function.identifier),
+	    &(numeric_function->function));
+
+	for(int t=0; t < NUMERIC_TYPES_COUNT; t++)
+	{
+	    struct function_iface_t *variant = numeric_function->variants[t];
+
+	    if(variant)
+	    {
+		HASH_ADD_KEYPTR(
+		    hh,
+		    functions,
+		    variant->identifier,
+		    strlen(variant->identifier),
+		    variant);
+	    }
+	}
+    }
+
+    size_t num_reductions =
+	sizeof(reductions)/sizeof(struct reduction_spec_t);
+
+    for(int i=0; i < num_reductions; i++)
+    {
+	struct reduction_t *reduction =
+	    create_reduction(&(reductions[i]), builtin_types);
+
+	if(!reduction)
+	{
+	    goto error_free_resources;
+	}
+
+	HASH_ADD_KEYPTR(
+	    hh,
+	    functions,
+	    reduction->function.identifier,
+	    strlen(reduction->function.identifier),
+	    &(reduction->function));
     }
 
     return functions;
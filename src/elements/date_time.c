@@ -21,18 +21,119 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/values.h>
 #include <elements/types.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 
 #include <utlist.h>
 #include <stdio.h>
+#include <math.h>
+
+#define NS_PER_US INT64_C(1000)
+#define NS_PER_MS INT64_C(1000000)
+#define NS_PER_S INT64_C(1000000000)
+#define NS_PER_M (60*NS_PER_S)
+#define NS_PER_H (60*NS_PER_M)
+#define NS_PER_D (24*NS_PER_H)
+#define US_PER_S INT64_C(1000000)
+#define US_PER_D (86400*US_PER_S)
+
+/**************************************************************************/
+/* Calendar helpers                                                       */
+/**************************************************************************/
+/* Days since 1970-01-01 of a date in the proleptic Gregorian
+ * calendar */
+static int64_t days_from_civil(
+    int64_t year,
+    unsigned month,
+    unsigned day)
+{
+    year -= (month <= 2);
+    int64_t era = ((year >= 0) ? year : year - 399) / 400;
+    unsigned year_of_era = (unsigned)(year - era * 400);
+    unsigned day_of_year = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+    return era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+static void civil_from_days(
+    int64_t days,
+    int64_t *year,
+    unsigned *month,
+    unsigned *day)
+{
+    days += 719468;
+    int64_t era = ((days >= 0) ? days : days - 146096) / 146097;
+    unsigned day_of_era = (unsigned)(days - era * 146097);
+    unsigned year_of_era =
+	(day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    unsigned mp = (5 * day_of_year + 2) / 153;
+
+    *day = day_of_year - (153 * mp + 2) / 5 + 1;
+    *month = (mp < 10) ? mp + 3 : mp - 9;
+    *year = (int64_t)year_of_era + era * 400 + (*month <= 2);
+}
+
+/* Splits a point in time, in microseconds since 1970-01-01, into
+ * days and the nanoseconds into that day */
+static void split_date_time(
+    int64_t us,
+    int64_t *days,
+    int64_t *day_ns)
+{
+    *days = us / US_PER_D;
+    int64_t remainder = us % US_PER_D;
+    if(remainder < 0)
+    {
+	remainder += US_PER_D;
+	(*days)--;
+    }
+
+    *day_ns = remainder * NS_PER_US;
+}
+
+static int display_date(
+    char *buffer,
+    size_t buffer_size,
+    int64_t days)
+{
+    int64_t year;
+    unsigned month, day;
+    civil_from_days(days, &year, &month, &day);
+
+    return snprintf(buffer,
+		    buffer_size,
+		    "%.4" PRId64 "-%.2u-%.2u",
+		    year,
+		    month,
+		    day);
+}
+
+static int display_tod(
+    char *buffer,
+    size_t buffer_size,
+    int64_t ns)
+{
+    return snprintf(buffer,
+		    buffer_size,
+		    "%" PRId64 "h%" PRId64 "m%" PRId64 ".%.2" PRId64 "s",
+		    ns / NS_PER_H,
+		    (ns % NS_PER_H) / NS_PER_M,
+		    (ns % NS_PER_M) / NS_PER_S,
+		    (ns % NS_PER_S) / (10 * NS_PER_MS));
+}
 
 /**************************************************************************/
 /* Value interface                                                        */
 /**************************************************************************/
+/* All time values are a single integer. Durations and times of day
+ * are counted in nanoseconds, dates and dates with time in
+ * microseconds since 1970-01-01, which covers years 0000-9999. */
 struct duration_value_t {
     struct value_iface_t value;
     const struct type_iface_t *type;
     st_bitflag_t class;
-    struct duration_t duration;
+    int64_t ns;
 };
 
 static int duration_value_display(
@@ -44,78 +145,20 @@ static int duration_value_display(
     const struct duration_value_t *dv =
 	CONTAINER_OF(self, struct duration_value_t, value);
 
-    int total_written_bytes = 0;
-    if(dv->duration.d > 0.0)
-    {
-	int written_bytes = snprintf(buffer,
-				     buffer_size,
-				     "%.2fd",
-				     dv->duration.d);
-	CHECK_WRITTEN_BYTES(written_bytes);
-	buffer += written_bytes;
-	buffer_size -= written_bytes;
-	total_written_bytes += written_bytes;
-    }
-    
-    if(dv->duration.h > 0.0)
-    {
-	int written_bytes = snprintf(buffer,
-				     buffer_size,
-				     "%.2fh",
-				     dv->duration.h);
-	CHECK_WRITTEN_BYTES(written_bytes);
-	buffer += written_bytes;
-	buffer_size -= written_bytes;
-	total_written_bytes += written_bytes;
-    }
-
-    if(dv->duration.m > 0.0)
-    {
-	int written_bytes = snprintf(buffer,
-				     buffer_size,
-				     "%.2fm",
-				     dv->duration.m);
-	CHECK_WRITTEN_BYTES(written_bytes);
-	buffer += written_bytes;
-	buffer_size -= written_bytes;
-	total_written_bytes += written_bytes;
-    }
+    int64_t ns = (dv->ns < 0) ? -dv->ns : dv->ns;
 
-    if(dv->duration.s > 0.0)
-    {
-	int written_bytes = snprintf(buffer,
-				     buffer_size,
-				     "%.2fs",
-				     dv->duration.s);
-	CHECK_WRITTEN_BYTES(written_bytes);
-	buffer += written_bytes;
-	buffer_size -= written_bytes;
-	total_written_bytes += written_bytes;
-    }
-
-    if(dv->duration.ms > 0.0)
-    {
-	int written_bytes = snprintf(buffer,
-				     buffer_size,
-				     "%.2fms",
-				     dv->duration.ms);
-	CHECK_WRITTEN_BYTES(written_bytes);
-	buffer += written_bytes;
-	buffer_size -= written_bytes;
-	total_written_bytes += written_bytes;
-    }
-
-    if(total_written_bytes == 0)
-    {
-	int written_bytes = snprintf(buffer,
-				     buffer_size,
-				     "%.2fms",
-				     0.0);
-	CHECK_WRITTEN_BYTES(written_bytes);
-	total_written_bytes += written_bytes;
-    }
+    int written_bytes = snprintf(buffer,
+				 buffer_size,
+				 "%s%.2fd%.2fh%.2fm%.2fs%.2fms",
+				 (dv->ns < 0) ? "-" : "",
+				 (double)(ns / NS_PER_D),
+				 (double)((ns % NS_PER_D) / NS_PER_H),
+				 (double)((ns % NS_PER_H) / NS_PER_M),
+				 (double)((ns % NS_PER_M) / NS_PER_S),
+				 (double)(ns % NS_PER_S) / NS_PER_MS);
+    CHECK_WRITTEN_BYTES(written_bytes);
 
-    return total_written_bytes;
+    return written_bytes;
 }
 
 static int duration_value_assign(
@@ -127,14 +170,7 @@ static int duration_value_assign(
     struct duration_value_t *dv =
 	CONTAINER_OF(self, struct duration_value_t, value);
 
-    const struct duration_t *ov =
-	new_value->duration(new_value, config, issues);
-
-    dv->duration.d = ov->d;
-    dv->duration.h = ov->h;
-    dv->duration.m = ov->m;
-    dv->duration.s = ov->s;
-    dv->duration.ms = ov->ms;
+    dv->ns = new_value->duration(new_value, config, issues);
 
     return ESSTEE_OK;
 }
@@ -158,6 +194,25 @@ static int duration_value_assigns_and_compares(
     return ESSTEE_TRUE;
 }
 
+static int duration_value_operates_with(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(!other_value->duration && !other_value->integer && !other_value->real)
+    {
+	issues->new_issue(
+	    issues,
+	    "durations can only be combined with durations and numbers",
+	    ESSTEE_ARGUMENT_ERROR);
+
+	return ESSTEE_FALSE;
+    }
+
+    return ESSTEE_TRUE;
+}
+
 static const struct type_iface_t * duration_value_type_of(
     const struct value_iface_t *self)
 {
@@ -176,12 +231,61 @@ static st_bitflag_t duration_value_class(
     return dv->class;
 }
 
+static struct value_iface_t * duration_value_create_temp_from(
+    const struct value_iface_t *self,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *dv =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    struct duration_value_t *clone = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	clone,
+	struct duration_value_t,
+	issues,
+	error_free_resources);
+
+    memcpy(clone, dv, sizeof(struct duration_value_t));
+
+    clone->ns = 0;
+    clone->type = NULL;
+    clone->value.assign = duration_value_assign;
+    ST_SET_FLAGS(clone->class, TEMPORARY_VALUE);
+
+    return &(clone->value);
+
+error_free_resources:
+    return NULL;
+}
+
 static void duration_value_destroy(
     struct value_iface_t *self)
 {
     /* TODO: duration value destructor */
 }
 
+static int duration_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct duration_value_t *v =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    return checkpoint->write(checkpoint, &(v->ns), sizeof(v->ns));
+}
+
+static int duration_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *v =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    return checkpoint->read(checkpoint, &(v->ns), sizeof(v->ns));
+}
+
 static int duration_value_greater(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
@@ -191,39 +295,89 @@ static int duration_value_greater(
     struct duration_value_t *dv =
 	CONTAINER_OF(self, struct duration_value_t, value);
 
-    const struct duration_t *ov =
-	other_value->duration(other_value, config, issues);
+    return (dv->ns > other_value->duration(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
-    if(dv->duration.d > ov->d)
-    {
-	return ESSTEE_TRUE;
-    }
+static int duration_value_lesser(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *dv =
+	CONTAINER_OF(self, struct duration_value_t, value);
 
-    if(dv->duration.h > ov->h)
-    {
-	return ESSTEE_TRUE;
-    }
+    return (dv->ns < other_value->duration(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
-    if(dv->duration.m > ov->m)
-    {
-	return ESSTEE_TRUE;
-    }
+static int duration_value_equals(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *dv =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    return (dv->ns == other_value->duration(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+static int duration_value_negate(
+    struct value_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *dv =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    dv->ns = -dv->ns;
+
+    return ESSTEE_OK;
+}
 
-    if(dv->duration.s > ov->s)
+static int duration_value_plus(
+    struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *dv =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    if(!other_value->duration)
     {
-	return ESSTEE_TRUE;
+	return ESSTEE_ERROR;
     }
 
-    if(dv->duration.ms > ov->ms)
+    dv->ns += other_value->duration(other_value, config, issues);
+
+    return ESSTEE_OK;
+}
+
+static int duration_value_minus(
+    struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *dv =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    if(!other_value->duration)
     {
-	return ESSTEE_TRUE;
+	return ESSTEE_ERROR;
     }
-    
-    return ESSTEE_FALSE;
+
+    dv->ns -= other_value->duration(other_value, config, issues);
+
+    return ESSTEE_OK;
 }
 
-static int duration_value_lesser(
-    const struct value_iface_t *self,
+static int duration_value_multiply(
+    struct value_iface_t *self,
     const struct value_iface_t *other_value,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
@@ -231,38 +385,70 @@ static int duration_value_lesser(
     struct duration_value_t *dv =
 	CONTAINER_OF(self, struct duration_value_t, value);
 
-    const struct duration_t *ov =
-	other_value->duration(other_value, config, issues);
-
-    if(dv->duration.d < ov->d)
+    if(other_value->integer)
     {
-	return ESSTEE_TRUE;
+	dv->ns *= other_value->integer(other_value, config, issues);
     }
-
-    if(dv->duration.h < ov->h)
+    else if(other_value->real)
     {
-	return ESSTEE_TRUE;
+	dv->ns = llround((double)dv->ns * other_value->real(other_value, config, issues));
     }
-
-    if(dv->duration.m < ov->m)
+    else
     {
-	return ESSTEE_TRUE;
+	return ESSTEE_ERROR;
     }
 
-    if(dv->duration.s < ov->s)
+    return ESSTEE_OK;
+}
+
+static int duration_value_divide(
+    struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct duration_value_t *dv =
+	CONTAINER_OF(self, struct duration_value_t, value);
+
+    if(other_value->integer)
     {
-	return ESSTEE_TRUE;
+	int64_t divisor = other_value->integer(other_value, config, issues);
+	if(divisor == 0)
+	{
+	    issues->new_issue(
+		issues,
+		"division by zero",
+		ESSTEE_RUNTIME_ERROR);
+
+	    return ESSTEE_ERROR;
+	}
+
+	dv->ns /= divisor;
     }
-
-    if(dv->duration.ms < ov->ms)
+    else if(other_value->real)
     {
-	return ESSTEE_TRUE;
+	double divisor = other_value->real(other_value, config, issues);
+	if(divisor == 0.0)
+	{
+	    issues->new_issue(
+		issues,
+		"division by zero",
+		ESSTEE_RUNTIME_ERROR);
+
+	    return ESSTEE_ERROR;
+	}
+
+	dv->ns = llround((double)dv->ns / divisor);
     }
-    
-    return ESSTEE_FALSE;
+    else
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
 }
 
-static const struct duration_t * duration_value_duration(
+static int64_t duration_value_duration(
     const struct value_iface_t *self,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
@@ -270,14 +456,14 @@ static const struct duration_t * duration_value_duration(
     struct duration_value_t *dv =
 	CONTAINER_OF(self, struct duration_value_t, value);
 
-    return &(dv->duration);
+    return dv->ns;
 }
 
 struct date_value_t {
     struct value_iface_t value;
     const struct type_iface_t *type;
     st_bitflag_t class;
-    struct date_t date;
+    int64_t us;
 };
 
 static int date_value_display(
@@ -289,12 +475,10 @@ static int date_value_display(
     const struct date_value_t *dv =
 	CONTAINER_OF(self, struct date_value_t, value);
 
-    int written_bytes = snprintf(buffer,
-				 buffer_size,
-				 "%.4" PRIu64 "-%.2" PRIu8 "-%.2" PRIu8,
-				 dv->date.y,
-				 dv->date.m,
-				 dv->date.d);
+    int64_t days, day_ns;
+    split_date_time(dv->us, &days, &day_ns);
+
+    int written_bytes = display_date(buffer, buffer_size, days);
     CHECK_WRITTEN_BYTES(written_bytes);
 
     return written_bytes;
@@ -309,12 +493,7 @@ static int date_value_assign(
     struct date_value_t *dv =
 	CONTAINER_OF(self, struct date_value_t, value);
 
-    const struct date_t *ov =
-	new_value->date(new_value, config, issues);
-
-    dv->date.y = ov->y;
-    dv->date.m = ov->m;
-    dv->date.d = ov->d;
+    dv->us = new_value->date(new_value, config, issues);
 
     return ESSTEE_OK;
 }
@@ -362,34 +541,39 @@ static void date_value_destroy(
     /* TODO: date destructor */
 }
 
-static int date_value_greater(
+static int date_value_checkpoint(
     const struct value_iface_t *self,
-    const struct value_iface_t *other_value,
-    const struct config_iface_t *config,
+    struct checkpoint_iface_t *checkpoint,
     struct issues_iface_t *issues)
 {
-    struct date_value_t *dv =
+    const struct date_value_t *v =
 	CONTAINER_OF(self, struct date_value_t, value);
 
-    const struct date_t *ov =
-	other_value->date(other_value, config, issues);
+    return checkpoint->write(checkpoint, &(v->us), sizeof(v->us));
+}
 
-    if(dv->date.y > ov->y)
-    {
-	return ESSTEE_TRUE;
-    }
+static int date_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct date_value_t *v =
+	CONTAINER_OF(self, struct date_value_t, value);
 
-    if(dv->date.m > ov->m)
-    {
-	return ESSTEE_TRUE;
-    }
+    return checkpoint->read(checkpoint, &(v->us), sizeof(v->us));
+}
 
-    if(dv->date.d > ov->d)
-    {
-	return ESSTEE_TRUE;
-    }
+static int date_value_greater(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct date_value_t *dv =
+	CONTAINER_OF(self, struct date_value_t, value);
 
-    return ESSTEE_FALSE;
+    return (dv->us > other_value->date(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
 static int date_value_lesser(
@@ -401,28 +585,24 @@ static int date_value_lesser(
     struct date_value_t *dv =
 	CONTAINER_OF(self, struct date_value_t, value);
 
-    const struct date_t *ov =
-	other_value->date(other_value, config, issues);
-
-    if(dv->date.y < ov->y)
-    {
-	return ESSTEE_TRUE;
-    }
-
-    if(dv->date.m < ov->m)
-    {
-	return ESSTEE_TRUE;
-    }
+    return (dv->us < other_value->date(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
-    if(dv->date.d < ov->d)
-    {
-	return ESSTEE_TRUE;
-    }
+static int date_value_equals(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct date_value_t *dv =
+	CONTAINER_OF(self, struct date_value_t, value);
 
-    return ESSTEE_FALSE;
+    return (dv->us == other_value->date(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
-static const struct date_t * date_value_date(
+static int64_t date_value_date(
     const struct value_iface_t *self,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
@@ -430,14 +610,14 @@ static const struct date_t * date_value_date(
     struct date_value_t *dv =
 	CONTAINER_OF(self, struct date_value_t, value);
 
-    return &(dv->date);
+    return dv->us;
 }
 
 struct tod_value_t {
     struct value_iface_t value;
     const struct type_iface_t *type;
     st_bitflag_t class;
-    struct tod_t tod;
+    int64_t ns;
 };
 
 static int tod_value_display(
@@ -449,13 +629,7 @@ static int tod_value_display(
     const struct tod_value_t *tv =
 	CONTAINER_OF(self, struct tod_value_t, value);
 
-    int written_bytes = snprintf(buffer,
-				 buffer_size,
-				 "%" PRIu8 "h%" PRIu8 "m%" PRIu8 ".%.2" PRIu8 "s",
-				 tv->tod.h,
-				 tv->tod.m,
-				 tv->tod.s,
-				 tv->tod.fs);
+    int written_bytes = display_tod(buffer, buffer_size, tv->ns);
     CHECK_WRITTEN_BYTES(written_bytes);
 
     return written_bytes;
@@ -470,13 +644,7 @@ static int tod_value_assign(
     struct tod_value_t *tv =
 	CONTAINER_OF(self, struct tod_value_t, value);
 
-    const struct tod_t *ov =
-	new_value->tod(new_value, config, issues);
-
-    tv->tod.h = ov->h;
-    tv->tod.m = ov->m;
-    tv->tod.s = ov->s;
-    tv->tod.fs = ov->fs;
+    tv->ns = new_value->tod(new_value, config, issues);
 
     return ESSTEE_OK;
 }
@@ -500,6 +668,25 @@ static int tod_value_assigns_and_compares(
     return ESSTEE_TRUE;
 }
 
+static int time_point_operates_with(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(!other_value->duration)
+    {
+	issues->new_issue(
+	    issues,
+	    "only durations can be added to or subtracted from a point in time",
+	    ESSTEE_ARGUMENT_ERROR);
+
+	return ESSTEE_FALSE;
+    }
+
+    return ESSTEE_TRUE;
+}
+
 static const struct type_iface_t * tod_value_type_of(
     const struct value_iface_t *self)
 {
@@ -518,12 +705,61 @@ static st_bitflag_t tod_value_class(
     return tv->class;
 }
 
+static struct value_iface_t * tod_value_create_temp_from(
+    const struct value_iface_t *self,
+    struct issues_iface_t *issues)
+{
+    struct tod_value_t *tv =
+	CONTAINER_OF(self, struct tod_value_t, value);
+
+    struct tod_value_t *clone = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	clone,
+	struct tod_value_t,
+	issues,
+	error_free_resources);
+
+    memcpy(clone, tv, sizeof(struct tod_value_t));
+
+    clone->ns = 0;
+    clone->type = NULL;
+    clone->value.assign = tod_value_assign;
+    ST_SET_FLAGS(clone->class, TEMPORARY_VALUE);
+
+    return &(clone->value);
+
+error_free_resources:
+    return NULL;
+}
+
 static void tod_value_destroy(
     struct value_iface_t *self)
 {
     /* TODO: tod value destructor */
 }
 
+static int tod_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct tod_value_t *v =
+	CONTAINER_OF(self, struct tod_value_t, value);
+
+    return checkpoint->write(checkpoint, &(v->ns), sizeof(v->ns));
+}
+
+static int tod_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct tod_value_t *v =
+	CONTAINER_OF(self, struct tod_value_t, value);
+
+    return checkpoint->read(checkpoint, &(v->ns), sizeof(v->ns));
+}
+
 static int tod_value_greater(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
@@ -533,33 +769,24 @@ static int tod_value_greater(
     struct tod_value_t *tv =
 	CONTAINER_OF(self, struct tod_value_t, value);
 
-    const struct tod_t *ov =
-	other_value->tod(other_value, config, issues);
-
-    if(tv->tod.h > ov->h)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    if(tv->tod.m > ov->m)
-    {
-	return ESSTEE_TRUE;
-    }
+    return (tv->ns > other_value->tod(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
-    if(tv->tod.s > ov->s)
-    {
-	return ESSTEE_TRUE;
-    }
+static int tod_value_lesser(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct tod_value_t *tv =
+	CONTAINER_OF(self, struct tod_value_t, value);
 
-    if(tv->tod.fs > ov->fs)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    return ESSTEE_FALSE;
+    return (tv->ns < other_value->tod(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
-static int tod_value_lesser(
+static int tod_value_equals(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
     const struct config_iface_t *config,
@@ -568,33 +795,59 @@ static int tod_value_lesser(
     struct tod_value_t *tv =
 	CONTAINER_OF(self, struct tod_value_t, value);
 
-    const struct tod_t *ov =
-	other_value->tod(other_value, config, issues);
+    return (tv->ns == other_value->tod(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
-    if(tv->tod.h < ov->h)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    if(tv->tod.m < ov->m)
+/* A time of day wraps around at midnight */
+static int tod_value_shift(
+    struct tod_value_t *tv,
+    int64_t ns)
+{
+    tv->ns = (tv->ns + ns % NS_PER_D) % NS_PER_D;
+    if(tv->ns < 0)
     {
-	return ESSTEE_TRUE;
+	tv->ns += NS_PER_D;
     }
 
-    if(tv->tod.s < ov->s)
+    return ESSTEE_OK;
+}
+
+static int tod_value_plus(
+    struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct tod_value_t *tv =
+	CONTAINER_OF(self, struct tod_value_t, value);
+
+    if(!other_value->duration)
     {
-	return ESSTEE_TRUE;
+	return ESSTEE_ERROR;
     }
 
-    if(tv->tod.fs < ov->fs)
+    return tod_value_shift(tv, other_value->duration(other_value, config, issues));
+}
+
+static int tod_value_minus(
+    struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct tod_value_t *tv =
+	CONTAINER_OF(self, struct tod_value_t, value);
+
+    if(!other_value->duration)
     {
-	return ESSTEE_TRUE;
+	return ESSTEE_ERROR;
     }
-    
-    return ESSTEE_FALSE;
+
+    return tod_value_shift(tv, -other_value->duration(other_value, config, issues));
 }
 
-static const struct tod_t * tod_value_tod(
+static int64_t tod_value_tod(
     const struct value_iface_t *self,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
@@ -602,14 +855,14 @@ static const struct tod_t * tod_value_tod(
     struct tod_value_t *tv =
 	CONTAINER_OF(self, struct tod_value_t, value);
 
-    return &(tv->tod);
+    return tv->ns;
 }
 
 struct date_tod_value_t {
     struct value_iface_t value;
     const struct type_iface_t *type;
     st_bitflag_t class;
-    struct date_tod_t dt;
+    int64_t us;
 };
 
 static int date_tod_value_display(
@@ -621,24 +874,23 @@ static int date_tod_value_display(
     const struct date_tod_value_t *dv =
 	CONTAINER_OF(self, struct date_tod_value_t, value);
 
+    int64_t days, day_ns;
+    split_date_time(dv->us, &days, &day_ns);
+
     int total_written_bytes = 0;
-    int written_bytes = snprintf(buffer,
-				 buffer_size,
-				 "%.4" PRIu64 "-%.2" PRIu8 "-%.2" PRIu8 "-",
-				 dv->dt.date.y,
-				 dv->dt.date.m,
-				 dv->dt.date.d);
+    int written_bytes = display_date(buffer, buffer_size, days);
     CHECK_WRITTEN_BYTES(written_bytes);
     total_written_bytes += written_bytes;
-    buffer += written_bytes;
-    
-    written_bytes = snprintf(buffer,
-			     buffer_size,
-			     "%" PRIu8 "h%" PRIu8 "m%" PRIu8 ".%.2" PRIu8 "s",
-			     dv->dt.tod.h,
-			     dv->dt.tod.m,
-			     dv->dt.tod.s,
-			     dv->dt.tod.fs);
+
+    written_bytes = snprintf(buffer + total_written_bytes,
+			     buffer_size - total_written_bytes,
+			     "-");
+    CHECK_WRITTEN_BYTES(written_bytes);
+    total_written_bytes += written_bytes;
+
+    written_bytes = display_tod(buffer + total_written_bytes,
+				buffer_size - total_written_bytes,
+				day_ns);
     CHECK_WRITTEN_BYTES(written_bytes);
     total_written_bytes += written_bytes;
 
@@ -654,17 +906,8 @@ static int date_tod_value_assign(
     struct date_tod_value_t *dv =
 	CONTAINER_OF(self, struct date_tod_value_t, value);
 
-    const struct date_tod_t *ov =
-	new_value->date_tod(new_value, config, issues);
+    dv->us = new_value->date_tod(new_value, config, issues);
 
-    dv->dt.date.y = ov->date.y;
-    dv->dt.date.m = ov->date.m;
-    dv->dt.date.d = ov->date.d;
-    dv->dt.tod.h = ov->tod.h;
-    dv->dt.tod.m = ov->tod.m;
-    dv->dt.tod.s = ov->tod.s;
-    dv->dt.tod.fs = ov->tod.fs;
-    
     return ESSTEE_OK;
 }
 
@@ -705,12 +948,61 @@ static st_bitflag_t date_tod_value_class(
     return dv->class;
 }
 
+static struct value_iface_t * date_tod_value_create_temp_from(
+    const struct value_iface_t *self,
+    struct issues_iface_t *issues)
+{
+    struct date_tod_value_t *dv =
+	CONTAINER_OF(self, struct date_tod_value_t, value);
+
+    struct date_tod_value_t *clone = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	clone,
+	struct date_tod_value_t,
+	issues,
+	error_free_resources);
+
+    memcpy(clone, dv, sizeof(struct date_tod_value_t));
+
+    clone->us = 0;
+    clone->type = NULL;
+    clone->value.assign = date_tod_value_assign;
+    ST_SET_FLAGS(clone->class, TEMPORARY_VALUE);
+
+    return &(clone->value);
+
+error_free_resources:
+    return NULL;
+}
+
 static void date_tod_value_destroy(
     struct value_iface_t *self)
 {
     /* TODO: date tod value destructor */
 }
 
+static int date_tod_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct date_tod_value_t *v =
+	CONTAINER_OF(self, struct date_tod_value_t, value);
+
+    return checkpoint->write(checkpoint, &(v->us), sizeof(v->us));
+}
+
+static int date_tod_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct date_tod_value_t *v =
+	CONTAINER_OF(self, struct date_tod_value_t, value);
+
+    return checkpoint->read(checkpoint, &(v->us), sizeof(v->us));
+}
+
 static int date_tod_value_greater(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
@@ -720,48 +1012,24 @@ static int date_tod_value_greater(
     struct date_tod_value_t *dv =
 	CONTAINER_OF(self, struct date_tod_value_t, value);
 
-    const struct date_tod_t *ov =
-	other_value->date_tod(other_value, config, issues);
-
-    if(dv->dt.date.y > ov->date.y)
-    {
-	return ESSTEE_TRUE;
-    }
-
-    if(dv->dt.date.m > ov->date.m)
-    {
-	return ESSTEE_TRUE;
-    }
-
-    if(dv->dt.date.d > ov->date.d)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    if(dv->dt.tod.h > ov->tod.h)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    if(dv->dt.tod.m > ov->tod.m)
-    {
-	return ESSTEE_TRUE;
-    }
+    return (dv->us > other_value->date_tod(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
-    if(dv->dt.tod.s > ov->tod.s)
-    {
-	return ESSTEE_TRUE;
-    }
+static int date_tod_value_lesser(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct date_tod_value_t *dv =
+	CONTAINER_OF(self, struct date_tod_value_t, value);
 
-    if(dv->dt.tod.fs > ov->tod.fs)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    return ESSTEE_FALSE;
+    return (dv->us < other_value->date_tod(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
-static int date_tod_value_lesser(
+static int date_tod_value_equals(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
     const struct config_iface_t *config,
@@ -770,48 +1038,49 @@ static int date_tod_value_lesser(
     struct date_tod_value_t *dv =
 	CONTAINER_OF(self, struct date_tod_value_t, value);
 
-    const struct date_tod_t *ov =
-	other_value->date_tod(other_value, config, issues);
+    return (dv->us == other_value->date_tod(other_value, config, issues))
+	? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
-    if(dv->dt.date.y < ov->date.y)
-    {
-	return ESSTEE_TRUE;
-    }
+static int date_tod_value_plus(
+    struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct date_tod_value_t *dv =
+	CONTAINER_OF(self, struct date_tod_value_t, value);
 
-    if(dv->dt.date.m < ov->date.m)
+    if(!other_value->duration)
     {
-	return ESSTEE_TRUE;
+	return ESSTEE_ERROR;
     }
 
-    if(dv->dt.date.d < ov->date.d)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    if(dv->dt.tod.h < ov->tod.h)
-    {
-	return ESSTEE_TRUE;
-    }
-    
-    if(dv->dt.tod.m < ov->tod.m)
-    {
-	return ESSTEE_TRUE;
-    }
+    dv->us += other_value->duration(other_value, config, issues) / NS_PER_US;
 
-    if(dv->dt.tod.s < ov->tod.s)
-    {
-	return ESSTEE_TRUE;
-    }
+    return ESSTEE_OK;
+}
 
-    if(dv->dt.tod.fs < ov->tod.fs)
+static int date_tod_value_minus(
+    struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct date_tod_value_t *dv =
+	CONTAINER_OF(self, struct date_tod_value_t, value);
+
+    if(!other_value->duration)
     {
-	return ESSTEE_TRUE;
+	return ESSTEE_ERROR;
     }
-    
-    return ESSTEE_FALSE;
+
+    dv->us -= other_value->duration(other_value, config, issues) / NS_PER_US;
+
+    return ESSTEE_OK;
 }
 
-static const struct date_tod_t * date_tod_value_tod(
+static int64_t date_tod_value_date_tod(
     const struct value_iface_t *self,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
@@ -819,7 +1088,7 @@ static const struct date_tod_t * date_tod_value_tod(
     struct date_tod_value_t *dv =
 	CONTAINER_OF(self, struct date_tod_value_t, value);
 
-    return &(dv->dt);
+    return dv->us;
 }
 
 /**************************************************************************/
@@ -827,11 +1096,7 @@ static const struct date_tod_t * date_tod_value_tod(
 /**************************************************************************/
 struct duration_type_t {
     struct type_iface_t type;
-    double default_d;
-    double default_h;
-    double default_m;
-    double default_s;
-    double default_ms;
+    int64_t default_ns;
 };
 
 static struct value_iface_t * duration_type_create_value_of(
@@ -847,18 +1112,29 @@ static struct value_iface_t * duration_type_create_value_of(
 	error_free_resources);
 
     dv->type = self;
+    dv->class = 0;
+    dv->ns = 0;
     
     memset(&(dv->value), 0, sizeof(struct value_iface_t));
     dv->value.display = duration_value_display;
     dv->value.assignable_from = duration_value_assigns_and_compares;
     dv->value.comparable_to = duration_value_assigns_and_compares;
+    dv->value.operates_with = duration_value_operates_with;
     dv->value.assign = duration_value_assign;
     dv->value.type_of = duration_value_type_of;
+    dv->value.create_temp_from = duration_value_create_temp_from;
     dv->value.destroy = duration_value_destroy;
+    dv->value.checkpoint = duration_value_checkpoint;
+    dv->value.restore = duration_value_restore;
 
     dv->value.greater = duration_value_greater;
     dv->value.lesser = duration_value_lesser;
-    dv->value.equals = st_general_value_equals;
+    dv->value.equals = duration_value_equals;
+    dv->value.negate = duration_value_negate;
+    dv->value.plus = duration_value_plus;
+    dv->value.minus = duration_value_minus;
+    dv->value.multiply = duration_value_multiply;
+    dv->value.divide = duration_value_divide;
     dv->value.duration = duration_value_duration;
     dv->value.class = duration_value_class;
 
@@ -880,11 +1156,7 @@ static int duration_type_reset_value_of(
     struct duration_value_t *dv =
 	CONTAINER_OF(value_of, struct duration_value_t, value);
 
-    dv->duration.d = dt->default_d;
-    dv->duration.h = dt->default_h;
-    dv->duration.m = dt->default_m;
-    dv->duration.s = dt->default_s;
-    dv->duration.ms = dt->default_ms;
+    dv->ns = dt->default_ns;
 
     return ESSTEE_OK;
 }
@@ -923,9 +1195,7 @@ static void duration_type_destroy(
 
 struct date_type_t {
     struct type_iface_t type;
-    uint64_t default_year;
-    uint8_t default_month;
-    uint8_t default_day;
+    int64_t default_us;
 };
 
 static struct value_iface_t * date_type_create_value_of(
@@ -942,6 +1212,8 @@ static struct value_iface_t * date_type_create_value_of(
 	error_free_resources);
 
     dv->type = self;
+    dv->class = 0;
+    dv->us = 0;
     
     memset(&(dv->value), 0, sizeof(struct value_iface_t));
     dv->value.display = date_value_display;
@@ -950,10 +1222,12 @@ static struct value_iface_t * date_type_create_value_of(
     dv->value.assign = date_value_assign;
     dv->value.type_of = date_value_type_of;
     dv->value.destroy = date_value_destroy;
+    dv->value.checkpoint = date_value_checkpoint;
+    dv->value.restore = date_value_restore;
 
     dv->value.greater = date_value_greater;
     dv->value.lesser = date_value_lesser;
-    dv->value.equals = st_general_value_equals;
+    dv->value.equals = date_value_equals;
     dv->value.date = date_value_date;
     dv->value.class = date_value_class;
 
@@ -975,9 +1249,7 @@ static int date_type_reset_value_of(
     struct date_value_t *dv =
 	CONTAINER_OF(value_of, struct date_value_t, value);
 
-    dv->date.y = dt->default_year;
-    dv->date.m = dt->default_month;
-    dv->date.d = dt->default_day;
+    dv->us = dt->default_us;
 
     return ESSTEE_OK;
 }
@@ -1016,10 +1288,7 @@ static void date_type_destroy(
 
 struct tod_type_t {
     struct type_iface_t type;
-    uint8_t default_hour;
-    uint8_t default_minute;
-    uint8_t default_second;
-    uint8_t default_fractional_second;
+    int64_t default_ns;
 };
 
 static struct value_iface_t * tod_type_create_value_of(
@@ -1036,18 +1305,26 @@ static struct value_iface_t * tod_type_create_value_of(
 	error_free_resources);
 
     tv->type = self;
+    tv->class = 0;
+    tv->ns = 0;
 
     memset(&(tv->value), 0, sizeof(struct value_iface_t));
     tv->value.display = tod_value_display;
     tv->value.assignable_from = tod_value_assigns_and_compares;
     tv->value.comparable_to = tod_value_assigns_and_compares;
+    tv->value.operates_with = time_point_operates_with;
     tv->value.assign = tod_value_assign;
     tv->value.type_of = tod_value_type_of;
+    tv->value.create_temp_from = tod_value_create_temp_from;
     tv->value.destroy = tod_value_destroy;
+    tv->value.checkpoint = tod_value_checkpoint;
+    tv->value.restore = tod_value_restore;
 
     tv->value.greater = tod_value_greater;
     tv->value.lesser = tod_value_lesser;
-    tv->value.equals = st_general_value_equals;
+    tv->value.equals = tod_value_equals;
+    tv->value.plus = tod_value_plus;
+    tv->value.minus = tod_value_minus;
     tv->value.tod = tod_value_tod;
     tv->value.class = tod_value_class;
 
@@ -1069,10 +1346,7 @@ static int tod_type_reset_value_of(
     struct tod_value_t *tv =
 	CONTAINER_OF(value_of, struct tod_value_t, value);
 
-    tv->tod.h = tt->default_hour;
-    tv->tod.m = tt->default_minute;
-    tv->tod.s = tt->default_second;
-    tv->tod.fs = tt->default_fractional_second;
+    tv->ns = tt->default_ns;
 
     return ESSTEE_OK;
 }
@@ -1111,13 +1385,7 @@ static void tod_type_destroy(
 
 struct date_tod_type_t {
     struct type_iface_t type;
-    uint64_t default_year;
-    uint8_t default_month;
-    uint8_t default_day;
-    uint8_t default_hour;
-    uint8_t default_minute;
-    uint8_t default_second;
-    uint8_t default_fractional_second;
+    int64_t default_us;
 };
 
 static struct value_iface_t * date_tod_type_create_value_of(
@@ -1134,19 +1402,27 @@ static struct value_iface_t * date_tod_type_create_value_of(
 	error_free_resources);
 
     dv->type = self;
+    dv->class = 0;
+    dv->us = 0;
     
     memset(&(dv->value), 0, sizeof(struct value_iface_t));
     dv->value.display = date_tod_value_display;
     dv->value.assignable_from = date_tod_value_assigns_and_compares;
     dv->value.comparable_to = date_tod_value_assigns_and_compares;
+    dv->value.operates_with = time_point_operates_with;
     dv->value.assign = date_tod_value_assign;
     dv->value.type_of = date_tod_value_type_of;
+    dv->value.create_temp_from = date_tod_value_create_temp_from;
     dv->value.destroy = date_tod_value_destroy;
+    dv->value.checkpoint = date_tod_value_checkpoint;
+    dv->value.restore = date_tod_value_restore;
 
     dv->value.greater = date_tod_value_greater;
     dv->value.lesser = date_tod_value_lesser;
-    dv->value.equals = st_general_value_equals;
-    dv->value.date_tod = date_tod_value_tod;
+    dv->value.equals = date_tod_value_equals;
+    dv->value.plus = date_tod_value_plus;
+    dv->value.minus = date_tod_value_minus;
+    dv->value.date_tod = date_tod_value_date_tod;
     dv->value.class = date_tod_value_class;
 
     return &(dv->value);
@@ -1167,13 +1443,7 @@ static int date_tod_type_reset_value_of(
     struct date_tod_value_t *dv =
 	CONTAINER_OF(value_of, struct date_tod_value_t, value);
 
-    dv->dt.date.y = dt->default_year;
-    dv->dt.date.m = dt->default_month;
-    dv->dt.date.d = dt->default_day;
-    dv->dt.tod.h = dt->default_hour;
-    dv->dt.tod.m = dt->default_minute;
-    dv->dt.tod.s = dt->default_second;
-    dv->dt.tod.fs = dt->default_fractional_second;
+    dv->us = dt->default_us;
     
     return ESSTEE_OK;
 }
@@ -1213,6 +1483,9 @@ static void date_tod_type_destroy(
 /**************************************************************************/
 /* Public interface                                                       */
 /**************************************************************************/
+/* 0001-01-01, in microseconds since 1970-01-01 */
+#define DEFAULT_DATE_US (INT64_C(-719162)*US_PER_D)
+
 static struct duration_type_t duration_type_template = {
     .type = {
 	.create_value_of = duration_type_create_value_of,
@@ -1223,11 +1496,7 @@ static struct duration_type_t duration_type_template = {
 	.destroy = duration_type_destroy,
 	.identifier = "TIME",
     },
-    .default_d = 0.0,
-    .default_h = 0.0,
-    .default_m = 0.0,
-    .default_s = 0.0,
-    .default_ms = 0.0,
+    .default_ns = 0,
 };
 
 static struct date_type_t date_type_template = {
@@ -1240,9 +1509,7 @@ static struct date_type_t date_type_template = {
 	.destroy = date_type_destroy,
 	.identifier = "DATE",
     },
-    .default_year = 1,
-    .default_month = 1,
-    .default_day = 1
+    .default_us = DEFAULT_DATE_US,
 };
 
 static struct tod_type_t tod_type_template = {
@@ -1255,9 +1522,7 @@ static struct tod_type_t tod_type_template = {
 	.destroy = tod_type_destroy,
 	.identifier = "TIME_OF_DAY",
     },
-    .default_hour = 0,
-    .default_minute = 0,
-    .default_second = 0,
+    .default_ns = 0,
 };
 
 static struct date_tod_type_t date_tod_type_template = {
@@ -1270,12 +1535,7 @@ static struct date_tod_type_t date_tod_type_template = {
 	.destroy = date_tod_type_destroy,
 	.identifier = "DATE_AND_TIME",
     },
-    .default_year = 1,
-    .default_month = 1,
-    .default_day = 1,
-    .default_hour = 0,
-    .default_minute = 0,
-    .default_second = 0,
+    .default_us = DEFAULT_DATE_US,
 };
 
 struct type_iface_t * st_new_elementary_date_time_types()
@@ -1369,12 +1629,13 @@ struct value_iface_t * st_new_typeless_duration_value(
     struct duration_value_t *dv =
 	CONTAINER_OF(v, struct duration_value_t, value);
 
+    /* Each part is rounded on its own, so that whole parts are exact */
     dv->class = value_class;
-    dv->duration.d = days;
-    dv->duration.h = hours;
-    dv->duration.m = minutes;
-    dv->duration.s = seconds;
-    dv->duration.ms = milliseconds;
+    dv->ns = llround(days * NS_PER_D)
+	+ llround(hours * NS_PER_H)
+	+ llround(minutes * NS_PER_M)
+	+ llround(seconds * NS_PER_S)
+	+ llround(milliseconds * NS_PER_MS);
 
     return v;
 }
@@ -1399,9 +1660,7 @@ struct value_iface_t * st_new_typeless_date_value(
 	CONTAINER_OF(v, struct date_value_t, value);
 
     dv->class = value_class;
-    dv->date.y = year;
-    dv->date.m = month;
-    dv->date.d = day;
+    dv->us = days_from_civil((int64_t)year, month, day) * US_PER_D;
 
     return v;
 }
@@ -1427,10 +1686,10 @@ struct value_iface_t * st_new_typeless_tod_value(
 	CONTAINER_OF(v, struct tod_value_t, value);
 
     tv->class = value_class;
-    tv->tod.h = hour;
-    tv->tod.m = minute;
-    tv->tod.s = second;
-    tv->tod.fs = partial_second;
+    tv->ns = hour * NS_PER_H
+	+ minute * NS_PER_M
+	+ second * NS_PER_S
+	+ partial_second * 10 * NS_PER_MS;
 
     return v;
 }
@@ -1458,14 +1717,14 @@ struct value_iface_t * st_new_typeless_date_tod_value(
     struct date_tod_value_t *dv =
 	CONTAINER_OF(v, struct date_tod_value_t, value);
 
+    int64_t day_ns = hour * NS_PER_H
+	+ minute * NS_PER_M
+	+ second * NS_PER_S
+	+ partial_second * 10 * NS_PER_MS;
+
     dv->class = value_class;
-    dv->dt.date.y = year;
-    dv->dt.date.m = month;
-    dv->dt.date.d = day;
-    dv->dt.tod.h = hour;
-    dv->dt.tod.m = minute;
-    dv->dt.tod.s = second;
-    dv->dt.tod.fs = partial_second;
+    dv->us = days_from_civil((int64_t)year, month, day) * US_PER_D
+	+ day_ns / NS_PER_US;
 
     return v;
 }
@@ -23,32 +23,6 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdint.h>
 
-struct duration_t {
-    double d;
-    double h;
-    double m;
-    double s;
-    double ms;
-};
-
-struct date_t {
-    uint64_t y;
-    uint8_t m;
-    uint8_t d;
-};
-
-struct tod_t {
-    uint8_t h;
-    uint8_t m;
-    uint8_t s;
-    uint8_t fs;
-};
-
-struct date_tod_t {
-    struct date_t date;
-    struct tod_t tod;
-};
-
 struct type_iface_t * st_new_elementary_date_time_types();
 
 struct value_iface_t * st_new_typeless_duration_value(
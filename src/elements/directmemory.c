@@ -82,6 +82,26 @@ static int direct_memory_reset(
     return ESSTEE_ERROR;
 }
 
+static int direct_memory_checkpoint(
+    const struct dmem_iface_t *self,
+    struct checkpoint_iface_t *checkpoint)
+{
+    const struct direct_memory_t *dm =
+	CONTAINER_OF(self, struct direct_memory_t, dmem);
+
+    return checkpoint->write(checkpoint, dm->storage, dm->size);
+}
+
+static int direct_memory_restore(
+    struct dmem_iface_t *self,
+    struct checkpoint_iface_t *checkpoint)
+{
+    struct direct_memory_t *dm =
+	CONTAINER_OF(self, struct direct_memory_t, dmem);
+
+    return checkpoint->read(checkpoint, dm->storage, dm->size);
+}
+
 static void direct_memory_destroy(
     struct dmem_iface_t *self)
 {
@@ -111,6 +131,8 @@ struct dmem_iface_t * st_new_direct_memory(
     
     dm->dmem.offset = direct_memory_offset;
     dm->dmem.reset = direct_memory_reset;
+    dm->dmem.checkpoint = direct_memory_checkpoint;
+    dm->dmem.restore = direct_memory_restore;
     dm->dmem.destroy = direct_memory_destroy;
     
     return &(dm->dmem);
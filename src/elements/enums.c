@@ -20,6 +20,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/enums.h>
 #include <elements/values.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 #include <stdio.h>
 
 /**************************************************************************/
@@ -35,8 +36,35 @@ struct enum_group_item_t {
 struct enum_group_t {
     struct enum_group_iface_t group;
     struct enum_group_item_t *items;
+    const struct enum_item_t **items_by_ordinal;
+    int items_count;
 };
 
+/* Ordinals of items defined by a type are fixed, those of literals are
+ * looked up once for each group they are used with */
+static int enum_group_ordinal_of(
+    const struct enum_group_t *eg,
+    const struct enum_item_t *item)
+{
+    if(item->group)
+    {
+	return item->ordinal;
+    }
+
+    if(item->resolved_in != &(eg->group))
+    {
+	struct enum_group_item_t *found = NULL;
+	HASH_FIND_STR(eg->items, item->identifier, found);
+
+	/* The resolution is a cache of the literal, not part of its value */
+	struct enum_item_t *literal = (struct enum_item_t *)item;
+	literal->ordinal = (found) ? found->item.ordinal : -1;
+	literal->resolved_in = &(eg->group);
+    }
+
+    return item->ordinal;
+}
+
 static int enum_group_extend(
     struct enum_group_iface_t *self,
     char *identifier,
@@ -85,7 +113,10 @@ static int enum_group_extend(
     ei->identifier = identifier;
     ei->location = ei_location;
     ei->item.identifier = identifier;
-    ei->item.location = location;
+    ei->item.location = ei_location;
+    ei->item.group = &(eg->group);
+    ei->item.ordinal = eg->items_count;
+    ei->item.resolved_in = &(eg->group);
     
     HASH_ADD_KEYPTR(hh, 
 		    eg->items, 
@@ -93,6 +124,8 @@ static int enum_group_extend(
 		    strlen(ei->identifier), 
 		    ei);
 
+    eg->items_count++;
+
     return ESSTEE_OK;
     
 error_free_resources:
@@ -119,6 +152,9 @@ struct enum_group_iface_t * st_create_enum_group(
 	issues,
 	error_free_resources);
 
+    eg->items = NULL;
+    eg->items_by_ordinal = NULL;
+    eg->items_count = 0;
     memset(&(eg->group), 0, sizeof(struct enum_group_iface_t));
     eg->group.extend = enum_group_extend;
     eg->group.destroy = enum_group_destroy;
@@ -135,9 +171,16 @@ error_free_resources:
 struct enum_value_t {
     struct value_iface_t value;
     const struct type_iface_t *type;
-    const struct enum_item_t *constant;
+    const struct enum_group_t *group;
+    int ordinal;
 };
 
+static int enum_value_equals(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues);
+
 static int enum_value_display(
     const struct value_iface_t *self,
     char *buffer,
@@ -150,7 +193,7 @@ static int enum_value_display(
     int written_bytes = snprintf(buffer,
 				 buffer_size,
 				 "%s",
-				 ev->constant->identifier);
+				 ev->group->items_by_ordinal[ev->ordinal]->identifier);
 
     CHECK_WRITTEN_BYTES(written_bytes);
 
@@ -165,10 +208,34 @@ static int enum_value_assign(
 {
     struct enum_value_t *ev =
 	CONTAINER_OF(self, struct enum_value_t, value);
-    
-    ev->constant = new_value->enumeration(new_value,
-					  config,
-					  issues);
+
+    if(new_value->equals == enum_value_equals)
+    {
+	const struct enum_value_t *nev =
+	    CONTAINER_OF(new_value, struct enum_value_t, value);
+
+	ev->ordinal = nev->ordinal;
+
+	return ESSTEE_OK;
+    }
+
+    const struct enum_item_t *new_item = new_value->enumeration(new_value,
+								config,
+								issues);
+
+    int ordinal = enum_group_ordinal_of(ev->group, new_item);
+    if(ordinal < 0)
+    {
+	issues->new_issue(
+	    issues,
+	    "enumerated value '%s' is not part of the enumerated type",
+	    ESSTEE_TYPE_ERROR,
+	    new_item->identifier);
+
+	return ESSTEE_ERROR;
+    }
+
+    ev->ordinal = ordinal;
 
     return ESSTEE_OK;
 }
@@ -235,6 +302,28 @@ static void enum_value_destroy(
     /* TODO: enum value destructor */
 }
 
+static int enum_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct enum_value_t *v =
+	CONTAINER_OF(self, struct enum_value_t, value);
+
+    return checkpoint->write(checkpoint, &(v->ordinal), sizeof(v->ordinal));
+}
+
+static int enum_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct enum_value_t *v =
+	CONTAINER_OF(self, struct enum_value_t, value);
+
+    return checkpoint->read(checkpoint, &(v->ordinal), sizeof(v->ordinal));
+}
+
 static int enum_value_equals(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
@@ -244,17 +333,25 @@ static int enum_value_equals(
     struct enum_value_t *ev =
 	CONTAINER_OF(self, struct enum_value_t, value);
 
-    const struct enum_item_t *other_value_enum =
-	other_value->enumeration(other_value,
-				 config,
-				 issues);
-    
-    if(strcmp(ev->constant->identifier, other_value_enum->identifier) == 0)
+    int other_ordinal;
+    if(other_value->equals == enum_value_equals)
     {
-	return ESSTEE_TRUE;
+	const struct enum_value_t *oev =
+	    CONTAINER_OF(other_value, struct enum_value_t, value);
+
+	other_ordinal = oev->ordinal;
+    }
+    else
+    {
+	const struct enum_item_t *other_value_enum =
+	    other_value->enumeration(other_value,
+				     config,
+				     issues);
+
+	other_ordinal = enum_group_ordinal_of(ev->group, other_value_enum);
     }
 
-    return ESSTEE_FALSE;
+    return (ev->ordinal == other_ordinal) ? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
 static const struct enum_item_t * enum_value_enumeration(
@@ -265,7 +362,7 @@ static const struct enum_item_t * enum_value_enumeration(
     struct enum_value_t *ev =
 	CONTAINER_OF(self, struct enum_value_t, value);
 
-    return ev->constant;
+    return ev->group->items_by_ordinal[ev->ordinal];
 }
 
 static int enum_value_override_type(
@@ -283,6 +380,109 @@ static int enum_value_override_type(
     return ESSTEE_OK;
 }
 
+/**************************************************************************/
+/* Literal value interface                                                */
+/**************************************************************************/
+struct enum_literal_t {
+    struct value_iface_t value;
+    struct enum_item_t item;
+};
+
+static int enum_literal_display(
+    const struct value_iface_t *self,
+    char *buffer,
+    size_t buffer_size,
+    const struct config_iface_t *config)
+{
+    struct enum_literal_t *el =
+	CONTAINER_OF(self, struct enum_literal_t, value);
+
+    int written_bytes = snprintf(buffer,
+				 buffer_size,
+				 "%s",
+				 el->item.identifier);
+
+    CHECK_WRITTEN_BYTES(written_bytes);
+
+    return written_bytes;
+}
+
+static int enum_literal_comparable_to(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(!other_value->enumeration)
+    {
+	issues->new_issue(
+	    issues,
+	    "the other value cannot be interpreted as an enumerated value",
+	    ESSTEE_TYPE_ERROR);
+
+	return ESSTEE_FALSE;
+    }
+
+    return ESSTEE_TRUE;
+}
+
+static int enum_literal_equals(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(other_value->equals == enum_value_equals)
+    {
+	return enum_value_equals(other_value, self, config, issues);
+    }
+
+    struct enum_literal_t *el =
+	CONTAINER_OF(self, struct enum_literal_t, value);
+
+    const struct enum_item_t *other_value_enum =
+	other_value->enumeration(other_value, config, issues);
+
+    if(other_value_enum->group)
+    {
+	const struct enum_group_t *eg =
+	    CONTAINER_OF(other_value_enum->group, struct enum_group_t, group);
+
+	int ordinal = enum_group_ordinal_of(eg, &(el->item));
+
+	return (ordinal == other_value_enum->ordinal) ? ESSTEE_TRUE : ESSTEE_FALSE;
+    }
+
+    if(strcmp(el->item.identifier, other_value_enum->identifier) == 0)
+    {
+	return ESSTEE_TRUE;
+    }
+
+    return ESSTEE_FALSE;
+}
+
+static const struct enum_item_t * enum_literal_enumeration(
+    const struct value_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct enum_literal_t *el =
+	CONTAINER_OF(self, struct enum_literal_t, value);
+
+    return &(el->item);
+}
+
+static void enum_literal_destroy(
+    struct value_iface_t *self)
+{
+    struct enum_literal_t *el =
+	CONTAINER_OF(self, struct enum_literal_t, value);
+
+    free((char *)el->item.identifier);
+    free((struct st_location_t *)el->item.location);
+    free(el);
+}
+
 /**************************************************************************/
 /* Type interface                                                         */
 /**************************************************************************/
@@ -309,7 +509,8 @@ static struct value_iface_t * enum_type_create_value_of(
 	CONTAINER_OF(self, struct enum_type_t, type);
 
     ev->type = self;
-    ev->constant = &(et->default_item->item);
+    ev->group = et->values;
+    ev->ordinal = et->default_item->item.ordinal;
 
     memset(&(ev->value), 0, sizeof(struct value_iface_t));
 
@@ -319,6 +520,8 @@ static struct value_iface_t * enum_type_create_value_of(
     ev->value.assignable_from = enum_value_assigns_and_compares;
     ev->value.comparable_to = enum_value_assigns_and_compares;
     ev->value.destroy = enum_value_destroy;
+    ev->value.checkpoint = enum_value_checkpoint;
+    ev->value.restore = enum_value_restore;
     ev->value.equals = enum_value_equals;
     ev->value.enumeration = enum_value_enumeration;
     ev->value.class = st_general_value_empty_class;
@@ -342,7 +545,7 @@ static int enum_type_reset_value_of(
     struct enum_value_t *ev =
 	CONTAINER_OF(value_of, struct enum_value_t, value);
 
-    ev->constant = &(et->default_item->item);
+    ev->ordinal = et->default_item->item.ordinal;
 
     return ESSTEE_OK;
 }
@@ -498,6 +701,25 @@ struct type_iface_t * st_create_enum_type(
 	}
     }     
 
+    if(!eg->items_by_ordinal)
+    {
+	const struct enum_item_t **items_by_ordinal = NULL;
+	ALLOC_ARRAY_OR_ERROR_JUMP(
+	    items_by_ordinal,
+	    const struct enum_item_t *,
+	    eg->items_count,
+	    issues,
+	    error_free_resources);
+
+	struct enum_group_item_t *itr = NULL;
+	for(itr = eg->items; itr != NULL; itr = itr->hh.next)
+	{
+	    items_by_ordinal[itr->item.ordinal] = &(itr->item);
+	}
+
+	eg->items_by_ordinal = items_by_ordinal;
+    }
+
     et->default_item = default_value;
     et->values = eg;
 
@@ -525,7 +747,53 @@ struct value_iface_t * st_create_enum_value(
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
-    return enum_type_create_value_of(NULL,
-				     config,
-				     issues);
+    struct enum_literal_t *el = NULL;
+    struct st_location_t *el_location = NULL;
+
+    ALLOC_OR_ERROR_JUMP(
+	el,
+	struct enum_literal_t,
+	issues,
+	error_free_resources);
+
+    LOCDUP_OR_ERROR_JUMP(
+	el_location,
+	location,
+	issues,
+	error_free_resources);
+
+    el->item.identifier = identifier;
+    el->item.location = el_location;
+    el->item.group = NULL;
+    el->item.ordinal = -1;
+    el->item.resolved_in = NULL;
+
+    memset(&(el->value), 0, sizeof(struct value_iface_t));
+    el->value.display = enum_literal_display;
+    el->value.comparable_to = enum_literal_comparable_to;
+    el->value.equals = enum_literal_equals;
+    el->value.enumeration = enum_literal_enumeration;
+    el->value.destroy = enum_literal_destroy;
+
+    return &(el->value);
+
+error_free_resources:
+    free(el);
+    free(el_location);
+    return NULL;
+}
+
+int st_enum_item_ordinal(
+    const struct enum_item_t *item,
+    const struct enum_item_t *reference)
+{
+    if(!reference->group)
+    {
+	return -1;
+    }
+
+    const struct enum_group_t *eg =
+	CONTAINER_OF(reference->group, struct enum_group_t, group);
+
+    return enum_group_ordinal_of(eg, item);
 }
@@ -21,9 +21,19 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <elements/itype.h>
 
+struct enum_group_iface_t;
+
+/* An enumerated value as defined by an enumerated type, or as written
+ * as a literal. Items of a type have the group of the type and their
+ * position within it as ordinal. A literal has no group, its ordinal is
+ * resolved against the group of the value it is first used with, and
+ * is resolved again only if used with a value of another group. */
 struct enum_item_t {
     const char *identifier;
     const struct st_location_t *location;
+    const struct enum_group_iface_t *group;
+    int ordinal;
+    const struct enum_group_iface_t *resolved_in;
 };
 
 struct enum_group_iface_t {
@@ -50,8 +60,16 @@ struct type_iface_t * st_create_enum_type(
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
 
+/* Creates an enum literal, which owns the identifier once created */
 struct value_iface_t * st_create_enum_value(
     char *identifier,
     const struct st_location_t *location,
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
+
+/* Gives the ordinal of item within the group of the item reference,
+ * which is defined by an enumerated type, or -1 if item is not part
+ * of that group */
+int st_enum_item_ordinal(
+    const struct enum_item_t *item,
+    const struct enum_item_t *reference);
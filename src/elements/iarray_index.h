@@ -25,6 +25,8 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <rt/isystime.h>
 #include <rt/cursor.h>
 
+struct loop_invariants_t;
+
 struct array_index_element_t {
     const struct expression_iface_t *expression;
     const struct array_index_element_t *next;
@@ -61,6 +63,13 @@ struct array_index_iface_t {
 
     int (*constant_reference)(
     	struct array_index_iface_t *self);
+
+    /* Gives ESSTEE_TRUE when all index expressions are invariant in
+     * the loop, otherwise hoists the ones that are */
+    int (*invariant)(
+	struct array_index_iface_t *self,
+	struct loop_invariants_t *invariants,
+	struct issues_iface_t *issues);
 	
     void (*destroy)(
 	struct array_index_iface_t *self);
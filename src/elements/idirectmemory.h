@@ -31,6 +31,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <util/iconfig.h>
 #include <util/bitflag.h>
 #include <util/iissues.h>
+#include <util/icheckpoint.h>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -54,6 +55,14 @@ struct dmem_iface_t {
     int (*reset)(
 	struct dmem_iface_t *self);
 
+    int (*checkpoint)(
+	const struct dmem_iface_t *self,
+	struct checkpoint_iface_t *checkpoint);
+
+    int (*restore)(
+	struct dmem_iface_t *self,
+	struct checkpoint_iface_t *checkpoint);
+
     void (*destroy)(
 	struct dmem_iface_t *self);    
 };
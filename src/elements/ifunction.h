@@ -65,6 +65,23 @@ struct function_iface_t {
     const struct value_iface_t * (*result_value)(
 	struct function_iface_t *self);
 
+    /* Set by functions with one variant per argument type, gives the
+     * variant to invoke with the given parameters */
+    struct function_iface_t * (*overload)(
+	struct function_iface_t *self,
+	const struct invoke_parameters_iface_t *parameters,
+	struct issues_iface_t *issues);
+
+    /* Set by functions that can be computed from the value of a single
+     * argument in place of an invocation, into a result value owned by
+     * the caller */
+    int (*intrinsic)(
+	struct function_iface_t *self,
+	struct value_iface_t *result,
+	const struct value_iface_t *argument,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
+
     void (*destroy)(
 	struct function_iface_t *self);
 
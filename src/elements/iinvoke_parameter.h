@@ -25,6 +25,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <rt/icursor.h>
 
 struct invoke_parameter_t;
+struct expression_iface_t;
 
 struct invoke_parameters_iface_t {
 
@@ -66,6 +67,20 @@ struct invoke_parameters_iface_t {
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
+    /* Gives the value of the parameter with the given identifier, or
+     * of the unnamed parameter at the given position, NULL if there
+     * is no such parameter */
+    const struct value_iface_t * (*value_of)(
+	const struct invoke_parameters_iface_t *self,
+	const char *identifier,
+	size_t position);
+
+    /* As value_of, but gives the expression of the parameter */
+    struct expression_iface_t * (*expression_of)(
+	const struct invoke_parameters_iface_t *self,
+	const char *identifier,
+	size_t position);
+
     void (*destroy)(
 	struct invoke_parameters_iface_t *self);
 
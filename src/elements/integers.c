@@ -20,6 +20,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/integers.h>
 #include <elements/types.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 
 #include <utlist.h>
 #include <stdio.h>
@@ -230,6 +231,28 @@ static void integer_value_destroy(
     /* TODO: integer value destroy */
 }
 
+static int integer_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct integer_value_t *v =
+	CONTAINER_OF(self, struct integer_value_t, value);
+
+    return checkpoint->write(checkpoint, &(v->num), sizeof(v->num));
+}
+
+static int integer_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct integer_value_t *v =
+	CONTAINER_OF(self, struct integer_value_t, value);
+
+    return checkpoint->read(checkpoint, &(v->num), sizeof(v->num));
+}
+
 static int integer_value_greater(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
@@ -662,6 +685,7 @@ static struct value_iface_t * integer_type_create_value_of(
 	error_free_resources);
     
     iv->type = self;
+    iv->class = 0;
     memset(&(iv->value), 0, sizeof(struct value_iface_t));
     
     iv->value.display = integer_value_display;
@@ -672,6 +696,8 @@ static struct value_iface_t * integer_type_create_value_of(
     iv->value.operates_with = integer_value_compares_and_operates;
     iv->value.create_temp_from = integer_value_create_temp_from;
     iv->value.destroy = integer_value_destroy;
+    iv->value.checkpoint = integer_value_checkpoint;
+    iv->value.restore = integer_value_restore;
     iv->value.class = integer_value_class;
     iv->value.override_type = integer_value_override_type;
 
@@ -990,6 +1016,7 @@ static struct value_iface_t * bool_type_create_value_of(
 	error_free_resources);
     
     iv->type = self;
+    iv->class = 0;
     memset(&(iv->value), 0, sizeof(struct value_iface_t));
     
     iv->value.display = bool_value_display;
@@ -1000,6 +1027,8 @@ static struct value_iface_t * bool_type_create_value_of(
     iv->value.operates_with = bool_value_assigns_compares_operates; 
     iv->value.create_temp_from = bool_value_create_temp_from;
     iv->value.destroy = integer_value_destroy;
+    iv->value.checkpoint = integer_value_checkpoint;
+    iv->value.restore = integer_value_restore;
     iv->value.class = integer_value_class;
     iv->value.override_type = integer_value_override_type;
 
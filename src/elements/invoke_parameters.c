@@ -443,6 +443,52 @@ int invoke_parameters_assign_from(
     return ESSTEE_OK;   
 }
 
+static struct expression_iface_t * invoke_parameters_expression_of(
+    const struct invoke_parameters_iface_t *self,
+    const char *identifier,
+    size_t position)
+{
+    const struct invoke_parameters_t *params =
+	CONTAINER_OF(self, struct invoke_parameters_t, params);
+
+    const struct invoke_parameter_t *itr = NULL;
+    size_t parameter_position = 0;
+    DL_FOREACH(params->list, itr)
+    {
+	if(itr->identifier)
+	{
+	    if(identifier && strcmp(itr->identifier, identifier) == 0)
+	    {
+		return itr->expression;
+	    }
+	}
+	else if(parameter_position == position)
+	{
+	    return itr->expression;
+	}
+
+	parameter_position++;
+    }
+
+    return NULL;
+}
+
+static const struct value_iface_t * invoke_parameters_value_of(
+    const struct invoke_parameters_iface_t *self,
+    const char *identifier,
+    size_t position)
+{
+    const struct expression_iface_t *expression =
+	invoke_parameters_expression_of(self, identifier, position);
+
+    if(!expression)
+    {
+	return NULL;
+    }
+
+    return expression->return_value(expression);
+}
+
 /**************************************************************************/
 /* Public interface                                                       */
 /**************************************************************************/
@@ -470,6 +516,8 @@ struct invoke_parameters_iface_t * st_create_invoke_parameters(
     params->params.allocate = invoke_parameters_allocate;
     params->params.clone = invoke_parameters_clone;
     params->params.assign_from = invoke_parameters_assign_from;
+    params->params.value_of = invoke_parameters_value_of;
+    params->params.expression_of = invoke_parameters_expression_of;
     params->params.destroy = invoke_parameters_destroy;
 
     return &(params->params);
@@ -25,6 +25,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <util/iissues.h>
 #include <rt/icursor.h>
 #include <rt/isystime.h>
+#include <util/icheckpoint.h>
 
 struct program_iface_t {
 
@@ -59,6 +60,20 @@ struct program_iface_t {
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
+    /* The variables declared by the program, as a list */
+    struct variable_iface_t * (*variables)(
+	struct program_iface_t *self);
+
+    int (*checkpoint)(
+	const struct program_iface_t *self,
+	struct checkpoint_iface_t *checkpoint,
+	struct issues_iface_t *issues);
+
+    int (*restore)(
+	struct program_iface_t *self,
+	struct checkpoint_iface_t *checkpoint,
+	struct issues_iface_t *issues);
+
     int (*display)(
 	struct program_iface_t *self,
 	char *buffer,
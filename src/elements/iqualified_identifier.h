@@ -26,6 +26,8 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <rt/isystime.h>
 #include <rt/icursor.h>
 
+struct loop_invariants_t;
+
 struct qualified_identifier_iface_t {
 
     int (*extend_by_index)(
@@ -85,6 +87,16 @@ struct qualified_identifier_iface_t {
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
+    const struct variable_iface_t * (*base_variable)(
+    	const struct qualified_identifier_iface_t *self);
+
+    /* Loop invariance, gives ESSTEE_TRUE when the index expressions
+     * of the path are invariant, otherwise hoists the ones that are */
+    int (*invariant_indices)(
+    	struct qualified_identifier_iface_t *self,
+	struct loop_invariants_t *invariants,
+	struct issues_iface_t *issues);
+
     /* Target invoke */
     int (*target_invoke_verify)(
     	const struct qualified_identifier_iface_t *self,
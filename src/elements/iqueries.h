@@ -25,6 +25,8 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <util/inamed_ref_pool.h>
 #include <util/iconfig.h>
 #include <util/iissues.h>
+#include <rt/icursor.h>
+#include <rt/isystime.h>
 
 struct query_t;
 
@@ -57,6 +59,15 @@ struct queries_iface_t {
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
+    /* Steps the condition queries on the given cursor, and gives
+     * ESSTEE_TRUE if all of them are true */
+    int (*test)(
+	struct queries_iface_t *self,
+	struct cursor_iface_t *cursor,
+	struct systime_iface_t *systime,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
+
     int (*display)(
 	struct queries_iface_t *self,
 	char *output,
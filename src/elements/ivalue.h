@@ -32,12 +32,10 @@ struct variable_iface_t;
 struct enum_item_t;
 struct cursor_iface_t;
 struct invoke_parameters_iface_t;
-struct duration_t;
-struct date_t;
-struct tod_t;
 struct array_initializer_iface_t;
 struct struct_initializer_iface_t;
 struct type_iface_t;
+struct checkpoint_iface_t;
 
 #define TEMPORARY_VALUE (1 << 0)
 #define CONSTANT_VALUE  (1 << 1)
@@ -146,6 +144,19 @@ struct value_iface_t {
     void (*destroy)(
 	struct value_iface_t *self);
 
+    /* Runtime state checkpointing (st_checkpoint, st_restore). The
+     * state may refer to immutable data of the instance, so it can
+     * only be restored into the instance it was taken from. */
+    int (*checkpoint)(
+	const struct value_iface_t *self,
+	struct checkpoint_iface_t *checkpoint,
+	struct issues_iface_t *issues);
+
+    int (*restore)(
+	struct value_iface_t *self,
+	struct checkpoint_iface_t *checkpoint,
+	struct issues_iface_t *issues);
+
     int (*invoke_verify)(
 	const struct value_iface_t *self,
 	const struct invoke_parameters_iface_t *parameters,
@@ -295,22 +306,24 @@ struct value_iface_t {
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
-    const struct duration_t * (*duration)(
+    /* Durations and times of day are given in nanoseconds, dates and
+     * dates with time of day in microseconds since 1970-01-01 */
+    int64_t (*duration)(
 	const struct value_iface_t *self,
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
     
-    const struct date_t * (*date)(
+    int64_t (*date)(
 	const struct value_iface_t *self,
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
-    const struct tod_t * (*tod)(
+    int64_t (*tod)(
 	const struct value_iface_t *self,
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
-    const struct date_tod_t * (*date_tod)(
+    int64_t (*date_tod)(
 	const struct value_iface_t *self,
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
@@ -33,6 +33,17 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #define GLOBAL_VAR_CLASS		(1 << 5)
 #define RETAIN_VAR_CLASS		(1 << 6)
 #define CONSTANT_VAR_CLASS		(1 << 7)
+#define DIRECT_VAR_CLASS		(1 << 8)
+
+/* The watches of a variable are called on each modification of it,
+ * given the value written, the whole value or an element of it */
+struct variable_watch_t {
+    void (*modified)(
+	struct variable_watch_t *self,
+	const struct value_iface_t *written);
+    
+    struct variable_watch_t *next;
+};
 
 struct variable_iface_t {
 
@@ -193,6 +204,30 @@ struct variable_iface_t {
     const struct type_iface_t * (*type)(
     	const struct variable_iface_t *self);	
 
+    /* Runtime state checkpointing, not set for external variables */
+    int (*checkpoint)(
+	const struct variable_iface_t *self,
+	struct checkpoint_iface_t *checkpoint,
+	struct issues_iface_t *issues);
+
+    int (*restore)(
+	struct variable_iface_t *self,
+	struct checkpoint_iface_t *checkpoint,
+	struct issues_iface_t *issues);
+
+    /* Watches are kept in the variable, external variables forward
+     * to their alias */
+    struct variable_watch_t * (*watched_by)(
+	const struct variable_iface_t *self);
+
+    void (*add_watch)(
+	struct variable_iface_t *self,
+	struct variable_watch_t *watch);
+
+    void (*remove_watch)(
+	struct variable_iface_t *self,
+	struct variable_watch_t *watch);
+    
     /* Destructor */
     void (*destroy)(
 	struct variable_iface_t *self);
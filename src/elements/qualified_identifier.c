@@ -19,6 +19,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <elements/qualified_identifier.h>
 #include <elements/ivariable.h>
+#include <elements/array.h>
 #include <util/macros.h>
 
 #include <utlist.h>
@@ -43,6 +44,8 @@ struct qualified_identifier_t {
     int explicit_base;
     struct qualified_part_t *invoke_state_part;
     int constant_reference;
+    struct array_index_iface_t *prototype_index;
+    const struct config_iface_t *config;
     struct st_location_t location;
 };
 
@@ -93,6 +96,7 @@ static int qualified_identifier_base_resolved(
 /**************************************************************************/
 static int qualified_identifier_resolve_chain(
     struct qualified_identifier_t *qi,
+    int prototype,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
@@ -103,13 +107,19 @@ static int qualified_identifier_resolve_chain(
     {
 	if(itr->index != NULL)
 	{
+	    /* Until the index expressions have been evaluated, the
+	     * chain is resolved through the first element of each
+	     * array, giving a target of the right type */
+	    const struct array_index_iface_t *index =
+		(prototype == ESSTEE_TRUE) ? qi->prototype_index : itr->index;
+	    
 	    if(itr->next)
 	    {
 		ig = issues->open_group(issues);
 		
 		struct variable_iface_t *subvar = itr->variable->sub_variable(
 		    itr->variable,
-		    itr->index,
+		    index,
 		    itr->next->identifier,
 		    config,
 		    issues);
@@ -140,7 +150,7 @@ static int qualified_identifier_resolve_chain(
 
 		const struct value_iface_t *index_value = itr->variable->index_value(
 		    itr->variable,
-		    itr->index,
+		    index,
 		    config,
 		    issues);
 
@@ -355,6 +365,7 @@ static int qualified_identifier_verify(
     if(qi->constant_reference == ESSTEE_TRUE)
     {
 	int resolve_result = qualified_identifier_resolve_chain(qi,
+								ESSTEE_FALSE,
 								config,
 								issues);
 	return resolve_result;
@@ -396,6 +407,7 @@ static int qualified_identifier_step(
 	}
 
 	int resolve_result = qualified_identifier_resolve_chain(qi,
+								ESSTEE_FALSE,
 								config,
 								issues);
 	if(resolve_result != ESSTEE_OK)
@@ -456,6 +468,18 @@ static int qualified_identifier_allocate(
 	    }
 	}
     }
+
+    /* Expressions using the target allocate their temporaries
+     * before verification, and references using non constant
+     * indices are not resolved until stepped, so give them a target
+     * of the right type already now */
+    if(qi->path && qi->path->variable)
+    {
+	return qualified_identifier_resolve_chain(qi,
+						  ESSTEE_TRUE,
+						  qi->config,
+						  issues);
+    }
     
     return ESSTEE_OK;
 }
@@ -561,6 +585,48 @@ static const char * qualified_identifier_base_identifier(
     return qi->path->identifier;
 }
 
+static const struct variable_iface_t * qualified_identifier_base_variable(
+    const struct qualified_identifier_iface_t *self)
+{
+    const struct qualified_identifier_t *qi =
+	CONTAINER_OF(self, struct qualified_identifier_t, qid);
+
+    return qi->path->variable;
+}
+
+static int qualified_identifier_invariant_indices(
+    struct qualified_identifier_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct qualified_identifier_t *qi =
+	CONTAINER_OF(self, struct qualified_identifier_t, qid);
+
+    int invariant = ESSTEE_TRUE;
+    struct qualified_part_t *itr = NULL;
+    DL_FOREACH(qi->path, itr)
+    {
+	if(!itr->index)
+	{
+	    continue;
+	}
+
+	int index_invariant = itr->index->invariant(itr->index,
+						    invariants,
+						    issues);
+	if(index_invariant == ESSTEE_ERROR)
+	{
+	    return ESSTEE_ERROR;
+	}
+	else if(index_invariant != ESSTEE_TRUE)
+	{
+	    invariant = ESSTEE_FALSE;
+	}
+    }
+
+    return invariant;
+}
+
 /* Target invoke */
 static int qualified_identifier_target_invoke_verify(
     const struct qualified_identifier_iface_t *self,
@@ -854,10 +920,21 @@ struct qualified_identifier_iface_t * st_create_qualified_identifier(
 	error_free_resources);
 
     qi->path = NULL;
+    qi->target_variable = NULL;
+    qi->target_index = NULL;
+    qi->target = NULL;
     qi->target_name = NULL;
+    qi->invoke_state_part = NULL;
     qi->explicit_base = ESSTEE_FALSE;
     qi->constant_reference = ESSTEE_TRUE;
     qi->base_context = variable_context;
+    qi->config = config;
+
+    qi->prototype_index = st_create_array_index(config, issues);
+    if(!qi->prototype_index)
+    {
+	goto error_free_resources;
+    }
 
     memset(&(qi->location), 0, sizeof(struct st_location_t));
     
@@ -877,6 +954,8 @@ struct qualified_identifier_iface_t * st_create_qualified_identifier(
 
     qi->qid.set_base = qualified_identifier_set_base;
     qi->qid.base_identifier = qualified_identifier_base_identifier;
+    qi->qid.base_variable = qualified_identifier_base_variable;
+    qi->qid.invariant_indices = qualified_identifier_invariant_indices;
 
     qi->qid.target_invoke_verify = qualified_identifier_target_invoke_verify;
     qi->qid.target_invoke_step = qualified_identifier_target_invoke_step;
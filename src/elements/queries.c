@@ -35,6 +35,7 @@ struct query_t {
     struct variable_iface_t *variable;
     struct qualified_identifier_iface_t *qid;
     struct expression_iface_t *assignment;
+    struct expression_iface_t *condition;
     
     struct query_t *prev;
     struct query_t *next;
@@ -153,6 +154,49 @@ static int queries_link(
 		return verify_result;
 	    }
 	}
+
+	if(qitr->condition)
+	{
+	    if(qitr->condition->invoke.allocate)
+	    {
+		int allocate_result = qitr->condition->invoke.allocate(
+		    &(qitr->condition->invoke),
+		    issues);
+
+		if(allocate_result != ESSTEE_OK)
+		{
+		    return allocate_result;
+		}
+	    }
+
+	    if(qitr->condition->invoke.verify)
+	    {
+		int verify_result = qitr->condition->invoke.verify(
+		    &(qitr->condition->invoke),
+		    config,
+		    issues);
+
+		if(verify_result != ESSTEE_OK)
+		{
+		    return verify_result;
+		}
+	    }
+
+	    const struct value_iface_t *condition_value =
+		qitr->condition->return_value(qitr->condition);
+
+	    if(!condition_value->bool)
+	    {
+		issues->new_issue_at(
+		    issues,
+		    "condition must be boolean",
+		    ESSTEE_TYPE_ERROR,
+		    1,
+		    qitr->condition->invoke.location);
+
+		return ESSTEE_ERROR;
+	    }
+	}
     }
 
     
@@ -200,6 +244,19 @@ static int queries_evaluate(
 	    }
 	}
 
+	/* Conditions depending on the runtime state are only tested */
+	if(itr->condition && itr->condition->invoke.step)
+	{
+	    issues->new_issue_at(
+		issues,
+		"query condition must be compile time constant",
+		ESSTEE_CONTEXT_ERROR,
+		1,
+		itr->condition->invoke.location);
+		
+	    return ESSTEE_ERROR;
+	}
+
 	if(itr->assignment)
 	{
 	    if(itr->assignment->invoke.step)
@@ -279,6 +336,49 @@ static int queries_evaluate(
     return ESSTEE_OK;
 }
 
+static int queries_test(
+    struct queries_iface_t *self,
+    struct cursor_iface_t *cursor,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct queries_t *query_list =
+	CONTAINER_OF(self, struct queries_t, queries);
+
+    struct query_t *itr = NULL;
+    DL_FOREACH(query_list->entries, itr)
+    {
+	if(!itr->condition)
+	{
+	    continue;
+	}
+
+	if(itr->condition->invoke.step)
+	{
+	    int switch_result = cursor->switch_cycle_start(cursor,
+							   &(itr->condition->invoke),
+							   config,
+							   issues);
+	    if(switch_result != ESSTEE_OK
+	       || !cursor->step(cursor, systime, config, issues))
+	    {
+		return ESSTEE_ERROR;
+	    }
+	}
+
+	const struct value_iface_t *condition_value =
+	    itr->condition->return_value(itr->condition);
+
+	if(condition_value->bool(condition_value, config, issues) != ESSTEE_TRUE)
+	{
+	    return ESSTEE_FALSE;
+	}
+    }
+
+    return ESSTEE_TRUE;
+}
+
 static int queries_display(
     struct queries_iface_t *self,
     char *output,
@@ -318,7 +418,18 @@ static int queries_display(
 	}
 
 	int query_written_bytes = 0;
-	if(!itr->variable && !itr->qid)
+	if(itr->condition)
+	{
+	    const struct value_iface_t *condition_value =
+		itr->condition->return_value(itr->condition);
+
+	    query_written_bytes = condition_value->display(
+		condition_value,
+		output+written_bytes,
+		output_max_len-written_bytes,
+		config);
+	}
+	else if(!itr->variable && !itr->qid)
 	{
 	    query_written_bytes = itr->program->display(itr->program,
 							output+written_bytes,
@@ -518,6 +629,7 @@ struct query_t * st_create_program_query(
     query->variable = NULL;
     query->qid = NULL;
     query->assignment = NULL;
+    query->condition = NULL;
     
     int ref_result = program_refs->add(program_refs,
 				       prgm_identifier,
@@ -563,6 +675,7 @@ struct query_t * st_create_identifier_query(
     query->variable = NULL;
     query->qid = NULL;
     query->assignment = assigned;
+    query->condition = NULL;
     
     if(prgm_identifier)
     {
@@ -623,6 +736,7 @@ struct query_t * st_create_qualified_identifier_query(
     query->variable = NULL;
     query->qid = qid;
     query->assignment = assigned;
+    query->condition = NULL;
     
     if(prgm_identifier)
     {
@@ -646,6 +760,33 @@ error_free_resources:
     return NULL;
 }
 
+struct query_t * st_create_condition_query(
+    struct expression_iface_t *condition,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct query_t *query = NULL;
+
+    ALLOC_OR_ERROR_JUMP(
+	query,
+	struct query_t,
+	issues,
+	error_free_resources);
+
+    query->program_identifier = NULL;
+    query->identifier = NULL;
+    query->program = NULL;
+    query->variable = NULL;
+    query->qid = NULL;
+    query->assignment = NULL;
+    query->condition = condition;
+
+    return query;
+    
+error_free_resources:
+    return NULL;
+}
+
 void st_destroy_query(
     struct query_t *query)
 {
@@ -673,6 +814,7 @@ struct queries_iface_t * st_create_queries(
     query_list->queries.finish = queries_finish;
     query_list->queries.link = queries_link;
     query_list->queries.evaluate = queries_evaluate;
+    query_list->queries.test = queries_test;
     query_list->queries.display = queries_display;
     query_list->queries.destroy = queries_destroy;
     
@@ -51,6 +51,12 @@ struct query_t * st_create_qualified_identifier_query(
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
 
+/* A condition is tested instead of evaluated, see queries_iface_t */
+struct query_t * st_create_condition_query(
+    struct expression_iface_t *condition,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues);
+
 void st_destroy_query(
     struct query_t *query);
 
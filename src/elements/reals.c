@@ -20,6 +20,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/reals.h>
 #include <elements/types.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 
 #include <utlist.h>
 #include <stdio.h>
@@ -161,7 +162,7 @@ static int real_value_compares_and_operates(
     
     if(!ST_FLAG_IS_SET(other_value_class, TEMPORARY_VALUE))
     {
-	if(other_value->type_of)
+	if(other_value->type_of && rv->type)
 	{
 	    const struct type_iface_t *other_value_type =
 		other_value->type_of(other_value);
@@ -223,6 +224,28 @@ static void real_value_destroy(
     /* TODO: real value destroy */
 }
 
+static int real_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct real_value_t *v =
+	CONTAINER_OF(self, struct real_value_t, value);
+
+    return checkpoint->write(checkpoint, &(v->num), sizeof(v->num));
+}
+
+static int real_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct real_value_t *v =
+	CONTAINER_OF(self, struct real_value_t, value);
+
+    return checkpoint->read(checkpoint, &(v->num), sizeof(v->num));
+}
+
 static int real_value_greater(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
@@ -431,6 +454,7 @@ static struct value_iface_t * real_type_create_value_of(
 	error_free_resources);
 
     rv->type = self;
+    rv->class = 0;
     memset(&(rv->value), 0, sizeof(struct value_iface_t));
 
     rv->value.display = real_value_display;
@@ -441,6 +465,8 @@ static struct value_iface_t * real_type_create_value_of(
     rv->value.operates_with = real_value_compares_and_operates;
     rv->value.create_temp_from = real_value_create_temp_from;
     rv->value.destroy = real_value_destroy;
+    rv->value.checkpoint = real_value_checkpoint;
+    rv->value.restore = real_value_restore;
     rv->value.class = real_value_class;
     rv->value.override_type = real_value_override_type;
 
@@ -602,3 +628,15 @@ struct value_iface_t * st_new_typeless_real_value(
 
     return v;
 }
+
+int st_real_value_set(
+    struct value_iface_t *value,
+    double num)
+{
+    struct real_value_t *rv =
+	CONTAINER_OF(value, struct real_value_t, value);
+
+    rv->num = num;
+
+    return ESSTEE_OK;
+}
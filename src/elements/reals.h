@@ -28,3 +28,7 @@ struct value_iface_t * st_new_typeless_real_value(
     st_bitflag_t value_class,
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
+
+int st_real_value_set(
+    struct value_iface_t *value,
+    double num);
@@ -21,11 +21,221 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/values.h>
 #include <elements/types.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 
 #include <utlist.h>
 #include <stdio.h>
 #include <string.h>
 
+/* Capacity of strings declared without a length */
+#define STRING_DEFAULT_CAPACITY 254
+
+/* Most bytes a UTF-8 encoded WSTRING character takes */
+#define WSTRING_CHARACTER_SIZE 4
+
+/**************************************************************************/
+/* Literal decoding and display                                           */
+/**************************************************************************/
+static int hex_digit_value(
+    char c)
+{
+    if(c >= '0' && c <= '9')
+    {
+	return c - '0';
+    }
+    else if(c >= 'a' && c <= 'f')
+    {
+	return c - 'a' + 10;
+    }
+    else if(c >= 'A' && c <= 'F')
+    {
+	return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+/* Decodes a quoted literal in place, removing the delimiters and
+ * resolving '$' escapes. Double byte characters given as $hhhh are
+ * stored UTF-8 encoded. Returns the length of the decoded text. */
+static size_t decode_string_literal(
+    char *content,
+    st_bitflag_t class)
+{
+    size_t content_length = strlen(content);
+    if(content_length < 2)
+    {
+	content[0] = '\0';
+	return 0;
+    }
+
+    const char *source = content + 1;
+    const char *source_end = content + content_length - 1;
+    char *target = content;
+    int hex_digits = (class == WSTRING_TYPE) ? 4 : 2;
+
+    while(source < source_end)
+    {
+	if(*source != '$' || source + 1 >= source_end)
+	{
+	    *target++ = *source++;
+	    continue;
+	}
+
+	char escaped = source[1];
+	switch(escaped)
+	{
+	case 'l':
+	case 'L':
+	case 'n':
+	case 'N':
+	    *target++ = '\n';
+	    source += 2;
+	    continue;
+
+	case 'p':
+	case 'P':
+	    *target++ = '\f';
+	    source += 2;
+	    continue;
+
+	case 'r':
+	case 'R':
+	    *target++ = '\r';
+	    source += 2;
+	    continue;
+
+	case 't':
+	case 'T':
+	    *target++ = '\t';
+	    source += 2;
+	    continue;
+
+	case '$':
+	case '\'':
+	case '"':
+	    *target++ = escaped;
+	    source += 2;
+	    continue;
+	}
+
+	unsigned code = 0;
+	int i;
+	for(i = 1; i <= hex_digits && source + i < source_end; i++)
+	{
+	    int digit = hex_digit_value(source[i]);
+	    if(digit < 0)
+	    {
+		break;
+	    }
+	    code = (code << 4) | (unsigned)digit;
+	}
+
+	if(i <= hex_digits)
+	{
+	    /* Not a valid escape, keep as is */
+	    *target++ = *source++;
+	    continue;
+	}
+
+	if(code < 0x80 || class != WSTRING_TYPE)
+	{
+	    *target++ = (char)code;
+	}
+	else if(code < 0x800)
+	{
+	    *target++ = (char)(0xc0 | (code >> 6));
+	    *target++ = (char)(0x80 | (code & 0x3f));
+	}
+	else
+	{
+	    *target++ = (char)(0xe0 | (code >> 12));
+	    *target++ = (char)(0x80 | ((code >> 6) & 0x3f));
+	    *target++ = (char)(0x80 | (code & 0x3f));
+	}
+	source += 1 + hex_digits;
+    }
+
+    *target = '\0';
+
+    return (size_t)(target - content);
+}
+
+/* Displays text as a literal of the given class, escaping the
+ * delimiter, '$' and control characters */
+static int display_string(
+    char *buffer,
+    size_t buffer_size,
+    const char *text,
+    size_t length,
+    st_bitflag_t class)
+{
+    char quote = (class == WSTRING_TYPE) ? '"' : '\'';
+    size_t written = 0;
+    char escape[8];
+
+    if(buffer_size < 3)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    buffer[written++] = quote;
+
+    for(size_t i = 0; i < length; i++)
+    {
+	unsigned char c = (unsigned char)text[i];
+	const char *part = escape;
+	size_t part_length = 2;
+
+	escape[0] = '$';
+	if(c == '$' || c == (unsigned char)quote)
+	{
+	    escape[1] = (char)c;
+	}
+	else if(c == '\n')
+	{
+	    escape[1] = 'N';
+	}
+	else if(c == '\r')
+	{
+	    escape[1] = 'R';
+	}
+	else if(c == '\t')
+	{
+	    escape[1] = 'T';
+	}
+	else if(c == '\f')
+	{
+	    escape[1] = 'P';
+	}
+	else if(c < 0x20 || c == 0x7f)
+	{
+	    part_length = (size_t)snprintf(escape,
+					   sizeof(escape),
+					   (class == WSTRING_TYPE) ? "$%04X" : "$%02X",
+					   c);
+	}
+	else
+	{
+	    part = &(text[i]);
+	    part_length = 1;
+	}
+
+	if(written + part_length + 2 > buffer_size)
+	{
+	    return ESSTEE_FALSE;
+	}
+
+	memcpy(buffer + written, part, part_length);
+	written += part_length;
+    }
+
+    buffer[written++] = quote;
+    buffer[written] = '\0';
+
+    return (int)written;
+}
+
 /**************************************************************************/
 /* String literals                                                        */
 /**************************************************************************/
@@ -35,6 +245,7 @@ struct literal_string_t {
     struct type_iface_t type;
     struct value_iface_t value;
     char *content;
+    size_t length;
     st_bitflag_t class;
 };
 
@@ -56,12 +267,11 @@ static int literal_string_display(
     const struct literal_string_t *ls =
 	CONTAINER_OF(self, struct literal_string_t, value);
 
-    int written_bytes = snprintf(buffer,
-				 buffer_size,
-				 "%s",
-				 ls->content);
-    CHECK_WRITTEN_BYTES(written_bytes);
-    return written_bytes;
+    return display_string(buffer,
+			  buffer_size,
+			  ls->content,
+			  ls->length,
+			  ls->class);
 }
 
 static int literal_string_compares(
@@ -121,45 +331,240 @@ static void literal_string_destroy(
     /* TODO: literal string destroy */
 }
 
-static int literal_string_equals(
+static const char * literal_string_string(
     const struct value_iface_t *self,
-    const struct value_iface_t *other_value,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
     const struct literal_string_t *ls =
 	CONTAINER_OF(self, struct literal_string_t, value);
 
-    const char *other_string =
-	other_value->string(other_value, config, issues);
+    return ls->content;
+}
+
+/**************************************************************************/
+/* Value interface                                                        */
+/**************************************************************************/
+/* The text is stored inline, after the value, in a buffer of the
+ * capacity given by the type (plus a terminating null). The capacity
+ * counts characters, for a WSTRING the buffer is sized to hold them
+ * UTF-8 encoded. The length counts bytes. */
+struct string_value_t {
+    struct value_iface_t value;
+    const struct type_iface_t *type;
+    int wide;
+    size_t capacity;
+    size_t size;
+    size_t length;
+    char buffer[];
+};
+
+static int utf8_continuation(
+    char c)
+{
+    return ((unsigned char)c & 0xc0) == 0x80;
+}
+
+/* Gives the number of characters in a text, counting code points when
+ * it is UTF-8 encoded */
+static size_t text_characters(
+    const char *text,
+    size_t length,
+    int wide)
+{
+    if(!wide)
+    {
+	return length;
+    }
+
+    size_t characters = 0;
+    for(size_t i = 0; i < length; i++)
+    {
+	if(!utf8_continuation(text[i]))
+	{
+	    characters++;
+	}
+    }
+
+    return characters;
+}
+
+/* Gives the number of bytes from the start of a text that make up at
+ * most the given number of characters and bytes. A UTF-8 encoded text
+ * is only cut at a code point boundary. */
+static size_t text_fitting(
+    const char *text,
+    size_t length,
+    size_t characters,
+    size_t size,
+    int wide)
+{
+    if(!wide)
+    {
+	return (length < characters) ? length : characters;
+    }
+
+    size_t end = 0;
+    size_t count = 0;
+    for(; end < length && end < size; end++)
+    {
+	if(!utf8_continuation(text[end]))
+	{
+	    if(count == characters)
+	    {
+		return end;
+	    }
+	    count++;
+	}
+    }
 
-    if(strcmp(ls->content, other_string) == 0)
+    if(end < length)
     {
-	return ESSTEE_TRUE;
+	while(end > 0 && utf8_continuation(text[end]))
+	{
+	    end--;
+	}
     }
 
-    return ESSTEE_FALSE;
+    return end;
 }
 
-static const char * literal_string_string(
+static const char * string_value_string(
+    const struct value_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct string_value_t *sv =
+	CONTAINER_OF(self, struct string_value_t, value);
+
+    return sv->buffer;
+}
+
+/* Gives the text and length of any string value, without scanning
+ * for the length of literals and string values */
+static const char * string_text(
+    const struct value_iface_t *value,
+    size_t *length,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(value->string == string_value_string)
+    {
+	const struct string_value_t *sv =
+	    CONTAINER_OF(value, struct string_value_t, value);
+
+	*length = sv->length;
+	return sv->buffer;
+    }
+    else if(value->string == literal_string_string)
+    {
+	const struct literal_string_t *ls =
+	    CONTAINER_OF(value, struct literal_string_t, value);
+
+	*length = ls->length;
+	return ls->content;
+    }
+
+    const char *text = value->string(value, config, issues);
+    *length = (text) ? strlen(text) : 0;
+
+    return text;
+}
+
+static int string_equals(
+    const char *text,
+    size_t length,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t other_length = 0;
+    const char *other_text =
+	string_text(other_value, &other_length, config, issues);
+
+    if(!other_text || length != other_length)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    return (memcmp(text, other_text, length) == 0) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+/* Orders texts by their bytes, which for UTF-8 is the order of the
+ * code points, a text before any longer text it starts */
+static int string_order(
+    const char *text,
+    size_t length,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    size_t other_length = 0;
+    const char *other_text =
+	string_text(other_value, &other_length, config, issues);
+
+    size_t common = (length < other_length) ? length : other_length;
+    int order = (common > 0) ? memcmp(text, other_text, common) : 0;
+
+    if(order == 0)
+    {
+	order = (length > other_length) - (length < other_length);
+    }
+
+    return order;
+}
+
+static void string_value_set_text(
+    struct string_value_t *sv,
+    const char *text,
+    size_t length)
+{
+    length = text_fitting(text, length, sv->capacity, sv->size, sv->wide);
+
+    memmove(sv->buffer, text, length);
+    sv->buffer[length] = '\0';
+    sv->length = length;
+}
+
+static int literal_string_equals(
     const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
     const struct literal_string_t *ls =
 	CONTAINER_OF(self, struct literal_string_t, value);
 
-    return ls->content;
+    return string_equals(ls->content, ls->length, other_value, config, issues);
 }
 
-/**************************************************************************/
-/* Value interface                                                        */
-/**************************************************************************/
-struct string_value_t {
-    struct value_iface_t value;
-    const struct type_iface_t *type;
-    const char *str;
-};
+static int literal_string_greater(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct literal_string_t *ls =
+	CONTAINER_OF(self, struct literal_string_t, value);
+
+    int order = string_order(ls->content, ls->length, other_value, config, issues);
+
+    return (order > 0) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+static int literal_string_lesser(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct literal_string_t *ls =
+	CONTAINER_OF(self, struct literal_string_t, value);
+
+    int order = string_order(ls->content, ls->length, other_value, config, issues);
+
+    return (order < 0) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
 
 static int string_value_display(
     const struct value_iface_t *self,
@@ -170,12 +575,14 @@ static int string_value_display(
     const struct string_value_t *sv =
 	CONTAINER_OF(self, struct string_value_t, value);
 
-    int written_bytes = snprintf(buffer,
-				 buffer_size,
-				 "%s",
-				 sv->str);
-    CHECK_WRITTEN_BYTES(written_bytes);
-    return written_bytes;
+    const struct type_iface_t *type = sv->type;
+    st_bitflag_t class = type->class(type) & (STRING_TYPE|WSTRING_TYPE);
+
+    return display_string(buffer,
+			  buffer_size,
+			  sv->buffer,
+			  sv->length,
+			  class);
 }
 
 static int string_value_assign(
@@ -187,7 +594,14 @@ static int string_value_assign(
     struct string_value_t *sv =
 	CONTAINER_OF(self, struct string_value_t, value);
 
-    sv->str = new_value->string(new_value, config, issues);
+    size_t length = 0;
+    const char *text = string_text(new_value, &length, config, issues);
+    if(!text)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    string_value_set_text(sv, text, length);
 
     return ESSTEE_OK;
 }
@@ -219,6 +633,57 @@ static void string_value_destroy(
     /* TODO: string value destroy */
 }
 
+static int string_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct string_value_t *v =
+	CONTAINER_OF(self, struct string_value_t, value);
+
+    int write_result = checkpoint->write(checkpoint,
+					 &(v->length),
+					 sizeof(v->length));
+    if(write_result != ESSTEE_OK)
+    {
+	return write_result;
+    }
+
+    return checkpoint->write(checkpoint, v->buffer, v->length);
+}
+
+static int string_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct string_value_t *v =
+	CONTAINER_OF(self, struct string_value_t, value);
+
+    size_t length = 0;
+    int read_result = checkpoint->read(checkpoint, &length, sizeof(length));
+    if(read_result != ESSTEE_OK)
+    {
+	return read_result;
+    }
+
+    if(length > v->size)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    read_result = checkpoint->read(checkpoint, v->buffer, length);
+    if(read_result != ESSTEE_OK)
+    {
+	return read_result;
+    }
+
+    v->buffer[length] = '\0';
+    v->length = length;
+
+    return ESSTEE_OK;
+}
+
 static int string_value_equals(
     const struct value_iface_t *self,
     const struct value_iface_t *other_value,
@@ -228,26 +693,35 @@ static int string_value_equals(
     struct string_value_t *sv =
 	CONTAINER_OF(self, struct string_value_t, value);
 
-    const char *other_string =
-	other_value->string(other_value, config, issues);
+    return string_equals(sv->buffer, sv->length, other_value, config, issues);
+}
 
-    if(strcmp(sv->str, other_string) == 0)
-    {
-	return ESSTEE_TRUE;
-    }
+static int string_value_greater(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct string_value_t *sv =
+	CONTAINER_OF(self, struct string_value_t, value);
+
+    int order = string_order(sv->buffer, sv->length, other_value, config, issues);
 
-    return ESSTEE_FALSE;
+    return (order > 0) ? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
-static const char * string_value_string(
+static int string_value_lesser(
     const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
     struct string_value_t *sv =
 	CONTAINER_OF(self, struct string_value_t, value);
 
-    return sv->str;
+    int order = string_order(sv->buffer, sv->length, other_value, config, issues);
+
+    return (order < 0) ? ESSTEE_TRUE : ESSTEE_FALSE;
 }
 
 static int string_value_override_type(
@@ -271,23 +745,40 @@ struct string_type_t {
     struct type_iface_t type;
     size_t length;
     st_bitflag_t class;
-    const char *default_value;
 };
 
+static size_t string_type_capacity(
+    const struct string_type_t *st)
+{
+    return (st->length > 0) ? st->length : STRING_DEFAULT_CAPACITY;
+}
+
 static struct value_iface_t * string_type_create_value_of(
     const struct type_iface_t *self,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
-    struct string_value_t *sv = NULL;
+    const struct string_type_t *st =
+	CONTAINER_OF(self, struct string_type_t, type);
 
-    ALLOC_OR_ERROR_JUMP(
-	sv,
-	struct string_value_t,
-	issues,
-	error_free_resources);
+    int wide = (st->class == WSTRING_TYPE);
+    size_t capacity = string_type_capacity(st);
+    size_t size = (wide) ? capacity * WSTRING_CHARACTER_SIZE : capacity;
+    struct string_value_t *sv =
+	(struct string_value_t *)malloc(sizeof(struct string_value_t) + size + 1);
+
+    if(!sv)
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
 
     sv->type = self;
+    sv->wide = wide;
+    sv->capacity = capacity;
+    sv->size = size;
+    sv->length = 0;
+    sv->buffer[0] = '\0';
 
     memset(&(sv->value), 0, sizeof(struct value_iface_t));
 
@@ -298,7 +789,11 @@ static struct value_iface_t * string_type_create_value_of(
     sv->value.class = st_general_value_empty_class;
     sv->value.type_of = string_value_type_of;
     sv->value.destroy = string_value_destroy;
+    sv->value.checkpoint = string_value_checkpoint;
+    sv->value.restore = string_value_restore;
     sv->value.equals = string_value_equals;
+    sv->value.greater = string_value_greater;
+    sv->value.lesser = string_value_lesser;
     sv->value.override_type = string_value_override_type;
     sv->value.string = string_value_string;
 	
@@ -314,13 +809,10 @@ static int string_type_reset_value_of(
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
-    const struct string_type_t *st =
-	CONTAINER_OF(self, struct string_type_t, type);
-
     struct string_value_t *sv =
 	CONTAINER_OF(value_of, struct string_value_t, value);
 
-    sv->str = st->default_value;
+    string_value_set_text(sv, "", 0);
 
     return ESSTEE_OK;
 }
@@ -353,34 +845,38 @@ static int string_type_can_hold(
 	
 	if(st->class != (value_type_class & mask))
 	{
+	    /* Strings with a default value are of an unnamed type */
+	    const char *value_type_name =
+		(value_type_class & WSTRING_TYPE) ? "WSTRING" : "STRING";
+
 	    issues->new_issue(
 		issues,
 		"type '%s' can not be assigned a string of type '%s'",
 		ESSTEE_TYPE_ERROR,
 		self->identifier,
-		value_type->identifier);
+		value_type_name);
 
 	    return ESSTEE_FALSE;
 	}
     }
     
-    if(st->length > 0)
-    {
-	const char *string = value->string(value, config, issues);
-	size_t string_length = strlen(string);
+    size_t capacity = string_type_capacity(st);
+    size_t text_length = 0;
+    const char *text = string_text(value, &text_length, config, issues);
+    size_t string_length =
+	text_characters(text, text_length, st->class == WSTRING_TYPE);
 	
-	if(string_length > st->length)
-	{
-	    issues->new_issue(
-		issues,
-		"type '%s' can at maximum hold strings of length %u, not %u",
-		ESSTEE_TYPE_ERROR,
-		self->identifier,
-		st->length,
-		string_length);
+    if(string_length > capacity)
+    {
+	issues->new_issue(
+	    issues,
+	    "type '%s' can at maximum hold strings of length %u, not %u",
+	    ESSTEE_TYPE_ERROR,
+	    self->identifier,
+	    (unsigned)capacity,
+	    (unsigned)string_length);
 
-	    return ESSTEE_FALSE;
-	}
+	return ESSTEE_FALSE;
     }
 
     return ESSTEE_TRUE;
@@ -423,15 +919,11 @@ static int custom_string_type_reset_value_of(
 
     if(cst->default_value)
     {
-	sv->str = cst->default_value->string(cst->default_value,
-					     config,
-					     issues);
-    }
-    else
-    {
-	sv->str = cst->st.default_value;
+	return string_value_assign(value_of, cst->default_value, config, issues);
     }
 
+    string_value_set_text(sv, "", 0);
+
     return ESSTEE_OK;
 }
 
@@ -459,7 +951,6 @@ static struct string_type_t string_type_templates[] = {
 	},
 	.class = STRING_TYPE,
 	.length = 0,
-	.default_value = "''",
     },
     {	.type = {
 	    .location = NULL,
@@ -475,7 +966,6 @@ static struct string_type_t string_type_templates[] = {
 	},
 	.class = WSTRING_TYPE,
 	.length = 0,
-	.default_value = "\"\"",
     },
 };
 
@@ -514,6 +1004,7 @@ struct type_iface_t * st_new_custom_length_string_type(
     struct value_iface_t *length,
     const struct st_location_t *length_location,
     struct value_iface_t *default_value,
+    const struct st_location_t *default_value_location,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
@@ -576,20 +1067,42 @@ struct type_iface_t * st_new_custom_length_string_type(
 
     if(strcmp(type_name, "STRING") == 0)
     {
-	cst->st.default_value = "''";
 	cst->st.type.identifier = "STRING";
 	cst->st.class = STRING_TYPE;
     }
     else
     {
-	cst->st.default_value = "\"\"";
 	cst->st.type.identifier = "WSTRING";
 	cst->st.class = WSTRING_TYPE;
     }
 
+    /* A default value is checked as an assignment of it would be */
+    if(default_value)
+    {
+	struct issue_group_iface_t *ig = issues->open_group(issues);
+
+	int can_hold_default_value = cst->st.type.can_hold(&(cst->st.type),
+							   default_value,
+							   config,
+							   issues);
+	ig->close(ig);
+
+	if(can_hold_default_value != ESSTEE_TRUE)
+	{
+	    ig->main_issue(ig,
+			   "type cannot hold value",
+			   ESSTEE_TYPE_ERROR,
+			   1,
+			   default_value_location);
+
+	    goto error_free_resources;
+	}
+    }
+
     return &(cst->st.type);
 
 error_free_resources:
+    free(cst);
     return NULL;
 }
 
@@ -634,9 +1147,12 @@ struct value_iface_t * st_new_string_value(
     ls->value.comparable_to = literal_string_compares;
     ls->value.type_of = literal_string_type_of;
     ls->value.equals = literal_string_equals;
+    ls->value.greater = literal_string_greater;
+    ls->value.lesser = literal_string_lesser;
     ls->value.destroy = literal_string_destroy;
     ls->value.string = literal_string_string;
 
+    ls->length = decode_string_literal(content, ls->class);
     ls->content = content;
     
     return &(ls->value);
@@ -645,3 +1161,69 @@ error_free_resources:
     free(ls);
     return NULL;
 }
+
+const char * st_string_value_text(
+    const struct value_iface_t *value,
+    size_t *length,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return string_text(value, length, config, issues);
+}
+
+int st_string_value_write(
+    struct value_iface_t *value,
+    size_t offset,
+    const char *text,
+    size_t length)
+{
+    if(value->string != string_value_string)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    struct string_value_t *sv =
+	CONTAINER_OF(value, struct string_value_t, value);
+
+    size_t written = text_characters(sv->buffer, sv->length, sv->wide);
+    if(offset > sv->length)
+    {
+	/* Only a value filled by an earlier write ends before the offset */
+	return (written >= sv->capacity) ? ESSTEE_OK : ESSTEE_ERROR;
+    }
+
+    written = text_characters(sv->buffer, offset, sv->wide);
+    if(written >= sv->capacity)
+    {
+	return ESSTEE_OK;
+    }
+
+    length = text_fitting(text,
+			  length,
+			  sv->capacity - written,
+			  sv->size - offset,
+			  sv->wide);
+
+    memmove(sv->buffer + offset, text, length);
+    sv->length = offset + length;
+    sv->buffer[sv->length] = '\0';
+
+    return ESSTEE_OK;
+}
+
+size_t st_text_characters(
+    const char *text,
+    size_t length,
+    int wide)
+{
+    return text_characters(text, length, wide);
+}
+
+size_t st_text_offset(
+    const char *text,
+    size_t length,
+    size_t characters,
+    int wide)
+{
+    return text_fitting(text, length, characters, length, wide);
+}
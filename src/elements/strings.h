@@ -29,6 +29,7 @@ struct type_iface_t * st_new_custom_length_string_type(
     struct value_iface_t *length,
     const struct st_location_t *length_location,
     struct value_iface_t *default_value,
+    const struct st_location_t *default_value_location,
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
 
@@ -37,3 +38,35 @@ struct value_iface_t * st_new_string_value(
     char *content,
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
+
+/* Gives the text of a string value and its length, without scanning
+ * the text when the value is a string literal or variable */
+const char * st_string_value_text(
+    const struct value_iface_t *value,
+    size_t *length,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues);
+
+/* Writes text into a string value from the given offset, which must
+ * not be beyond its current length. The text is truncated at the
+ * capacity of the value, counted in characters, and the length set to
+ * end with the text. Offsets and lengths count bytes. */
+int st_string_value_write(
+    struct value_iface_t *value,
+    size_t offset,
+    const char *text,
+    size_t length);
+
+/* Gives the number of characters in a text, counted as code points
+ * when it is the UTF-8 encoded text of a WSTRING */
+size_t st_text_characters(
+    const char *text,
+    size_t length,
+    int wide);
+
+/* Gives the number of bytes the first characters of a text make up */
+size_t st_text_offset(
+    const char *text,
+    size_t length,
+    size_t characters,
+    int wide);
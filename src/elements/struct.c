@@ -21,6 +21,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/variable.h>
 #include <elements/values.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 
 #include <uthash.h>
 #include <stdio.h>
@@ -448,46 +449,39 @@ static const struct type_iface_t * struct_value_type_of(
     return sv->type;
 }
 
-static int struct_value_assignable_from(
-    const struct value_iface_t *self,
-    const struct value_iface_t *other_value,
+static int struct_value_assign(
+    struct value_iface_t *self,
+    const struct value_iface_t *new_value,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
     const struct struct_value_t *sv =
 	CONTAINER_OF(self, struct struct_value_t, value);
 
-    if(!other_value->struct_initializer)
+    /* Whole struct of the same type, the elements of both values are
+     * created in the same order so they are assigned pairwise */
+    if(new_value->assign == struct_value_assign)
     {
-	issues->new_issue(
-	    issues,
-	    "the complete struct can only be assigned an initializer in initialization",
-	    ESSTEE_CONTEXT_ERROR);
+	const struct struct_value_t *other =
+	    CONTAINER_OF(new_value, struct struct_value_t, value);
 
-	return ESSTEE_FALSE;
-    }
-    
-    int type_can_hold = sv->type->can_hold(sv->type,
-					   other_value,
-					   config,
-					   issues);
+	struct variable_iface_t *itr = sv->elements;
+	struct variable_iface_t *other_itr = other->elements;
+	for(; itr != NULL && other_itr != NULL; itr = itr->hh.next, other_itr = other_itr->hh.next)
+	{
+	    int assign_result = itr->assign(itr,
+					    NULL,
+					    other_itr->value(other_itr),
+					    config,
+					    issues);
+	    if(assign_result != ESSTEE_OK)
+	    {
+		return assign_result;
+	    }
+	}
 
-    if(type_can_hold != ESSTEE_TRUE)
-    {
-	return type_can_hold;
+	return ESSTEE_OK;
     }
-    
-    return ESSTEE_TRUE;
-}
-
-static int struct_value_assign(
-    struct value_iface_t *self,
-    const struct value_iface_t *new_value,
-    const struct config_iface_t *config,
-    struct issues_iface_t *issues)
-{
-    const struct struct_value_t *sv =
-	CONTAINER_OF(self, struct struct_value_t, value);
 
     const struct struct_initializer_iface_t *initializer =
 	new_value->struct_initializer(new_value);
@@ -526,6 +520,61 @@ static int struct_value_assign(
     return ESSTEE_OK;
 }
 
+static int struct_value_assignable_from(
+    const struct value_iface_t *self,
+    const struct value_iface_t *other_value,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct struct_value_t *sv =
+	CONTAINER_OF(self, struct struct_value_t, value);
+
+    if(other_value->assign == struct_value_assign)
+    {
+	const struct struct_value_t *other =
+	    CONTAINER_OF(other_value, struct struct_value_t, value);
+
+	const struct type_iface_t *vt =
+	    TYPE_ANCESTOR(sv->type);
+	const struct type_iface_t *ot =
+	    TYPE_ANCESTOR(other->type);
+	
+	if(vt != ot)
+	{
+	    issues->new_issue(
+		issues,
+		"a struct can only be assigned a struct of the same type",
+		ESSTEE_TYPE_ERROR);
+
+	    return ESSTEE_FALSE;
+	}
+
+	return ESSTEE_TRUE;
+    }
+
+    if(!other_value->struct_initializer)
+    {
+	issues->new_issue(
+	    issues,
+	    "the complete struct can only be assigned an initializer or another struct",
+	    ESSTEE_CONTEXT_ERROR);
+
+	return ESSTEE_FALSE;
+    }
+    
+    int type_can_hold = sv->type->can_hold(sv->type,
+					   other_value,
+					   config,
+					   issues);
+
+    if(type_can_hold != ESSTEE_TRUE)
+    {
+	return type_can_hold;
+    }
+    
+    return ESSTEE_TRUE;
+}
+
 int struct_value_override_type(
     const struct value_iface_t *self,
     const struct type_iface_t *type,
@@ -546,6 +595,48 @@ static void struct_value_destroy(
     /* TODO: struct value destructor */
 }
 
+static int struct_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct struct_value_t *sv =
+	CONTAINER_OF(self, struct struct_value_t, value);
+
+    struct variable_iface_t *itr = NULL;
+    for(itr = sv->elements; itr != NULL; itr = itr->hh.next)
+    {
+	int checkpoint_result = itr->checkpoint(itr, checkpoint, issues);
+	if(checkpoint_result != ESSTEE_OK)
+	{
+	    return checkpoint_result;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+static int struct_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct struct_value_t *sv =
+	CONTAINER_OF(self, struct struct_value_t, value);
+
+    struct variable_iface_t *itr = NULL;
+    for(itr = sv->elements; itr != NULL; itr = itr->hh.next)
+    {
+	int restore_result = itr->restore(itr, checkpoint, issues);
+	if(restore_result != ESSTEE_OK)
+	{
+	    return restore_result;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
 static struct variable_iface_t * struct_value_sub_variable(
     struct value_iface_t *self,
     const char *identifier,
@@ -636,6 +727,8 @@ static struct value_iface_t * struct_type_create_value_of(
     sv->value.type_of = struct_value_type_of;
     sv->value.override_type = struct_value_override_type;
     sv->value.destroy = struct_value_destroy;
+    sv->value.checkpoint = struct_value_checkpoint;
+    sv->value.restore = struct_value_restore;
     sv->value.sub_variable = struct_value_sub_variable;
     sv->value.class = st_general_value_empty_class;
 
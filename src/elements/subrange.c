@@ -19,6 +19,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <elements/subrange.h>
 #include <util/macros.h>
+#include <util/icheckpoint.h>
 #include <elements/values.h>
 
 /**************************************************************************/
@@ -258,6 +259,28 @@ static void subrange_value_destroy(
     /* TODO: subrange value destructor */
 }
 
+static int subrange_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct subrange_value_t *sv =
+	CONTAINER_OF(self, struct subrange_value_t, value);
+
+    return sv->current->checkpoint(sv->current, checkpoint, issues);
+}
+
+static int subrange_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct subrange_value_t *sv =
+	CONTAINER_OF(self, struct subrange_value_t, value);
+
+    return sv->current->restore(sv->current, checkpoint, issues);
+}
+
 static int64_t subrange_value_integer(
     const struct value_iface_t *self,
     const struct config_iface_t *config,
@@ -338,6 +361,8 @@ static struct value_iface_t * subrange_type_create_value_of(
     sv->value.override_type = subrange_value_override_type;
     sv->value.create_temp_from = subrange_value_create_temp_from;
     sv->value.destroy = subrange_value_destroy;
+    sv->value.checkpoint = subrange_value_checkpoint;
+    sv->value.restore = subrange_value_restore;
     sv->value.integer = subrange_value_integer;
     sv->value.class = st_general_value_empty_class;
     sv->value.greater = subrange_value_greater;
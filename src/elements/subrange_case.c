@@ -139,3 +139,17 @@ struct value_iface_t * st_create_subrange_case_selector(
 error_free_resources:
     return NULL;
 }
+
+const struct subrange_iface_t * st_subrange_case_subrange(
+    const struct value_iface_t *value)
+{
+    if(value->equals != subrange_case_value_equals)
+    {
+	return NULL;
+    }
+
+    const struct subrange_case_value_t *sv =
+	CONTAINER_OF(value, struct subrange_case_value_t, value);
+
+    return sv->subrange;
+}
@@ -28,3 +28,8 @@ struct value_iface_t * st_create_subrange_case_selector(
     struct subrange_iface_t *subrange,
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
+
+/* Gives the subrange of a value created by
+ * st_create_subrange_case_selector, or NULL for any other value */
+const struct subrange_iface_t * st_subrange_case_subrange(
+    const struct value_iface_t *value);
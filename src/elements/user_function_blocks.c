@@ -19,6 +19,7 @@
 
 #include <elements/user_function_blocks.h>
 #include <elements/ifunction_block.h>
+#include <elements/variable.h>
 #include <statements/statements.h>
 #include <util/macros.h>
 #include <linker/linker.h>
@@ -424,6 +425,28 @@ static int user_fb_value_invoke_reset(
     return ESSTEE_OK;
 }
 
+static int user_fb_value_checkpoint(
+    const struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct user_fb_instance_t *fv =
+	CONTAINER_OF(self, struct user_fb_instance_t, value);
+
+    return st_checkpoint_variables(fv->variables, checkpoint, issues);
+}
+
+static int user_fb_value_restore(
+    struct value_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct user_fb_instance_t *fv =
+	CONTAINER_OF(self, struct user_fb_instance_t, value);
+
+    return st_restore_variables(fv->variables, checkpoint, issues);
+}
+
 /**************************************************************************/
 /* Type interface                                                         */
 /**************************************************************************/
@@ -512,6 +535,7 @@ static struct value_iface_t * user_fb_type_create_value_of(
     st_post_clone_hook_for_statements(statement_clones, config, issues);
     
     /* Set up fb instance members */
+    fv->fb = fb;
     fv->variables = variable_table_clone;
     fv->statements = statement_clones;
 
@@ -523,6 +547,8 @@ static struct value_iface_t * user_fb_type_create_value_of(
     fv->value.invoke_verify = user_fb_value_invoke_verify;
     fv->value.invoke_step = user_fb_value_invoke_step;
     fv->value.invoke_reset = user_fb_value_invoke_reset;
+    fv->value.checkpoint = user_fb_value_checkpoint;
+    fv->value.restore = user_fb_value_restore;
 
     return &(fv->value);
     
@@ -633,8 +659,8 @@ struct type_iface_t * st_new_user_function_block(
     ufb->type.class = user_fb_type_class;
     ufb->type.destroy = user_fb_type_destroy;
 
-    ufb->identifier = ufb->identifier;
-    ufb->location = ufb->location;
+    ufb->function_block.identifier = ufb->identifier;
+    ufb->function_block.location = ufb->location;
     ufb->function_block.resolve_header_type_references = user_fb_resolve_header_type_references;
     ufb->function_block.check_dependencies = user_fb_check_dependencies;
     ufb->function_block.finalize_header = user_fb_finalize_header;
@@ -19,6 +19,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <elements/user_programs.h>
 #include <linker/linker.h>
+#include <elements/variable.h>
 #include <statements/statements.h>
 #include <util/macros.h>
 
@@ -181,6 +182,47 @@ static int user_program_run_cycle(
     return ESSTEE_OK;
 }
 
+static int user_program_checkpoint(
+    const struct program_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct user_program_t *p =
+	CONTAINER_OF(self, struct user_program_t, program);
+
+    if(!p->header)
+    {
+	return ESSTEE_OK;
+    }
+    
+    return st_checkpoint_variables(p->header->variables, checkpoint, issues);
+}
+
+static int user_program_restore(
+    struct program_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct user_program_t *p =
+	CONTAINER_OF(self, struct user_program_t, program);
+
+    if(!p->header)
+    {
+	return ESSTEE_OK;
+    }
+
+    return st_restore_variables(p->header->variables, checkpoint, issues);
+}
+
+static struct variable_iface_t * user_program_variables(
+    struct program_iface_t *self)
+{
+    struct user_program_t *p =
+	CONTAINER_OF(self, struct user_program_t, program);
+
+    return (p->header) ? p->header->variables : NULL;
+}
+
 static struct variable_iface_t * user_program_variable(
     struct program_iface_t *self,
     const char *variable_identifier,
@@ -315,6 +357,9 @@ struct program_iface_t * st_new_user_program(
     p->program.start = user_program_start;
     p->program.run_cycle = user_program_run_cycle;
     p->program.variable = user_program_variable;
+    p->program.variables = user_program_variables;
+    p->program.checkpoint = user_program_checkpoint;
+    p->program.restore = user_program_restore;
     p->program.display = user_program_display;
     p->program.destroy = user_program_destroy;
     
@@ -19,6 +19,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <elements/variable.h>
 #include <elements/derived.h>
+#include <rt/iwatcher.h>
 #include <util/macros.h>
 
 #include <utlist.h>
@@ -41,8 +42,21 @@ struct variable_t {
     struct value_iface_t *value;
     struct variable_stub_t *stub;
     struct variable_iface_t *external_alias;
+    struct variable_watch_t *watch;
 };
 
+/* Without watches a modification costs a single test */
+static void mark_modified(
+    struct variable_t *var,
+    const struct value_iface_t *written)
+{
+    struct variable_watch_t *itr = NULL;
+    for(itr = var->watch; itr != NULL; itr = itr->next)
+    {
+	itr->modified(itr, written);
+    }
+}
+
 static struct value_iface_t * referred_value(
     struct variable_t *var,
     const struct array_index_iface_t *index,
@@ -120,6 +134,8 @@ static int variable_reset(
     struct variable_t *var =
 	CONTAINER_OF(self, struct variable_t, variable);
 
+    mark_modified(var, var->value);
+    
     return var->stub->type->reset_value_of(var->stub->type,
 					   var->value,
 					   config,
@@ -214,6 +230,8 @@ static int variable_assign(
     
     if(assign_result == ESSTEE_OK)
     {
+	mark_modified(var, value);
+	
 	if(var->stub->address)
 	{
 	    var->stub->type->sync_direct_memory(var->stub->type,
@@ -270,6 +288,8 @@ static int variable_cast_assign(
 	return assign_result;
     }
 
+    mark_modified(var, value);
+    
     return ESSTEE_OK;
 }
 
@@ -339,6 +359,8 @@ static int variable_modifier(
 
     if(operation_result == ESSTEE_OK)
     {
+	mark_modified(var, value);
+	
 	if(var->stub->address)
 	{
 	    var->stub->type->sync_direct_memory(var->stub->type,
@@ -463,6 +485,8 @@ static int variable_modifier_by_value(
 
     if(operation_result == ESSTEE_OK)
     {
+	mark_modified(var, value);
+	
 	if(var->stub->address)
 	{
 	    var->stub->type->sync_direct_memory(var->stub->type,
@@ -873,6 +897,10 @@ static int variable_invoke_step(
 	return ESSTEE_ERROR;
     }
 
+    /* An invocation may change the outputs and the internal state of
+     * the instance */
+    mark_modified(var, value);
+    
     return value->invoke_step(value,
 			      parameters,
 			      cursor,
@@ -980,6 +1008,7 @@ static struct variable_iface_t * variable_clone(
     memcpy(clone, var, sizeof(struct variable_t));
     clone->variable.destroy = variable_clone_destroy;
     clone->value = NULL;
+    clone->watch = NULL;
 
     return &(clone->variable);
 
@@ -1133,6 +1162,106 @@ static const struct value_iface_t * external_variable_index_value(
 					    issues);
 }
 
+static int variable_checkpoint(
+    const struct variable_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    if(!var->value->checkpoint)
+    {
+	issues->new_issue(issues,
+			  "the value of variable '%s' cannot be checkpointed",
+			  ESSTEE_CONTEXT_ERROR,
+			  self->identifier);
+	return ESSTEE_ERROR;
+    }
+
+    return var->value->checkpoint(var->value, checkpoint, issues);
+}
+
+static int variable_restore(
+    struct variable_iface_t *self,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    if(!var->value->restore)
+    {
+	issues->new_issue(issues,
+			  "the value of variable '%s' cannot be restored",
+			  ESSTEE_CONTEXT_ERROR,
+			  self->identifier);
+	return ESSTEE_ERROR;
+    }
+
+    mark_modified(var, var->value);
+    
+    return var->value->restore(var->value, checkpoint, issues);
+}
+
+static struct variable_watch_t * variable_watched_by(
+    const struct variable_iface_t *self)
+{
+    const struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    return var->watch;
+}
+
+static struct variable_watch_t * external_variable_watched_by(
+    const struct variable_iface_t *self)
+{
+    const struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    return var->external_alias->watched_by(var->external_alias);
+}
+
+static void variable_add_watch(
+    struct variable_iface_t *self,
+    struct variable_watch_t *watch)
+{
+    struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    LL_APPEND(var->watch, watch);
+}
+
+static void variable_remove_watch(
+    struct variable_iface_t *self,
+    struct variable_watch_t *watch)
+{
+    struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    LL_DELETE(var->watch, watch);
+}
+
+static void external_variable_add_watch(
+    struct variable_iface_t *self,
+    struct variable_watch_t *watch)
+{
+    struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    var->external_alias->add_watch(var->external_alias, watch);
+}
+
+static void external_variable_remove_watch(
+    struct variable_iface_t *self,
+    struct variable_watch_t *watch)
+{
+    struct variable_t *var =
+	CONTAINER_OF(self, struct variable_t, variable);
+
+    var->external_alias->remove_watch(var->external_alias, watch);
+}
+
 static const struct value_iface_t * variable_value(
     struct variable_iface_t *self)
 {
@@ -1493,9 +1622,14 @@ struct variable_iface_t * st_create_variable_block(
 
 	memset(&(var->variable), 0, sizeof(struct variable_iface_t));
 	var->variable.class = block_class|retain_flag|constant_flag;
+	if(itr->address)
+	{
+	    ST_SET_FLAGS(var->variable.class, DIRECT_VAR_CLASS);
+	}
 	var->variable.identifier = itr->identifier;
 	var->variable.location = itr->location;
 	var->stub = itr;
+	var->watch = NULL;
 	    
 	if(ST_FLAG_IS_SET(block_class, EXTERNAL_VAR_CLASS))
 	{
@@ -1529,6 +1663,10 @@ struct variable_iface_t * st_create_variable_block(
 
 	    var->variable.type = external_variable_type;
 
+	    var->variable.watched_by = external_variable_watched_by;
+	    var->variable.add_watch = external_variable_add_watch;
+	    var->variable.remove_watch = external_variable_remove_watch;
+
 	    var->variable.destroy = external_variable_destroy;
 
 	    int ref_result = global_var_refs->add(
@@ -1573,8 +1711,14 @@ struct variable_iface_t * st_create_variable_block(
 
 	    var->variable.index_value = variable_index_value;
 	    var->variable.value = variable_value;
+	    var->variable.checkpoint = variable_checkpoint;
+	    var->variable.restore = variable_restore;
 
 	    var->variable.type = variable_type;
+
+	    var->variable.watched_by = variable_watched_by;
+	    var->variable.add_watch = variable_add_watch;
+	    var->variable.remove_watch = variable_remove_watch;
 	    
 	    var->variable.destroy = variable_destroy;
 
@@ -1669,6 +1813,7 @@ struct variable_iface_t * st_create_variable_type_name(
     var->stub = stub;
     var->value = NULL;
     var->external_alias = NULL;
+    var->watch = NULL;
 
     memset(&(var->variable), 0, sizeof(struct variable_iface_t));
     var->variable.identifier = stub->identifier;
@@ -1683,6 +1828,11 @@ struct variable_iface_t * st_create_variable_type_name(
     var->variable.assign = variable_assign;
     var->variable.cast_assign = variable_cast_assign;
     var->variable.value = variable_value;
+    var->variable.checkpoint = variable_checkpoint;
+    var->variable.restore = variable_restore;
+    var->variable.watched_by = variable_watched_by;
+    var->variable.add_watch = variable_add_watch;
+    var->variable.remove_watch = variable_remove_watch;
 
     int ref_result = type_refs->add(
 	type_refs,
@@ -1747,6 +1897,7 @@ struct variable_iface_t * st_create_variable_type(
     var->stub = stub;
     var->value = NULL;
     var->external_alias = NULL;
+    var->watch = NULL;
 
     memset(&(var->variable), 0, sizeof(struct variable_iface_t));
     var->variable.identifier = stub->identifier;
@@ -1760,6 +1911,11 @@ struct variable_iface_t * st_create_variable_type(
     var->variable.assign = variable_assign;
     var->variable.cast_assign = variable_cast_assign;
     var->variable.value = variable_value;
+    var->variable.checkpoint = variable_checkpoint;
+    var->variable.restore = variable_restore;
+    var->variable.watched_by = variable_watched_by;
+    var->variable.add_watch = variable_add_watch;
+    var->variable.remove_watch = variable_remove_watch;
 
     return &(var->variable);
 
@@ -1768,3 +1924,43 @@ error_free_resources:
     free(var);
     return NULL;
 }
+
+int st_checkpoint_variables(
+    const struct variable_iface_t *variables,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    const struct variable_iface_t *itr = NULL;
+    DL_FOREACH(variables, itr)
+    {
+	if(itr->checkpoint)
+	{
+	    if(itr->checkpoint(itr, checkpoint, issues) != ESSTEE_OK)
+	    {
+		return ESSTEE_ERROR;
+	    }
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+int st_restore_variables(
+    struct variable_iface_t *variables,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues)
+{
+    struct variable_iface_t *itr = NULL;
+    DL_FOREACH(variables, itr)
+    {
+	if(itr->restore)
+	{
+	    if(itr->restore(itr, checkpoint, issues) != ESSTEE_OK)
+	    {
+		return ESSTEE_ERROR;
+	    }
+	}
+    }
+
+    return ESSTEE_OK;
+}
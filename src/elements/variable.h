@@ -94,3 +94,12 @@ struct variable_iface_t * st_create_variable_type(
     const struct config_iface_t *config,
     struct issues_iface_t *issues);
 
+int st_checkpoint_variables(
+    const struct variable_iface_t *variables,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues);
+
+int st_restore_variables(
+    struct variable_iface_t *variables,
+    struct checkpoint_iface_t *checkpoint,
+    struct issues_iface_t *issues);
@@ -0,0 +1,53 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+
+/* Wall-clock execution times of the cycles run, the percentiles are
+ * taken from a histogram with a relative error of at most 1/32 and
+ * round upwards, never below the true value */
+struct st_cycle_stats_t {
+    uint64_t cycles;		/* Cycles recorded */
+    uint64_t overruns;		/* Cycles exceeding the budget */
+    uint64_t budget_ns;		/* Zero when no budget is set */
+    uint64_t last_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+};
+
+/* Outcome of a periodic run, the start latency of a cycle is measured
+ * from the deadline it was due to start at */
+struct st_periodic_report_t {
+    uint64_t cycles;
+    uint64_t overruns;		/* Cycles finishing after the next deadline */
+    uint64_t skipped;		/* Deadlines passed during overruns */
+    uint64_t max_latency_ns;
+    uint64_t mean_latency_ns;
+};
+
+struct st_fast_forward_report_t {
+    uint64_t cycles_run;
+    uint64_t cycles_skipped;	/* Idle cycles whose time was skipped */
+};
@@ -21,14 +21,28 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <esstee/issues.h>
 #include <esstee/elements.h>
+#include <esstee/profile.h>
+#include <esstee/cycle_stats.h>
 
 #include <stddef.h>
 
 struct st_t;
 
+/* Growable byte buffer, the bytes are allocated by the library and
+ * released by the owner with free() */
+struct st_buffer_t {
+    char *bytes;
+    size_t size;
+    size_t capacity;
+};
+
 struct st_t * st_new_instance(
     size_t direct_memory_bytes);
 
+/* Options are boolean, and read when the elements they affect are
+ * linked. With "short_circuit_evaluation" set, the right operand of a
+ * boolean AND or OR is only evaluated when the left operand does not
+ * decide the result (AND_THEN/OR_ELSE semantics). */
 int st_set_config(
     const char *option,
     int value,
@@ -42,9 +56,14 @@ int st_load_file(
     struct st_t *st,
     const char *path);
 
+/* A buffer ending with two NUL bytes (counted in len) is scanned in
+ * place, without a copy. The scanner writes to it during the call,
+ * and may leave it modified. The buffer stays owned by the caller and
+ * is not referenced after the call returns. Any other buffer is copied
+ * and left untouched, the copy is kept for cloning the instance. */
 int st_load_buffer(
     const char *identifier, 
-    const char *bytes, 
+    char *bytes, 
     size_t len, 
     struct st_t *st);
 
@@ -82,6 +101,145 @@ int st_run_cycle(
     struct st_t *st,
     uint64_t ms);
 
+/* A paced instance has its time follow the monotonic clock, time
+ * given to st_run_cycle or st_step_time is added on top of it */
+int st_set_paced(
+    struct st_t *st,
+    int paced);
+
+/* Runs the given number of cycles (zero for no limit) in paced mode,
+ * starting each at an absolute deadline one period after the previous
+ * one. A cycle finishing after the next deadline is an overrun, the
+ * deadlines it passed are skipped. Returns at the first failing cycle,
+ * or once st_stop_periodic is called (from any thread). */
+int st_run_periodic(
+    struct st_t *st,
+    uint64_t period_us,
+    uint64_t cycles,
+    struct st_periodic_report_t *report);
+
+void st_stop_periodic(
+    struct st_t *st);
+
+/* Records the given variables (separated by ';', "[program].variable"
+ * for program variables and "variable" for globals, NULL for all) to
+ * a trace file. Cycle 0 of the trace holds their values at start, the
+ * cycles run after it add the values that changed. */
+int st_trace_start(
+    struct st_t *st,
+    const char *path,
+    const char *variables);
+
+int st_trace_stop(
+    struct st_t *st);
+
+/* Restores the traced variables and the time to their state after the
+ * given cycle of a trace, recorded by an instance of the same program */
+int st_trace_restore(
+    struct st_t *st,
+    const char *path,
+    uint64_t cycle);
+
+/* Called with the display of the new value (NULL if the value cannot
+ * be displayed). Callbacks must not call into the instance. */
+typedef void (*st_watch_callback_t)(
+    const char *identifier,
+    const char *value,
+    void *user_data);
+
+/* Calls back after each cycle, checkpoint restore or trace restore in
+ * which the watched variable got a different value. The identifier is
+ * "[program].variable" or "variable" for a global, followed by
+ * ".member" for members of structures and function block instances.
+ * A structure is seen changing when written as a whole, and an instance
+ * when invoked, watch their members to see member writes. Changes made
+ * through direct memory aliases are not seen. Watches are
+ * dropped when source is loaded or unloaded. */
+int st_watch(
+    struct st_t *st,
+    const char *identifier,
+    st_watch_callback_t callback,
+    void *user_data);
+
+int st_unwatch(
+    struct st_t *st,
+    const char *identifier);
+
+/* Runs span_ms of program time in whole cycles of cycle_ms. A cycle
+ * leaving the runtime state unchanged is idle, the time of the
+ * following cycles is then skipped up to the earliest deadline a timer
+ * waits for, or to the end of the span. */
+int st_fast_forward(
+    struct st_t *st,
+    uint64_t span_ms,
+    uint64_t cycle_ms,
+    struct st_fast_forward_report_t *report);
+
+/* Checkpoints are taken between cycles, and may be restored into any
+ * instance linked from the same program. A checkpoint of another
+ * program, or of an instance with another size of direct memory, is
+ * rejected with an issue. */
+int st_checkpoint(
+    struct st_t *st,
+    struct st_buffer_t *buffer);
+
+int st_restore(
+    struct st_t *st,
+    const struct st_buffer_t *buffer);
+
+/* A clone is linked from the same sources as the linked instance,
+ * and starts from its runtime state between cycles. It owns all its
+ * elements, variables, direct memory and time, so an instance and its
+ * clones may run at once from different threads. The configuration is
+ * copied, but the clone starts without profiling, limits, pacing,
+ * trace, watches or breakpoints. Sources loaded in place are not
+ * kept, an instance with such sources cannot be cloned. */
+struct st_t * st_clone_instance(
+    struct st_t *st);
+
+/* Enabling profiling discards earlier results, disabling it keeps
+ * them available for fetching */
+int st_set_profiling(
+    struct st_t *st,
+    int enabled);
+
+const struct st_profile_entry_t * st_fetch_profile_entry(
+    struct st_t *st,
+    st_bitflag_t filter);
+
+const struct st_profile_call_t * st_fetch_profile_call(
+    struct st_t *st);
+
+/* A cycle executing more than max_steps statement steps, or running
+ * for longer than max_time_ns, fails with a runtime error at the
+ * location reached. Zero disables a limit. A failed cycle is resumed
+ * from that location by the next st_run_cycle, or discarded by
+ * st_abort_cycle. */
+int st_set_cycle_limits(
+    struct st_t *st,
+    uint64_t max_steps,
+    uint64_t max_time_ns);
+
+/* The next cycle run starts from the beginning of the program, the
+ * variables keep their values */
+int st_abort_cycle(
+    struct st_t *st);
+
+/* Every successful cycle run has its execution time recorded, cycles
+ * taking longer than a set budget are counted as overruns */
+const struct st_cycle_stats_t * st_cycle_stats(
+    struct st_t *st);
+
+void st_set_cycle_budget(
+    struct st_t *st,
+    uint64_t budget_ns);
+
+void st_reset_cycle_stats(
+    struct st_t *st);
+
+/* Steps the started program one statement, into the next invoke, or
+ * out of the current call, giving the location reached. A cycle
+ * completed by stepping passes no time. */
 const struct st_location_t * st_step(
     struct st_t *st);
 
@@ -91,6 +249,54 @@ const struct st_location_t * st_step_in(
 const struct st_location_t * st_step_out(
     struct st_t *st);
 
+/* The location the started program is at */
+const struct st_location_t * st_location(
+    struct st_t *st);
+
+/* A breakpoint is set on a line of a source, or of any source when
+ * the source is NULL. The condition, if not NULL, is an expression
+ * over the variables of the started program, parenthesize
+ * comparisons combined by AND or OR, e.g. "(x > 10) AND done". It is
+ * compiled once, and the breakpoint is only hit when it is true.
+ * Setting a breakpoint again replaces its condition, loading or
+ * unloading a buffer clears all breakpoints. */
+int st_set_breakpoint(
+    struct st_t *st,
+    const char *source,
+    int line,
+    const char *condition);
+
+int st_clear_breakpoint(
+    struct st_t *st,
+    const char *source,
+    int line);
+
+/* A watchpoint is hit by a write of a variable, named as by
+ * st_watch, where the last part may be indexed to watch a single
+ * element, e.g. "[prog].table[2]" or "counter.value". The condition,
+ * if not NULL, is an expression over the variables in the scope of
+ * the watched variable, the global variables or the variables of its
+ * program, tested after the write. Watchpoints are hit while
+ * continuing, variables without watchpoints run as fast as before. */
+int st_set_watchpoint(
+    struct st_t *st,
+    const char *target,
+    const char *condition);
+
+int st_clear_watchpoint(
+    struct st_t *st,
+    const char *target);
+
+/* Runs the started program until a breakpoint or watchpoint is hit,
+ * giving ESSTEE_TRUE with st_location at the breakpoint, or after the
+ * write, or until max_cycles (zero for no limit) cycles are
+ * completed, giving ESSTEE_FALSE. Each completed cycle passes ms of
+ * time. Without breakpoints, the cycles are run as by st_run_cycle. */
+int st_continue(
+    struct st_t *st,
+    uint64_t ms,
+    uint64_t max_cycles);
+
 int st_step_time(
     struct st_t *st,
     uint64_t ms);
@@ -54,6 +54,13 @@ typedef uint64_t st_bitflag_t;
 #define ESSTEE_FILTER_ANY_WARNING         (1 << 9)
 #define ESSTEE_FILTER_ANY_ISSUE 0xffffffffffffffff
 
+#define ESSTEE_PROFILE_STATEMENT          (1 << 0)
+#define ESSTEE_PROFILE_FUNCTION           (1 << 1)
+#define ESSTEE_PROFILE_FUNCTION_BLOCK     (1 << 2)
+#define ESSTEE_PROFILE_PROGRAM            (1 << 3)
+#define ESSTEE_FILTER_ANY_POU                0xe
+#define ESSTEE_FILTER_ANY_PROFILE            0xf
+
 #define ISSUE_ERROR_CLASS                 (1 << 0)
 #define ISSUE_WARNING_CLASS               (1 << 1)
 
@@ -0,0 +1,40 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <esstee/flags.h>
+#include <esstee/locations.h>
+
+#include <inttypes.h>
+
+struct st_profile_entry_t {
+    st_bitflag_t class;
+    const char *identifier;	/* POU, for statements the enclosing one */
+    const struct st_location_t *location;
+    uint64_t steps;		/* Executed statement steps */
+    uint64_t calls;		/* Calls from other POUs */
+    uint64_t time_ns;		/* Time spent in the steps */
+};
+
+struct st_profile_call_t {
+    const struct st_profile_entry_t *caller;
+    const struct st_profile_entry_t *callee;
+    uint64_t calls;
+};
@@ -20,6 +20,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <expressions/binary_expressions.h>
 #include <elements/integers.h>
 #include <util/macros.h>
+#include <statements/invariants.h>
 
 /**************************************************************************/
 /* Expression interface                                                   */
@@ -29,6 +30,7 @@ struct binary_expression_t {
     struct expression_iface_t *left_operand;
     struct expression_iface_t *right_operand;
     int invoke_state;
+    int short_circuit;
     struct st_location_t *location;
     struct value_iface_t *temporary;
 };
@@ -216,7 +218,7 @@ static int be_verify(
     binary_operation_t *operation
 	= (binary_operation_t *)(((char *)left_value) + operation_offset);
 
-    if(!operation)
+    if(!(*operation))
     {
 	issues->new_issue_at(
 	    issues,
@@ -309,6 +311,116 @@ static int be_step(
     return INVOKE_RESULT_FINISHED;
 }
 
+/* Boolean and/or, only stepping the right operand when the left does
+ * not decide the result */
+static int be_short_circuit_step(
+    struct invoke_iface_t *self,
+    size_t operation_offset,
+    int deciding_state,
+    struct cursor_iface_t *cursor,
+    const struct systime_iface_t *time,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct expression_iface_t *e =
+	CONTAINER_OF(self, struct expression_iface_t, invoke);
+    struct binary_expression_t *be =
+	CONTAINER_OF(e, struct binary_expression_t, expression);
+
+    switch(be->invoke_state)
+    {
+    case 0:
+	if(be->left_operand->invoke.step)
+	{
+	    be->invoke_state = 1;
+	    cursor->switch_current(cursor,
+				   &(be->left_operand->invoke),
+				   config,
+				   issues);
+	    return INVOKE_RESULT_IN_PROGRESS;
+	}
+
+    case 1: {
+	const struct value_iface_t *left_value =
+	    be->left_operand->return_value(be->left_operand);
+
+	if(left_value->bool(left_value, config, issues) == deciding_state)
+	{
+	    be->invoke_state = 3;
+	    if(be->temporary->assign(be->temporary, left_value, config, issues) != ESSTEE_OK)
+	    {
+		issues->internal_error(
+		    issues,
+		    __FILE__,
+		    __FUNCTION__,
+		    __LINE__);
+		return INVOKE_RESULT_ERROR;
+	    }
+
+	    return INVOKE_RESULT_FINISHED;
+	}
+
+	if(be->right_operand->invoke.step)
+	{
+	    be->invoke_state = 2;
+	    cursor->switch_current(cursor,
+				   &(be->right_operand->invoke),
+				   config,
+				   issues);
+	    return INVOKE_RESULT_IN_PROGRESS;
+	}
+    }
+
+    case 2:
+	break;
+
+    case 3:
+    default:
+	return INVOKE_RESULT_FINISHED;
+    }
+
+    if(be_do_operation(be, operation_offset, config, issues) != ESSTEE_OK)
+    {
+	return INVOKE_RESULT_ERROR;
+    }
+
+    return INVOKE_RESULT_FINISHED;
+}
+
+/* An operand can be tested without stepping if it has a test of its
+ * own, or is a boolean that needs no stepping */
+static int be_operand_testable(
+    const struct expression_iface_t *operand)
+{
+    if(operand->test)
+    {
+	return ESSTEE_TRUE;
+    }
+    else if(operand->invoke.step)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    const struct value_iface_t *value = operand->return_value(operand);
+
+    return (value && value->bool) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+static int be_operand_test(
+    const struct expression_iface_t *operand,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(operand->test)
+    {
+	return operand->test(operand, config, issues);
+    }
+
+    const struct value_iface_t *value = operand->return_value(operand);
+
+    return value->bool(value, config, issues);
+}
+
 /* Binary expressions producing true/false (comparisons) */
 static int be_create_bool_temporary(
     struct binary_expression_t *be,
@@ -382,7 +494,7 @@ static int be_comparison_verify(
     binary_comparison_t *comparison
 	= (binary_comparison_t *)(((char *)left_value) + operation_offset);
 
-    if(!comparison)
+    if(!(*comparison))
     {
 	issues->new_issue_at(
 	    issues,
@@ -476,6 +588,26 @@ static int be_comparison_step(
     return INVOKE_RESULT_FINISHED;
 }
 
+static int be_test_comparison(
+    const struct expression_iface_t *self,
+    size_t operation_offset,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct binary_expression_t *be =
+	CONTAINER_OF(self, struct binary_expression_t, expression);
+
+    const struct value_iface_t *left_value =
+	be->left_operand->return_value(be->left_operand);
+    const struct value_iface_t *right_value =
+	be->right_operand->return_value(be->right_operand);
+
+    binary_comparison_t *comparison
+	= (binary_comparison_t *)(((char *)left_value) + operation_offset);
+
+    return (*comparison)(left_value, right_value, config, issues);
+}
+
 static int binary_expression_reset(
     struct invoke_iface_t *self,
     const struct config_iface_t *config,
@@ -597,12 +729,204 @@ static const struct value_iface_t * binary_expression_return_value(
     return be->temporary;
 }
 
+/* The bits of an integer or real type, reals counting as wider than
+ * any integer */
+static int operand_type_width(
+    const struct type_iface_t *type)
+{
+    st_bitflag_t class = type->class(type);
+
+    if(ST_FLAG_IS_SET(class, LREAL_TYPE))
+    {
+	return 128;
+    }
+    else if(ST_FLAG_IS_SET(class, REAL_TYPE))
+    {
+	return 96;
+    }
+    else if(class & (INTEGER_LINT_TYPE|INTEGER_ULINT_TYPE|INTEGER_LWORD_TYPE))
+    {
+	return 64;
+    }
+    else if(class & (INTEGER_DINT_TYPE|INTEGER_UDINT_TYPE|INTEGER_DWORD_TYPE))
+    {
+	return 32;
+    }
+    else if(class & (INTEGER_INT_TYPE|INTEGER_UINT_TYPE|INTEGER_WORD_TYPE))
+    {
+	return 16;
+    }
+    else if(class & (INTEGER_SINT_TYPE|INTEGER_USINT_TYPE|INTEGER_BYTE_TYPE))
+    {
+	return 8;
+    }
+
+    return 0;
+}
+
+static const struct type_iface_t * operand_type(
+    const struct expression_iface_t *operand)
+{
+    const struct value_iface_t *value = operand->return_value(operand);
+
+    if(value && value->type_of)
+    {
+	const struct type_iface_t *value_type = value->type_of(value);
+
+	if(value_type)
+	{
+	    return value_type;
+	}
+    }
+
+    if(operand->result_type)
+    {
+	return operand->result_type(operand);
+    }
+
+    return NULL;
+}
+
+static const struct type_iface_t * binary_expression_result_type(
+    const struct expression_iface_t *self)
+{
+    const struct binary_expression_t *be =
+	CONTAINER_OF(self, struct binary_expression_t, expression);
+
+    const struct type_iface_t *left_type = operand_type(be->left_operand);
+    const struct type_iface_t *right_type = operand_type(be->right_operand);
+
+    if(!left_type)
+    {
+	return right_type;
+    }
+    else if(!right_type)
+    {
+	return left_type;
+    }
+
+    return (operand_type_width(right_type) > operand_type_width(left_type)) ?
+	right_type : left_type;
+}
+
 static void binary_expression_destroy(
     struct expression_iface_t *self)
 {
     /* TODO: destructor */
 }
 
+static int be_operand_invariant(
+    struct expression_iface_t *operand,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    if(!operand->invariant)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    return operand->invariant(operand, invariants, issues);
+}
+
+static int be_hoist_operands(
+    struct binary_expression_t *be,
+    int left_invariant,
+    int right_invariant,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    if(left_invariant == ESSTEE_TRUE && right_invariant == ESSTEE_TRUE)
+    {
+	return ESSTEE_TRUE;
+    }
+
+    if(left_invariant == ESSTEE_TRUE
+       && st_loop_invariants_hoist(invariants, be->left_operand, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(right_invariant == ESSTEE_TRUE
+       && st_loop_invariants_hoist(invariants, be->right_operand, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_FALSE;
+}
+
+static int binary_expression_invariant(
+    struct expression_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct binary_expression_t *be =
+	CONTAINER_OF(self, struct binary_expression_t, expression);
+
+    int left_invariant = be_operand_invariant(be->left_operand,
+					      invariants,
+					      issues);
+    if(left_invariant == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int right_invariant = be_operand_invariant(be->right_operand,
+					       invariants,
+					       issues);
+    if(right_invariant == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return be_hoist_operands(be,
+			     left_invariant,
+			     right_invariant,
+			     invariants,
+			     issues);
+}
+
+/* The right operand of and/or may be left unevaluated, so nothing is
+ * hoisted from it on its own */
+static int short_circuit_expression_invariant(
+    struct expression_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct binary_expression_t *be =
+	CONTAINER_OF(self, struct binary_expression_t, expression);
+
+    int left_invariant = be_operand_invariant(be->left_operand,
+					      invariants,
+					      issues);
+    if(left_invariant == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    st_loop_invariants_suspend(invariants);
+    int right_invariant = be_operand_invariant(be->right_operand,
+					       invariants,
+					       issues);
+    st_loop_invariants_resume(invariants);
+
+    if(right_invariant == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(left_invariant != ESSTEE_TRUE)
+    {
+	right_invariant = ESSTEE_FALSE;
+    }
+
+    return be_hoist_operands(be,
+			     left_invariant,
+			     right_invariant,
+			     invariants,
+			     issues);
+}
+
 static void binary_expression_clone_destroy(
     struct expression_iface_t *self)
 {
@@ -714,16 +1038,61 @@ static int and_expression_constant_verify(
 			      issues);    
 }
 
+static int and_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct binary_expression_t *be =
+	CONTAINER_OF(self, struct binary_expression_t, expression);
+
+    int left_test = be_operand_test(be->left_operand, config, issues);
+    if(left_test != ESSTEE_TRUE)
+    {
+	return left_test;
+    }
+
+    return be_operand_test(be->right_operand, config, issues);
+}
+
 static int and_expression_verify(
     struct invoke_iface_t *self,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
-    return be_verify(self,
-		     "value does not support the and operation",
-		     offsetof(struct value_iface_t, and),
-		     config,
-		     issues);    
+    int verify_result = be_verify(self,
+				  "value does not support the and operation",
+				  offsetof(struct value_iface_t, and),
+				  config,
+				  issues);
+    if(verify_result != ESSTEE_OK)
+    {
+	return verify_result;
+    }
+
+    struct expression_iface_t *e =
+	CONTAINER_OF(self, struct expression_iface_t, invoke);
+    struct binary_expression_t *be =
+	CONTAINER_OF(e, struct binary_expression_t, expression);
+
+    const struct value_iface_t *left_value =
+	be->left_operand->return_value(be->left_operand);
+    const struct value_iface_t *right_value =
+	be->right_operand->return_value(be->right_operand);
+
+    int boolean_operands = (left_value->bool && right_value->bool);
+
+    be->short_circuit = (boolean_operands
+			 && config->get(config, "short_circuit_evaluation") == ESSTEE_TRUE);
+
+    if(boolean_operands
+       && be_operand_testable(be->left_operand) == ESSTEE_TRUE
+       && be_operand_testable(be->right_operand) == ESSTEE_TRUE)
+    {
+	be->expression.test = and_expression_test;
+    }
+
+    return ESSTEE_OK;    
 }
 
 static int and_expression_step(
@@ -733,6 +1102,22 @@ static int and_expression_step(
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
+    struct expression_iface_t *e =
+	CONTAINER_OF(self, struct expression_iface_t, invoke);
+    struct binary_expression_t *be =
+	CONTAINER_OF(e, struct binary_expression_t, expression);
+
+    if(be->short_circuit)
+    {
+	return be_short_circuit_step(self,
+				     offsetof(struct value_iface_t, and),
+				     ESSTEE_FALSE,
+				     cursor,
+				     time,
+				     config,
+				     issues);
+    }
+
     return be_step(self,
 		   offsetof(struct value_iface_t, and),
 		   cursor,
@@ -753,16 +1138,61 @@ static int or_expression_constant_verify(
 			      issues);    
 }
 
+static int or_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct binary_expression_t *be =
+	CONTAINER_OF(self, struct binary_expression_t, expression);
+
+    int left_test = be_operand_test(be->left_operand, config, issues);
+    if(left_test != ESSTEE_FALSE)
+    {
+	return left_test;
+    }
+
+    return be_operand_test(be->right_operand, config, issues);
+}
+
 static int or_expression_verify(
     struct invoke_iface_t *self,
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
-    return be_verify(self,
-		     "value does not support the or operation",
-		     offsetof(struct value_iface_t, or),
-		     config,
-		     issues);
+    int verify_result = be_verify(self,
+				  "value does not support the or operation",
+				  offsetof(struct value_iface_t, or),
+				  config,
+				  issues);
+    if(verify_result != ESSTEE_OK)
+    {
+	return verify_result;
+    }
+
+    struct expression_iface_t *e =
+	CONTAINER_OF(self, struct expression_iface_t, invoke);
+    struct binary_expression_t *be =
+	CONTAINER_OF(e, struct binary_expression_t, expression);
+
+    const struct value_iface_t *left_value =
+	be->left_operand->return_value(be->left_operand);
+    const struct value_iface_t *right_value =
+	be->right_operand->return_value(be->right_operand);
+
+    int boolean_operands = (left_value->bool && right_value->bool);
+
+    be->short_circuit = (boolean_operands
+			 && config->get(config, "short_circuit_evaluation") == ESSTEE_TRUE);
+
+    if(boolean_operands
+       && be_operand_testable(be->left_operand) == ESSTEE_TRUE
+       && be_operand_testable(be->right_operand) == ESSTEE_TRUE)
+    {
+	be->expression.test = or_expression_test;
+    }
+
+    return ESSTEE_OK;
 }
 
 static int or_expression_step(
@@ -772,6 +1202,22 @@ static int or_expression_step(
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
+    struct expression_iface_t *e =
+	CONTAINER_OF(self, struct expression_iface_t, invoke);
+    struct binary_expression_t *be =
+	CONTAINER_OF(e, struct binary_expression_t, expression);
+
+    if(be->short_circuit)
+    {
+	return be_short_circuit_step(self,
+				     offsetof(struct value_iface_t, or),
+				     ESSTEE_TRUE,
+				     cursor,
+				     time,
+				     config,
+				     issues);
+    }
+
     return be_step(self,
 		   offsetof(struct value_iface_t, or),
 		   cursor,
@@ -987,7 +1433,7 @@ static int lesser_expression_constant_verify(
     struct issues_iface_t *issues)
 {
     return be_comparison_constant_verify(self,
-					 "value does not support the > operation",
+					 "value does not support the < operation",
 					 offsetof(struct value_iface_t, lesser),
 					 config,
 					 issues);
@@ -1000,7 +1446,7 @@ static int lesser_expression_verify(
     struct issues_iface_t *issues)
 {
     return be_comparison_verify(self,
-				"value does not support the > operation",
+				"value does not support the < operation",
 				offsetof(struct value_iface_t, lesser),
 				config,
 				issues);
@@ -1117,7 +1563,7 @@ static int gequals_expression_constant_verify(
     const struct value_iface_t *left_value =
 	be->left_operand->return_value(be->left_operand);
     const struct value_iface_t *right_value =
-	be->left_operand->return_value(be->right_operand);
+	be->right_operand->return_value(be->right_operand);
     
     int error_encountered = 0;
     int greater_comparison = left_value->greater(left_value,
@@ -1194,7 +1640,7 @@ static int gequals_expression_step(
     const struct value_iface_t *left_value =
 	be->left_operand->return_value(be->left_operand);
     const struct value_iface_t *right_value =
-	be->left_operand->return_value(be->right_operand);
+	be->right_operand->return_value(be->right_operand);
     
     int error_encountered = 0;
     int greater_comparison = left_value->greater(left_value,
@@ -1301,7 +1747,7 @@ static int lequals_expression_constant_verify(
     const struct value_iface_t *left_value =
 	be->left_operand->return_value(be->left_operand);
     const struct value_iface_t *right_value =
-	be->left_operand->return_value(be->right_operand);
+	be->right_operand->return_value(be->right_operand);
     
     int error_encountered = 0;
     int lesser_comparison = left_value->lesser(left_value,
@@ -1378,7 +1824,7 @@ static int lequals_expression_step(
     const struct value_iface_t *left_value =
 	be->left_operand->return_value(be->left_operand);
     const struct value_iface_t *right_value =
-	be->left_operand->return_value(be->right_operand);
+	be->right_operand->return_value(be->right_operand);
 
     int error_encountered = 0;
     int lesser_comparison = left_value->lesser(left_value,
@@ -1620,6 +2066,97 @@ static int power_expression_step(
 		   issues);
 }
 
+/* Direct tests of comparisons */
+static int greater_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return be_test_comparison(self,
+			      offsetof(struct value_iface_t, greater),
+			      config,
+			      issues);
+}
+
+static int lesser_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return be_test_comparison(self,
+			      offsetof(struct value_iface_t, lesser),
+			      config,
+			      issues);
+}
+
+static int equals_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return be_test_comparison(self,
+			      offsetof(struct value_iface_t, equals),
+			      config,
+			      issues);
+}
+
+static int gequals_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int greater_comparison = be_test_comparison(self,
+						offsetof(struct value_iface_t, greater),
+						config,
+						issues);
+    if(greater_comparison != ESSTEE_FALSE)
+    {
+	return greater_comparison;
+    }
+
+    return be_test_comparison(self,
+			      offsetof(struct value_iface_t, equals),
+			      config,
+			      issues);
+}
+
+static int lequals_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int lesser_comparison = be_test_comparison(self,
+					       offsetof(struct value_iface_t, lesser),
+					       config,
+					       issues);
+    if(lesser_comparison != ESSTEE_FALSE)
+    {
+	return lesser_comparison;
+    }
+
+    return be_test_comparison(self,
+			      offsetof(struct value_iface_t, equals),
+			      config,
+			      issues);
+}
+
+static int nequals_expression_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    int comparison = be_test_comparison(self,
+					offsetof(struct value_iface_t, equals),
+					config,
+					issues);
+    if(comparison == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return (comparison == ESSTEE_TRUE) ? ESSTEE_FALSE : ESSTEE_TRUE;
+}
+
 static struct expression_iface_t * new_binary_expression(
     struct expression_iface_t *left_operand,
     struct expression_iface_t *right_operand,
@@ -1641,6 +2178,10 @@ static struct expression_iface_t * new_binary_expression(
     int (*allocate_function)(
 	struct invoke_iface_t *,
 	struct issues_iface_t *),
+    int (*test_function)(
+	const struct expression_iface_t *,
+	const struct config_iface_t *,
+	struct issues_iface_t *),
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
@@ -1663,8 +2204,16 @@ static struct expression_iface_t * new_binary_expression(
     be->left_operand = left_operand;
     be->right_operand = right_operand;
     be->temporary = NULL;
+    be->short_circuit = 0;
 
     memset(&(be->expression), 0, sizeof(struct expression_iface_t));
+
+    /* Comparisons of operands that need no stepping are tested
+     * directly by conditions */
+    if(test_function && !left_operand->invoke.step && !right_operand->invoke.step)
+    {
+	be->expression.test = test_function;
+    }
     
     if((left_operand->invoke.step || left_operand->clone) || (right_operand->invoke.step || right_operand->clone))
     {
@@ -1689,8 +2238,15 @@ static struct expression_iface_t * new_binary_expression(
     be->expression.invoke.location = be->location;
     be->expression.invoke.allocate = allocate_function;
     be->expression.return_value = binary_expression_return_value;
+    be->expression.invariant = binary_expression_invariant;
     be->expression.destroy = binary_expression_destroy;
 
+    /* Operations computed in a temporary of the left operand */
+    if(allocate_function == binary_expression_allocate)
+    {
+	be->expression.result_type = binary_expression_result_type;
+    }
+
     return &(be->expression);
     
 error_free_resources:
@@ -1717,6 +2273,7 @@ struct expression_iface_t * st_create_xor_expression(
 	location,
 	xor_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
 }
@@ -1728,7 +2285,7 @@ struct expression_iface_t * st_create_and_expression(
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
-    return new_binary_expression(
+    struct expression_iface_t *e = new_binary_expression(
 	left_operand,
 	right_operand,
 	and_expression_constant_verify,
@@ -1736,8 +2293,16 @@ struct expression_iface_t * st_create_and_expression(
 	location,
 	and_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
+
+    if(e)
+    {
+	e->invariant = short_circuit_expression_invariant;
+    }
+
+    return e;
 }
 
 struct expression_iface_t * st_create_or_expression(
@@ -1747,7 +2312,7 @@ struct expression_iface_t * st_create_or_expression(
     const struct config_iface_t *config,
     struct issues_iface_t *issues)
 {
-    return new_binary_expression(
+    struct expression_iface_t *e = new_binary_expression(
 	left_operand,
 	right_operand,
 	or_expression_constant_verify,
@@ -1755,8 +2320,16 @@ struct expression_iface_t * st_create_or_expression(
 	location,
 	or_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
+
+    if(e)
+    {
+	e->invariant = short_circuit_expression_invariant;
+    }
+
+    return e;
 }
 
 struct expression_iface_t * st_create_greater_expression(
@@ -1774,6 +2347,7 @@ struct expression_iface_t * st_create_greater_expression(
 	location,
 	greater_expression_step,
 	binary_expression_allocate_bool,
+	greater_expression_test,
 	config,
 	issues);
 }
@@ -1793,6 +2367,7 @@ struct expression_iface_t * st_create_lesser_expression(
 	location,
 	lesser_expression_step,
 	binary_expression_allocate_bool,
+	lesser_expression_test,
 	config,
 	issues);
 }
@@ -1812,6 +2387,7 @@ struct expression_iface_t * st_create_equals_expression(
 	location,
 	equals_expression_step,
 	binary_expression_allocate_bool,
+	equals_expression_test,
 	config,
 	issues);
 }
@@ -1831,6 +2407,7 @@ struct expression_iface_t * st_create_gequals_expression(
 	location,
 	gequals_expression_step,
 	binary_expression_allocate_bool,
+	gequals_expression_test,
 	config,
 	issues);
 }
@@ -1850,6 +2427,7 @@ struct expression_iface_t * st_create_lequals_expression(
 	location,
 	lequals_expression_step,	
 	binary_expression_allocate_bool,
+	lequals_expression_test,
 	config,
 	issues);
 }
@@ -1869,6 +2447,7 @@ struct expression_iface_t * st_create_nequals_expression(
 	location,
 	nequals_expression_step,
 	binary_expression_allocate_bool,
+	nequals_expression_test,
 	config,
 	issues);
 }
@@ -1888,6 +2467,7 @@ struct expression_iface_t * st_create_plus_expression(
 	location,
 	plus_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
 }
@@ -1907,6 +2487,7 @@ struct expression_iface_t * st_create_minus_expression(
 	location,
 	minus_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
 }
@@ -1926,6 +2507,7 @@ struct expression_iface_t * st_create_multiply_expression(
 	location,
 	multiply_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
 }
@@ -1945,6 +2527,7 @@ struct expression_iface_t * st_create_division_expression(
 	location,
 	division_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
 }
@@ -1964,6 +2547,7 @@ struct expression_iface_t * st_create_mod_expression(
 	location,
 	mod_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
 }
@@ -1983,6 +2567,7 @@ struct expression_iface_t * st_create_to_power_expression(
 	location,
 	power_expression_step,
 	binary_expression_allocate,
+	NULL,
 	config,
 	issues);
 }
@@ -28,10 +28,111 @@ struct function_invocation_term_t {
     struct expression_iface_t expression;
     struct function_iface_t *function;
     struct invoke_parameters_iface_t *parameters;
+    struct expression_iface_t *argument;
+    struct value_iface_t *result;
     struct st_location_t *location;
     int invoke_state;
 };
 
+/* The variant of an overloaded function depends on the arguments, it
+ * is determined once they have been allocated */
+static int function_invocation_term_overload(
+    struct function_invocation_term_t *ft,
+    struct issues_iface_t *issues)
+{
+    if(!ft->function->overload)
+    {
+	return ESSTEE_OK;
+    }
+
+    struct issue_group_iface_t *ig = issues->open_group(issues);
+
+    struct function_iface_t *variant = ft->function->overload(ft->function,
+							      ft->parameters,
+							      issues);
+    ig->close(ig);
+
+    if(!variant)
+    {
+	const char *message = issues->build_message(
+	    issues,
+	    "function '%s' cannot be invoked with the given arguments",
+	    ft->function->identifier);
+
+	ig->main_issue(ig,
+		       message,
+		       ESSTEE_ARGUMENT_ERROR,
+		       1,
+		       ft->location);
+
+	return ESSTEE_ERROR;
+    }
+
+    ft->function = variant;
+
+    return ESSTEE_OK;
+}
+
+static int function_invocation_term_intrinsic_step(
+    struct invoke_iface_t *self,
+    struct cursor_iface_t *cursor,
+    const struct systime_iface_t *time,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct expression_iface_t *expr
+	= CONTAINER_OF(self, struct expression_iface_t, invoke);
+    
+    struct function_invocation_term_t *ft =
+	CONTAINER_OF(expr, struct function_invocation_term_t, expression);
+
+    switch(ft->invoke_state)
+    {
+    case 0:
+	if(ft->argument->invoke.step)
+	{
+	    ft->invoke_state = 1;
+	    cursor->switch_current(cursor,
+				   &(ft->argument->invoke),
+				   config,
+				   issues);
+	    return INVOKE_RESULT_IN_PROGRESS;
+	}
+
+    case 1: {
+	const struct value_iface_t *argument_value =
+	    ft->argument->return_value(ft->argument);
+
+	struct issue_group_iface_t *ig = issues->open_group(issues);
+
+	int intrinsic_result = ft->function->intrinsic(ft->function,
+						       ft->result,
+						       argument_value,
+						       config,
+						       issues);
+	ig->close(ig);
+
+	if(intrinsic_result != ESSTEE_OK)
+	{
+	    const char *message = issues->build_message(
+		issues,
+		"evaluation of function '%s' failed",
+		ft->function->identifier);
+
+	    ig->main_issue(ig,
+			   message,
+			   ESSTEE_RUNTIME_ERROR,
+			   1,
+			   ft->location);
+	    
+	    return INVOKE_RESULT_ERROR;
+	}
+    }
+    }
+
+    return INVOKE_RESULT_FINISHED;
+}
+
 static int function_invocation_term_verify(
     struct invoke_iface_t *self,
     const struct config_iface_t *config,
@@ -43,10 +144,69 @@ static int function_invocation_term_verify(
     struct function_invocation_term_t *ft =
 	CONTAINER_OF(expr, struct function_invocation_term_t, expression);
 
-    return ft->function->verify_invoke(ft->function,
-				       ft->parameters,
-				       config,
-				       issues);
+    if(function_invocation_term_overload(ft, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int verify_result = ft->function->verify_invoke(ft->function,
+						    ft->parameters,
+						    config,
+						    issues);
+    if(verify_result != ESSTEE_OK)
+    {
+	return verify_result;
+    }
+
+    /* A function with an intrinsic form, given a single unnamed
+     * argument, is computed directly from the argument value without
+     * an invocation */
+    if(ft->function->intrinsic && ft->parameters)
+    {
+	ft->argument = ft->parameters->expression_of(ft->parameters, NULL, 0);
+
+	if(ft->argument)
+	{
+	    const struct value_iface_t *result_value =
+		ft->function->result_value(ft->function);
+
+	    ft->result = result_value->create_temp_from(result_value, issues);
+	    if(!ft->result)
+	    {
+		return ESSTEE_ERROR;
+	    }
+	    
+	    ft->expression.invoke.step = function_invocation_term_intrinsic_step;
+	    return ESSTEE_OK;
+	}
+    }
+
+    /* The result value of a function is shared by all its invocations,
+     * two invocations in the same expression would see the same
+     * result. The invocation copies the result into a value of its
+     * own after each step. */
+    const struct value_iface_t *result_value =
+	ft->function->result_value(ft->function);
+
+    const struct type_iface_t *result_type =
+	(result_value && result_value->type_of && result_value->assign)
+	? result_value->type_of(result_value) : NULL;
+
+    if(result_type)
+    {
+	ft->result = result_type->create_value_of(result_type, config, issues);
+	if(!ft->result)
+	{
+	    return ESSTEE_ERROR;
+	}
+
+	if(result_type->reset_value_of(result_type, ft->result, config, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return ESSTEE_OK;
 }
 
 static int function_invocation_term_step(
@@ -97,6 +257,20 @@ static int function_invocation_term_step(
 	    return step_result;
 	}
 
+	if(ft->result)
+	{
+	    int assign_result = ft->result->assign(
+		ft->result,
+		ft->function->result_value(ft->function),
+		config,
+		issues);
+
+	    if(assign_result != ESSTEE_OK)
+	    {
+		return INVOKE_RESULT_ERROR;
+	    }
+	}
+
 	ft->invoke_state = 2;
     }
 	
@@ -120,6 +294,8 @@ static int function_invocation_term_reset(
     
     struct function_invocation_term_t *ft =
 	CONTAINER_OF(expr, struct function_invocation_term_t, expression);
+
+    ft->invoke_state = 0;
     
     int reset_result = ft->function->reset(ft->function,
 					   config,
@@ -156,11 +332,15 @@ static int function_invocation_term_allocate(
 
     if(ft->parameters)
     {
-	return ft->parameters->allocate(ft->parameters,
-					issues);
+	int allocate_result = ft->parameters->allocate(ft->parameters,
+						       issues);
+	if(allocate_result != ESSTEE_OK)
+	{
+	    return allocate_result;
+	}
     }
 
-    return ESSTEE_OK;
+    return function_invocation_term_overload(ft, issues);
 }
 
 static const struct value_iface_t * function_invocation_term_return_value(
@@ -169,6 +349,11 @@ static const struct value_iface_t * function_invocation_term_return_value(
     const struct function_invocation_term_t *ft =
 	CONTAINER_OF(self, struct function_invocation_term_t, expression);
     
+    if(ft->result)
+    {
+	return ft->result;
+    }
+    
     return ft->function->result_value(ft->function);
 }
 
@@ -209,6 +394,33 @@ static struct expression_iface_t * function_invocation_term_clone(
     }
 
     copy->parameters = parameters_copy;
+    if(ft->argument)
+    {
+	copy->argument = parameters_copy->expression_of(parameters_copy, NULL, 0);
+    }
+    if(ft->result && ft->argument)
+    {
+	copy->result = ft->result->create_temp_from(ft->result, issues);
+	if(!copy->result)
+	{
+	    goto error_free_resources;
+	}
+    }
+    else if(ft->result)
+    {
+	const struct type_iface_t *result_type = ft->result->type_of(ft->result);
+
+	copy->result = result_type->create_value_of(result_type, NULL, issues);
+	if(!copy->result)
+	{
+	    goto error_free_resources;
+	}
+
+	if(result_type->reset_value_of(result_type, copy->result, NULL, issues) != ESSTEE_OK)
+	{
+	    goto error_free_resources;
+	}
+    }
     copy->expression.destroy = function_invocation_clone_destroy;
 
     return &(copy->expression);
@@ -296,6 +508,8 @@ struct expression_iface_t * st_create_function_invocation_term(
     ft->location = ft_location;
     ft->function = NULL;
     ft->parameters = invoke_parameters;
+    ft->argument = NULL;
+    ft->result = NULL;
 
     memset(&(ft->expression), 0, sizeof(struct expression_iface_t));
     
@@ -21,6 +21,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/enums.h>
 #include <util/macros.h>
 #include <elements/ivariable.h>
+#include <statements/invariants.h>
 
 struct single_identifier_term_t {
     struct expression_iface_t expression;
@@ -28,8 +29,7 @@ struct single_identifier_term_t {
     struct st_location_t *location;
     
     /* Identifier term refers to an enum value */
-    struct value_iface_t value;
-    struct enum_item_t item;
+    struct value_iface_t *enum_value;
 
     /* Identifier term refers to a variable */
     struct variable_iface_t *variable;
@@ -47,6 +47,19 @@ static const struct value_iface_t * identifier_term_variable_return_value(
     return sit->variable->value(sit->variable);
 }
 
+static int identifier_term_variable_invariant(
+    struct expression_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct single_identifier_term_t *sit =
+	CONTAINER_OF(self, struct single_identifier_term_t, expression);
+
+    int written = st_loop_invariants_written(invariants, sit->variable);
+
+    return (written == ESSTEE_TRUE) ? ESSTEE_FALSE : ESSTEE_TRUE;
+}
+
 static void identifier_term_destroy(
     struct expression_iface_t *self)
 {
@@ -88,68 +101,17 @@ static const struct value_iface_t * identifier_term_enum_return_value(
     const struct single_identifier_term_t *sit = 
 	CONTAINER_OF(self, struct single_identifier_term_t, expression);
 
-    return &(sit->value);
+    return sit->enum_value;
 }
 
-/**************************************************************************/
-/* Value interface                                                        */
-/**************************************************************************/
-static int enum_identifier_value_comparable_to(
-    const struct value_iface_t *self,
-    const struct value_iface_t *other_value,
-    const struct config_iface_t *config,
+static int identifier_term_enum_invariant(
+    struct expression_iface_t *self,
+    struct loop_invariants_t *invariants,
     struct issues_iface_t *issues)
 {
-    if(!other_value->enumeration)
-    {
-	issues->new_issue(
-	    issues,
-	    "the other value cannot be interpreted as an enumerated value",
-	    ESSTEE_TYPE_ERROR);
-
-	return ESSTEE_FALSE;
-    }
-
     return ESSTEE_TRUE;
 }
 
-static int enum_identifier_value_equals(
-    const struct value_iface_t *self,
-    const struct value_iface_t *other_value,
-    const struct config_iface_t *config,
-    struct issues_iface_t *issues)
-{
-    struct single_identifier_term_t *sit =
-	CONTAINER_OF(self, struct single_identifier_term_t, value);
-
-    const struct enum_item_t *other_value_enum =
-	other_value->enumeration(other_value, config, issues);
-    
-    if(strcmp(sit->identifier, other_value_enum->identifier) == 0)
-    {
-	return ESSTEE_TRUE;
-    }
-
-    return ESSTEE_FALSE;
-}
-
-static const struct enum_item_t * enum_identifier_value_enumeration(
-    const struct value_iface_t *self,
-    const struct config_iface_t *config,
-    struct issues_iface_t *issues)
-{
-    struct single_identifier_term_t *sit =
-	CONTAINER_OF(self, struct single_identifier_term_t, value);
-
-    return &(sit->item);
-}
-
-static void enum_identifier_value_destroy(
-    struct value_iface_t *self)
-{
-    /* TODO: inline enum value destructor */
-}
-
 /**************************************************************************/
 /* Linker callbacks                                                       */
 /**************************************************************************/
@@ -164,6 +126,7 @@ static int identifier_variable_resolved(
 {
     struct single_identifier_term_t *sit
 	= (struct single_identifier_term_t *)referrer;
+    char *enum_identifier = NULL;
     
     if(target != NULL)
     {
@@ -171,23 +134,41 @@ static int identifier_variable_resolved(
     }
     else
     {
-	/* Interpret as an inline enum value */
+	/* Interpret as an inline enum value, which owns a copy of the
+	 * identifier. A value from an earlier link is replaced. */
+	if(sit->enum_value)
+	{
+	    sit->enum_value->destroy(sit->enum_value);
+	    sit->enum_value = NULL;
+	}
+
+	STRDUP_OR_ERROR_JUMP(
+	    enum_identifier,
+	    sit->identifier,
+	    issues,
+	    error_free_resources);
+
+	sit->enum_value = st_create_enum_value(enum_identifier,
+					       sit->location,
+					       config,
+					       issues);
+	if(!sit->enum_value)
+	{
+	    goto error_free_resources;
+	}
+
 	sit->variable = NULL;
 	
 	sit->expression.return_value = identifier_term_enum_return_value;
+	sit->expression.invariant = identifier_term_enum_invariant;
 	sit->expression.clone = NULL;
-
-	sit->item.identifier = sit->identifier;
-	sit->item.location = sit->location;
-	
-	memset(&(sit->value), 0, sizeof(struct value_iface_t));
-	sit->value.comparable_to = enum_identifier_value_comparable_to;
-	sit->value.equals = enum_identifier_value_equals;
-	sit->value.enumeration = enum_identifier_value_enumeration;
-	sit->value.destroy = enum_identifier_value_destroy;
     }
 
     return ESSTEE_OK;
+
+error_free_resources:
+    free(enum_identifier);
+    return ESSTEE_ERROR;
 }
 
 /**************************************************************************/
@@ -228,6 +209,7 @@ struct expression_iface_t * st_create_identifier_term(
     }
     
     sit->variable = NULL;
+    sit->enum_value = NULL;
     sit->location = sit_location;
     sit->identifier = identifier;
 
@@ -236,6 +218,7 @@ struct expression_iface_t * st_create_identifier_term(
     sit->expression.invoke.location = sit->location;
     sit->expression.destroy = identifier_term_destroy;
     sit->expression.return_value = identifier_term_variable_return_value;
+    sit->expression.invariant = identifier_term_variable_invariant;
     sit->expression.clone = identifier_term_variable_clone;
 
     return &(sit->expression);
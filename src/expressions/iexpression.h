@@ -23,13 +23,39 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <statements/iinvoke.h>
 #include <util/iissues.h>
 
+struct loop_invariants_t;
+
 struct expression_iface_t {
 
     struct invoke_iface_t invoke;
     
     const struct value_iface_t * (*return_value)(
 	const struct expression_iface_t *self);
+
+    /* Optional, gives the truth of a boolean expression directly as
+     * ESSTEE_TRUE, ESSTEE_FALSE or ESSTEE_ERROR, without the
+     * expression being stepped or its return value written. Only
+     * present when no part of the expression needs stepping. */
+    int (*test)(
+	const struct expression_iface_t *self,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
     
+    /* Optional, present in expressions without side effects. Gives
+     * ESSTEE_TRUE when the expression reads no variable written in
+     * the loop of the invariants. Otherwise the invariant parts of the
+     * expression are hoisted, and ESSTEE_FALSE is given. */
+    int (*invariant)(
+	struct expression_iface_t *self,
+	struct loop_invariants_t *invariants,
+	struct issues_iface_t *issues);
+
+    /* Optional, gives the type the result of the expression is
+     * computed in when the return value is a temporary without a
+     * type, NULL when no operand has a type */
+    const struct type_iface_t * (*result_type)(
+	const struct expression_iface_t *self);
+
     struct expression_iface_t * (*clone)(
 	struct expression_iface_t *self,
 	struct issues_iface_t *issues);
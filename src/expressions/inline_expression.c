@@ -38,6 +38,14 @@ static const struct value_iface_t * value_expression_return_value(
     return ve->value;
 }
 
+static int value_expression_invariant(
+    struct expression_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    return ESSTEE_TRUE;
+}
+
 static void value_expression_destroy(
     struct expression_iface_t *self)
 {
@@ -75,6 +83,7 @@ struct expression_iface_t * st_create_value_expression(
     
     ve->expression.invoke.location = ve->location;    
     ve->expression.return_value = value_expression_return_value;
+    ve->expression.invariant = value_expression_invariant;
     ve->expression.destroy = value_expression_destroy;
 
     return &(ve->expression);
@@ -78,6 +78,35 @@ static int assign_temporary_and_negate(
     return ESSTEE_OK;
 }
 
+static int not_prefix_term_test(
+    const struct expression_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    const struct negative_prefix_term_t *nt =
+	CONTAINER_OF(self, struct negative_prefix_term_t, expression);
+
+    int operand_test;
+    if(nt->to_negate->test)
+    {
+	operand_test = nt->to_negate->test(nt->to_negate, config, issues);
+    }
+    else
+    {
+	const struct value_iface_t *to_negate_value =
+	    nt->to_negate->return_value(nt->to_negate);
+
+	operand_test = to_negate_value->bool(to_negate_value, config, issues);
+    }
+
+    if(operand_test == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return (operand_test == ESSTEE_TRUE) ? ESSTEE_FALSE : ESSTEE_TRUE;
+}
+
 static int negative_prefix_term_verify(
     struct invoke_iface_t *self,
     const struct config_iface_t *config,
@@ -117,6 +146,15 @@ static int negative_prefix_term_verify(
 
 	return ESSTEE_ERROR;
     }
+
+    /* A boolean not, of an operand that can be tested, is tested
+     * directly by conditions */
+    if(nt->operation_offset == offsetof(struct value_iface_t, not)
+       && to_negate_value->bool
+       && (nt->to_negate->test || !nt->to_negate->invoke.step))
+    {
+	nt->expression.test = not_prefix_term_test;
+    }
         
     return ESSTEE_OK;
 }
@@ -159,12 +197,15 @@ static int negative_prefix_term_step(
     switch(nt->invoke_state)
     {
     case 0:
-	nt->invoke_state = 1;
-	cursor->switch_current(cursor,
-			       &(nt->to_negate->invoke),
-			       config,
-			       issues);
-	return INVOKE_RESULT_IN_PROGRESS;
+	if(nt->to_negate->invoke.step)
+	{
+	    nt->invoke_state = 1;
+	    cursor->switch_current(cursor,
+				   &(nt->to_negate->invoke),
+				   config,
+				   issues);
+	    return INVOKE_RESULT_IN_PROGRESS;
+	}
 
     case 1:
 	if(assign_temporary_and_negate(nt, config, issues) == ESSTEE_ERROR)
@@ -212,6 +253,34 @@ static const struct value_iface_t * negative_prefix_term_return_value(
     return nt->temporary;
 }
 
+static const struct type_iface_t * negative_prefix_term_result_type(
+    const struct expression_iface_t *self)
+{
+    const struct negative_prefix_term_t *nt =
+	CONTAINER_OF(self, struct negative_prefix_term_t, expression);
+
+    const struct value_iface_t *to_negate_value =
+	nt->to_negate->return_value(nt->to_negate);
+
+    if(to_negate_value && to_negate_value->type_of)
+    {
+	const struct type_iface_t *to_negate_type =
+	    to_negate_value->type_of(to_negate_value);
+
+	if(to_negate_type)
+	{
+	    return to_negate_type;
+	}
+    }
+
+    if(nt->to_negate->result_type)
+    {
+	return nt->to_negate->result_type(nt->to_negate);
+    }
+
+    return NULL;
+}
+
 static int negative_prefix_term_allocate(
     struct invoke_iface_t *self,
     struct issues_iface_t *issues)
@@ -270,6 +339,22 @@ void negative_prefix_term_clone_destroy(
     /* TODO: destructor */
 }
 
+static int negative_prefix_term_invariant(
+    struct expression_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct negative_prefix_term_t *nt =
+	CONTAINER_OF(self, struct negative_prefix_term_t, expression);
+
+    if(!nt->to_negate->invariant)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    return nt->to_negate->invariant(nt->to_negate, invariants, issues);
+}
+
 static struct expression_iface_t * negative_prefix_term_clone(
     struct expression_iface_t *self,
     struct issues_iface_t *issues)
@@ -364,6 +449,8 @@ static struct expression_iface_t * create_negative_prefix_term(
     nt->expression.invoke.location = nt->location;
     nt->expression.invoke.allocate = negative_prefix_term_allocate;
     nt->expression.return_value = negative_prefix_term_return_value;
+    nt->expression.invariant = negative_prefix_term_invariant;
+    nt->expression.result_type = negative_prefix_term_result_type;
     nt->expression.destroy = negative_prefix_term_destroy;
 
     return &(nt->expression);
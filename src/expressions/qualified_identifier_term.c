@@ -19,6 +19,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <expressions/qualified_identifier_term.h>
 #include <util/macros.h>
+#include <statements/invariants.h>
 
 /**************************************************************************/
 /* Expression interface                                                   */
@@ -100,6 +101,38 @@ static const struct value_iface_t * qualified_identifier_term_return_value(
     return qit->qid->target_value(qit->qid);
 }
 
+static int qualified_identifier_term_invariant(
+    struct expression_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct qualified_identifier_term_t *qit
+	= CONTAINER_OF(self, struct qualified_identifier_term_t, expression);
+
+    int indices_invariant = qit->qid->invariant_indices(qit->qid,
+							invariants,
+							issues);
+    if(indices_invariant != ESSTEE_TRUE)
+    {
+	return indices_invariant;
+    }
+
+    const struct variable_iface_t *base = qit->qid->base_variable(qit->qid);
+    if(st_loop_invariants_written(invariants, base) != ESSTEE_TRUE)
+    {
+	return ESSTEE_TRUE;
+    }
+
+    /* The value of the target changes in the loop, but the path
+     * resolves to the same target, which the return value refers to */
+    if(st_loop_invariants_hoist(invariants, self, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_FALSE;
+}
+
 static struct expression_iface_t * qualified_identifier_term_clone(
     struct expression_iface_t *self,
     struct issues_iface_t *issues)
@@ -175,6 +208,7 @@ struct expression_iface_t * st_create_qualified_identifier_term(
 
     qt->expression.invoke.location = qt->location;
     qt->expression.return_value = qualified_identifier_term_return_value;
+    qt->expression.invariant = qualified_identifier_term_invariant;
     qt->expression.destroy = qualified_identifier_term_destroy;
     qt->expression.clone = qualified_identifier_term_clone;
 
@@ -370,6 +370,11 @@ query :
     if(($$ = st_new_query_by_qualified_identifier($2, &@2, $5, $7, parser)) == NULL)
     	DO_ERROR_STRATEGY(parser);
 }
+| '?' expression
+{
+    if(($$ = st_new_query_by_condition($2, parser)) == NULL)
+    	DO_ERROR_STRATEGY(parser);
+}
 ;
 
 pous :
@@ -836,12 +841,12 @@ string_defined_length :
 string_defined_length_type :
 STRING_TYPE_NAME string_defined_length
 {
-    if(($$ = st_new_string_type($1, $2, &@2, NULL, parser)) == NULL)
+    if(($$ = st_new_string_type($1, $2, &@2, NULL, NULL, parser)) == NULL)
 	DO_ERROR_STRATEGY(parser);
 }
 | STRING_TYPE_NAME string_defined_length ASSIGN literal
 {
-    if(($$ = st_new_string_type($1, $2, &@2, $4, parser)) == NULL)
+    if(($$ = st_new_string_type($1, $2, &@2, $4, &@4, parser)) == NULL)
 	DO_ERROR_STRATEGY(parser);
 }
 ;
@@ -118,39 +118,17 @@ int st_reset_parser_next_pou(
 void st_destroy_compilation_unit(
     struct compilation_unit_t *cu)
 {
-    /* TODO: destructor for compilation unit */
+    free(cu->text);
+    /* TODO: destructor for the elements of the compilation unit */
 }
 
-struct compilation_unit_t * st_parse_file(
-    const char *path,
+static struct compilation_unit_t * parse_compilation_unit(
+    const char *source,
+    YY_BUFFER_STATE yy_buffer,
     struct parser_t *parser)
 {
-    if(reset_parser(parser) != ESSTEE_OK)
-    {
-	return NULL;
-    }
-    
-    FILE *fp = NULL;
-    YY_BUFFER_STATE yy_buffer = NULL;
     struct compilation_unit_t *cu = NULL;
     char *source_path = NULL;
-    
-    fp = fopen(path, "r");
-    if(!fp)
-    {
-	parser->errors->new_issue(parser->errors,
-				  "unable to open file '%s'",
-				  ESSTEE_IO_ERROR,
-				  path);
-	return NULL;
-    }
-
-    parser->scanner_options.query_mode_start = 0;
-    yy_buffer = yy_create_buffer(fp, YY_BUF_SIZE, parser->yyscanner);
-    if(!yy_buffer)
-    {
-	goto error_free_resources;
-    }
 
     ALLOC_OR_ERROR_JUMP(
 	cu,
@@ -160,7 +138,7 @@ struct compilation_unit_t * st_parse_file(
 
     STRDUP_OR_ERROR_JUMP(
 	source_path,
-	path,
+	source,
 	parser->errors,
 	error_free_resources);
 
@@ -174,6 +152,8 @@ struct compilation_unit_t * st_parse_file(
     }
 
     cu->source = source_path;
+    cu->text = NULL;
+    cu->text_size = 0;
     cu->global_types = parser->global_types;
     cu->global_variables = parser->global_variables;
     cu->functions = parser->functions;
@@ -187,21 +167,119 @@ struct compilation_unit_t * st_parse_file(
     parser->global_type_ref_pool = NULL;
     parser->global_var_ref_pool = NULL;
     parser->function_ref_pool = NULL;
-    
-    fclose(fp);
-    yy_delete_buffer(yy_buffer, parser->yyscanner);
 
     return cu;
-    
+
 error_free_resources:
-    fclose(fp);
-    yy_delete_buffer(yy_buffer, parser->yyscanner);
     free(cu);
     free(source_path);
+    return NULL;
+}
 
+static char * read_source_file(
+    const char *path,
+    size_t *text_size,
+    struct issues_iface_t *issues)
+{
+    char *text = NULL;
+    size_t allocated = 0;
+    size_t used = 0;
+    
+    FILE *fp = fopen(path, "r");
+    if(!fp)
+    {
+	issues->new_issue(issues,
+			  "unable to open file '%s'",
+			  ESSTEE_IO_ERROR,
+			  path);
+	return NULL;
+    }
+
+    for(;;)
+    {
+	if(allocated - used < BUFSIZ)
+	{
+	    allocated += (allocated > 0) ? allocated : 4*BUFSIZ;
+	    char *grown = (char *)realloc(text, allocated);
+	    if(!grown)
+	    {
+		issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+		goto error_free_resources;
+	    }
+	    text = grown;
+	}
+
+	size_t bytes_read = fread(text + used, 1, allocated - used - 2, fp);
+	used += bytes_read;
+
+	if(bytes_read == 0)
+	{
+	    break;
+	}
+    }
+
+    if(ferror(fp))
+    {
+	issues->new_issue(issues,
+			  "unable to read file '%s'",
+			  ESSTEE_IO_ERROR,
+			  path);
+	goto error_free_resources;
+    }
+
+    /* Terminate with two NULs, the end of buffer marker of the scanner */
+    text[used] = '\0';
+    text[used+1] = '\0';
+    *text_size = used;
+
+    fclose(fp);
+    return text;
+    
+error_free_resources:
+    fclose(fp);
+    free(text);
     return NULL;
 }
 
+struct compilation_unit_t * st_parse_file(
+    const char *path,
+    struct parser_t *parser)
+{
+    if(reset_parser(parser) != ESSTEE_OK)
+    {
+	return NULL;
+    }
+
+    size_t text_size = 0;
+    char *text = read_source_file(path, &text_size, parser->errors);
+    if(!text)
+    {
+	return NULL;
+    }
+
+    parser->scanner_options.query_mode_start = 0;
+    YY_BUFFER_STATE yy_buffer = yy_scan_buffer(text, text_size + 2, parser->yyscanner);
+    if(!yy_buffer)
+    {
+	free(text);
+	return NULL;
+    }
+
+    struct compilation_unit_t *cu = parse_compilation_unit(path, yy_buffer, parser);
+    yy_delete_buffer(yy_buffer, parser->yyscanner);
+
+    /* The unit keeps the text, for clones of the instance to parse */
+    if(!cu)
+    {
+	free(text);
+	return NULL;
+    }
+    cu->text = text;
+    cu->text_size = text_size;
+
+    return cu;
+}
+
 struct queries_iface_t * st_parse_query_string(
     const char *query_string,
     struct parser_t *parser)
@@ -227,10 +305,70 @@ struct queries_iface_t * st_parse_query_string(
 
 struct compilation_unit_t * st_parse_buffer(
     const char *virtual_path,
-    const char *buffer,
+    char *buffer,
     size_t buffer_size,
     struct parser_t *parser)
 {
-    /* TODO: parse buffer */
+    if(reset_parser(parser) != ESSTEE_OK)
+    {
+	return NULL;
+    }
+
+    char *text = NULL;
+    size_t text_size = 0;
+    
+    /* A buffer ending with two NULs is scanned in place, anything
+     * else is copied into a terminated buffer first */
+    if(buffer_size >= 2 && buffer[buffer_size-2] == '\0' && buffer[buffer_size-1] == '\0')
+    {
+	text = buffer;
+	text_size = buffer_size - 2;
+    }
+    else
+    {
+	ALLOC_ARRAY_OR_ERROR_JUMP(
+	    text,
+	    char,
+	    buffer_size + 2,
+	    parser->errors,
+	    error_free_resources);
+
+	memcpy(text, buffer, buffer_size);
+	text[buffer_size] = '\0';
+	text[buffer_size+1] = '\0';
+	text_size = buffer_size;
+    }
+
+    parser->scanner_options.query_mode_start = 0;
+    YY_BUFFER_STATE yy_buffer = yy_scan_buffer(text, text_size + 2, parser->yyscanner);
+    if(!yy_buffer)
+    {
+	goto error_free_resources;
+    }
+
+    struct compilation_unit_t *cu = parse_compilation_unit(virtual_path,
+							   yy_buffer,
+							   parser);
+    yy_delete_buffer(yy_buffer, parser->yyscanner);
+
+    if(!cu)
+    {
+	goto error_free_resources;
+    }
+
+    /* A copy is kept by the unit, the buffer belongs to the caller */
+    if(text != buffer)
+    {
+	cu->text = text;
+	cu->text_size = text_size;
+    }
+
+    return cu;
+
+error_free_resources:
+    if(text != buffer)
+    {
+	free(text);
+    }
     return NULL;
 }
@@ -74,6 +74,8 @@ struct parser_t {
 
 struct compilation_unit_t {
     const char *source;
+    char *text;			/* Copy of the source text, NULL when scanned in place */
+    size_t text_size;
 
     struct type_iface_t *global_types; /* List of defined global types */
     struct variable_iface_t *global_variables; /* List of degined global variables */
@@ -100,7 +102,7 @@ struct compilation_unit_t * st_parse_file(
 
 struct compilation_unit_t * st_parse_buffer(
     const char *virtual_path,
-    const char *buffer,
+    char *buffer,
     size_t buffer_size,
     struct parser_t *parser);
 
@@ -131,6 +133,10 @@ struct query_t * st_new_query_by_qualified_identifier(
     struct expression_iface_t *assigned,
     struct parser_t *parser);
 
+struct query_t * st_new_query_by_condition(
+    struct expression_iface_t *condition,
+    struct parser_t *parser);
+
 int st_append_query(
     struct query_t *query,
     struct parser_t *parser);
@@ -312,6 +318,7 @@ struct type_iface_t * st_new_string_type(
     struct value_iface_t *length,
     const struct st_location_t *length_location,
     struct value_iface_t *default_value,
+    const struct st_location_t *default_value_location,
     struct parser_t *parser);
 
 /**************************************************************************/
@@ -28,6 +28,29 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <string.h>
 #include <errno.h>
 
+/* Parts of duration, date and time of day literals as written, the
+ * values are normalized when created */
+struct duration_t {
+    double d;
+    double h;
+    double m;
+    double s;
+    double ms;
+};
+
+struct date_t {
+    uint64_t y;
+    uint8_t m;
+    uint8_t d;
+};
+
+struct tod_t {
+    uint8_t h;
+    uint8_t m;
+    uint8_t s;
+    uint8_t fs;
+};
+
 
 static char * strip_underscores(char *string)
 {	
@@ -441,7 +464,7 @@ struct value_iface_t * st_new_duration_literal(
     char defined = 0x00;
     char fractions = 0x00;
     unsigned parts_defined = 0;
-    struct duration_t duration;
+    struct duration_t duration = { 0.0, 0.0, 0.0, 0.0, 0.0 };
     
     strip_underscores(string);
     if(find_start(string, &(work_buffer)) == ESSTEE_ERROR)
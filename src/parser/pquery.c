@@ -100,6 +100,23 @@ struct query_t * st_new_query_by_qualified_identifier(
     return query;
 }
 
+struct query_t * st_new_query_by_condition(
+    struct expression_iface_t *condition,
+    struct parser_t *parser)
+{
+    struct query_t *query = st_create_condition_query(
+	condition,
+	parser->config,
+	parser->errors);
+
+    if(!query)
+    {
+	condition->destroy(condition);
+    }
+
+    return query;
+}
+
 int st_append_query(
     struct query_t *query,
     struct parser_t *parser)
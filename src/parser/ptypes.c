@@ -209,6 +209,7 @@ struct type_iface_t * st_new_string_type(
     struct value_iface_t *length,
     const struct st_location_t *length_location,
     struct value_iface_t *default_value,
+    const struct st_location_t *default_value_location,
     struct parser_t *parser)
 {
     struct type_iface_t *ns = st_new_custom_length_string_type(
@@ -216,13 +217,17 @@ struct type_iface_t * st_new_string_type(
 	length,
 	length_location,
 	default_value,
+	default_value_location,
 	parser->config,
 	parser->errors);
 
     if(!ns)
     {
 	length->destroy(length);
-	default_value->destroy(default_value);
+	if(default_value)
+	{
+	    default_value->destroy(default_value);
+	}
     }
 	
     return ns;
@@ -0,0 +1,578 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Breakpoints are looked up by line first, so checking a location
+ * without a breakpoint on its line is a single table lookup. Conditions
+ * are compiled queries, stepped on a cursor of their own to leave the
+ * position of the program untouched. Watchpoints are watches of their
+ * variables, a write only flags the watchpoint, its condition is
+ * tested once the step doing the write is done. */
+
+#include <rt/breakpoints.h>
+#include <rt/cursor.h>
+#include <util/macros.h>
+#include <esstee/flags.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <utlist.h>
+#include <uthash.h>
+
+struct breakpoint_t {
+    char *source;
+    struct queries_iface_t *condition;
+    struct breakpoint_t *prev;
+    struct breakpoint_t *next;
+};
+
+struct breakpoint_line_t {
+    int line;
+    struct breakpoint_t *breakpoints;
+    UT_hash_handle hh;
+};
+
+struct breakpoints_t;
+
+struct watchpoint_t {
+    struct variable_watch_t watch;
+    struct breakpoints_t *owner;
+    char *identifier;
+    struct variable_iface_t *variable;
+    const struct value_iface_t *whole;
+    const struct value_iface_t *element;
+    struct queries_iface_t *condition;
+    int written;
+    UT_hash_handle hh;
+};
+
+struct breakpoints_t {
+    struct breakpoints_iface_t breakpoints;
+    struct breakpoint_line_t *lines;
+    struct watchpoint_t *watchpoints; /* Table by identifier */
+    struct cursor_iface_t *condition_cursor;
+    size_t count;
+    size_t pending;		/* Written watchpoints */
+};
+
+/**************************************************************************/
+/* Help functions                                                         */
+/**************************************************************************/
+static int same_source(
+    const char *source,
+    const char *other_source)
+{
+    if(!source || !other_source)
+    {
+	return (source == other_source) ? ESSTEE_TRUE : ESSTEE_FALSE;
+    }
+
+    return (strcmp(source, other_source) == 0) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+static struct breakpoint_t * find_breakpoint(
+    struct breakpoint_line_t *bl,
+    const char *source)
+{
+    struct breakpoint_t *itr = NULL;
+    DL_FOREACH(bl->breakpoints, itr)
+    {
+	if(same_source(itr->source, source) == ESSTEE_TRUE)
+	{
+	    return itr;
+	}
+    }
+
+    return NULL;
+}
+
+static void free_breakpoint(
+    struct breakpoint_t *bp)
+{
+    if(bp->condition)
+    {
+	bp->condition->destroy(bp->condition);
+    }
+    free(bp->source);
+    free(bp);
+}
+
+static void watchpoint_modified(
+    struct variable_watch_t *self,
+    const struct value_iface_t *written)
+{
+    struct watchpoint_t *wp =
+	CONTAINER_OF(self, struct watchpoint_t, watch);
+
+    if(wp->written)
+    {
+	return;
+    }
+
+    if(!wp->element || written == wp->element || written == wp->whole)
+    {
+	wp->written = 1;
+	wp->owner->pending++;
+    }
+}
+
+static void free_watchpoint(
+    struct watchpoint_t *wp)
+{
+    wp->variable->remove_watch(wp->variable, &(wp->watch));
+    if(wp->condition)
+    {
+	wp->condition->destroy(wp->condition);
+    }
+    free(wp->identifier);
+    free(wp);
+}
+
+/**************************************************************************/
+/* Breakpoints interface                                                  */
+/**************************************************************************/
+static int breakpoints_set(
+    struct breakpoints_iface_t *self,
+    const char *source,
+    int line,
+    struct queries_iface_t *condition,
+    struct issues_iface_t *issues)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    struct breakpoint_line_t *bl = NULL;
+    struct breakpoint_t *bp = NULL;
+    
+    HASH_FIND_INT(bps->lines, &line, bl);
+    if(bl)
+    {
+	bp = find_breakpoint(bl, source);
+	if(bp)
+	{
+	    if(bp->condition)
+	    {
+		bp->condition->destroy(bp->condition);
+	    }
+	    bp->condition = condition;
+	    return ESSTEE_OK;
+	}
+    }
+
+    ALLOC_OR_ERROR_JUMP(
+	bp,
+	struct breakpoint_t,
+	issues,
+	error_free_resources);
+
+    bp->source = NULL;
+    bp->condition = condition;
+    
+    if(source)
+    {
+	bp->source = strdup(source);
+	if(!bp->source)
+	{
+	    issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	    goto error_free_resources;
+	}
+    }
+
+    if(!bl)
+    {
+	ALLOC_OR_ERROR_JUMP(
+	    bl,
+	    struct breakpoint_line_t,
+	    issues,
+	    error_free_resources);
+
+	bl->line = line;
+	bl->breakpoints = NULL;
+	HASH_ADD_INT(bps->lines, line, bl);
+    }
+
+    DL_APPEND(bl->breakpoints, bp);
+    bps->count++;
+
+    return ESSTEE_OK;
+
+error_free_resources:
+    if(bp)
+    {
+	free(bp->source);
+    }
+    free(bp);
+    return ESSTEE_ERROR;
+}
+
+static int breakpoints_clear(
+    struct breakpoints_iface_t *self,
+    const char *source,
+    int line,
+    struct issues_iface_t *issues)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    struct breakpoint_line_t *bl = NULL;
+    struct breakpoint_t *bp = NULL;
+    
+    HASH_FIND_INT(bps->lines, &line, bl);
+    if(bl)
+    {
+	bp = find_breakpoint(bl, source);
+    }
+
+    if(!bp)
+    {
+	issues->new_issue(issues,
+			  "no breakpoint set at line %d",
+			  ESSTEE_ARGUMENT_ERROR,
+			  line);
+	return ESSTEE_ERROR;
+    }
+
+    DL_DELETE(bl->breakpoints, bp);
+    free_breakpoint(bp);
+    bps->count--;
+
+    if(!bl->breakpoints)
+    {
+	HASH_DEL(bps->lines, bl);
+	free(bl);
+    }
+
+    return ESSTEE_OK;
+}
+
+static void breakpoints_clear_all(
+    struct breakpoints_iface_t *self)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    struct breakpoint_line_t *litr = NULL, *ltmp = NULL;
+    HASH_ITER(hh, bps->lines, litr, ltmp)
+    {
+	struct breakpoint_t *bitr = NULL, *btmp = NULL;
+	DL_FOREACH_SAFE(litr->breakpoints, bitr, btmp)
+	{
+	    DL_DELETE(litr->breakpoints, bitr);
+	    free_breakpoint(bitr);
+	}
+
+	HASH_DEL(bps->lines, litr);
+	free(litr);
+    }
+
+    struct watchpoint_t *witr = NULL, *wtmp = NULL;
+    HASH_ITER(hh, bps->watchpoints, witr, wtmp)
+    {
+	HASH_DEL(bps->watchpoints, witr);
+	free_watchpoint(witr);
+    }
+
+    bps->count = 0;
+    bps->pending = 0;
+}
+
+static int breakpoints_watch(
+    struct breakpoints_iface_t *self,
+    const char *identifier,
+    struct variable_iface_t *variable,
+    const struct value_iface_t *element,
+    struct queries_iface_t *condition,
+    struct issues_iface_t *issues)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    struct watchpoint_t *wp = NULL;
+    HASH_FIND_STR(bps->watchpoints, identifier, wp);
+    if(wp)
+    {
+	issues->new_issue(issues,
+			  "a watchpoint is already set on '%s'",
+			  ESSTEE_ARGUMENT_ERROR,
+			  identifier);
+	return ESSTEE_ERROR;
+    }
+
+    if(!variable->add_watch)
+    {
+	issues->new_issue(issues,
+			  "variable '%s' cannot be watched",
+			  ESSTEE_ARGUMENT_ERROR,
+			  identifier);
+	return ESSTEE_ERROR;
+    }
+    
+    ALLOC_OR_ERROR_JUMP(
+	wp,
+	struct watchpoint_t,
+	issues,
+	error_free_resources);
+
+    wp->identifier = strdup(identifier);
+    if(!wp->identifier)
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
+
+    wp->watch.modified = watchpoint_modified;
+    wp->watch.next = NULL;
+    wp->owner = bps;
+    wp->variable = variable;
+    wp->whole = variable->value(variable);
+    wp->element = element;
+    wp->condition = condition;
+    wp->written = 0;
+
+    variable->add_watch(variable, &(wp->watch));
+    HASH_ADD_KEYPTR(hh,
+		    bps->watchpoints,
+		    wp->identifier,
+		    strlen(wp->identifier),
+		    wp);
+    bps->count++;
+
+    return ESSTEE_OK;
+
+error_free_resources:
+    free(wp);
+    return ESSTEE_ERROR;
+}
+
+static int breakpoints_unwatch(
+    struct breakpoints_iface_t *self,
+    const char *identifier,
+    struct issues_iface_t *issues)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    struct watchpoint_t *wp = NULL;
+    HASH_FIND_STR(bps->watchpoints, identifier, wp);
+    if(!wp)
+    {
+	issues->new_issue(issues,
+			  "no watchpoint set on '%s'",
+			  ESSTEE_ARGUMENT_ERROR,
+			  identifier);
+	return ESSTEE_ERROR;
+    }
+
+    if(wp->written)
+    {
+	bps->pending--;
+    }
+    
+    HASH_DEL(bps->watchpoints, wp);
+    free_watchpoint(wp);
+    bps->count--;
+
+    return ESSTEE_OK;
+}
+
+static size_t breakpoints_count(
+    const struct breakpoints_iface_t *self)
+{
+    const struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    return bps->count;
+}
+
+static size_t breakpoints_watchpoints(
+    const struct breakpoints_iface_t *self)
+{
+    const struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    return HASH_COUNT(bps->watchpoints);
+}
+
+static int breakpoints_hit(
+    struct breakpoints_iface_t *self,
+    const struct st_location_t *location,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    if(!location)
+    {
+	return ESSTEE_FALSE;
+    }
+    
+    struct breakpoint_line_t *bl = NULL;
+    HASH_FIND_INT(bps->lines, &(location->first_line), bl);
+    if(!bl)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    struct breakpoint_t *itr = NULL;
+    DL_FOREACH(bl->breakpoints, itr)
+    {
+	if(itr->source && same_source(itr->source, location->source) != ESSTEE_TRUE)
+	{
+	    continue;
+	}
+
+	if(!itr->condition)
+	{
+	    return ESSTEE_TRUE;
+	}
+
+	int test_result = itr->condition->test(itr->condition,
+					       bps->condition_cursor,
+					       systime,
+					       config,
+					       issues);
+	if(test_result != ESSTEE_FALSE)
+	{
+	    return test_result;
+	}
+    }
+
+    return ESSTEE_FALSE;
+}
+
+static int breakpoints_written(
+    struct breakpoints_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    if(bps->pending == 0)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    int written_result = ESSTEE_FALSE;
+    
+    struct watchpoint_t *itr = NULL;
+    for(itr = bps->watchpoints; itr != NULL; itr = itr->hh.next)
+    {
+	if(!itr->written)
+	{
+	    continue;
+	}
+	itr->written = 0;
+
+	if(written_result != ESSTEE_FALSE)
+	{
+	    continue;
+	}
+	
+	if(!itr->condition)
+	{
+	    written_result = ESSTEE_TRUE;
+	}
+	else
+	{
+	    written_result = itr->condition->test(itr->condition,
+						  bps->condition_cursor,
+						  systime,
+						  config,
+						  issues);
+	}
+    }
+
+    bps->pending = 0;
+    
+    return written_result;
+}
+
+static void breakpoints_forget_writes(
+    struct breakpoints_iface_t *self)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    struct watchpoint_t *itr = NULL;
+    for(itr = bps->watchpoints; itr != NULL; itr = itr->hh.next)
+    {
+	itr->written = 0;
+    }
+
+    bps->pending = 0;
+}
+
+static void breakpoints_destroy(
+    struct breakpoints_iface_t *self)
+{
+    struct breakpoints_t *bps =
+	CONTAINER_OF(self, struct breakpoints_t, breakpoints);
+
+    breakpoints_clear_all(self);
+    bps->condition_cursor->destroy(bps->condition_cursor);
+    free(bps);
+}
+
+/**************************************************************************/
+/* Public interface                                                       */
+/**************************************************************************/
+struct breakpoints_iface_t * st_new_breakpoints(
+    struct issues_iface_t *issues)
+{
+    struct breakpoints_t *bps = NULL;
+
+    ALLOC_OR_ERROR_JUMP(
+	bps,
+	struct breakpoints_t,
+	issues,
+	error_free_resources);
+
+    bps->lines = NULL;
+    bps->watchpoints = NULL;
+    bps->count = 0;
+    bps->pending = 0;
+    bps->condition_cursor = st_new_cursor();
+    if(!bps->condition_cursor)
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
+
+    bps->breakpoints.set = breakpoints_set;
+    bps->breakpoints.clear = breakpoints_clear;
+    bps->breakpoints.clear_all = breakpoints_clear_all;
+    bps->breakpoints.watch = breakpoints_watch;
+    bps->breakpoints.unwatch = breakpoints_unwatch;
+    bps->breakpoints.count = breakpoints_count;
+    bps->breakpoints.watchpoints = breakpoints_watchpoints;
+    bps->breakpoints.hit = breakpoints_hit;
+    bps->breakpoints.written = breakpoints_written;
+    bps->breakpoints.forget_writes = breakpoints_forget_writes;
+    bps->breakpoints.destroy = breakpoints_destroy;
+
+    return &(bps->breakpoints);
+
+error_free_resources:
+    free(bps);
+    return NULL;
+}
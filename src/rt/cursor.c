@@ -18,6 +18,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <rt/cursor.h>
+#include <rt/ibreakpoints.h>
 #include <statements/iinvoke.h>
 #include <util/iconfig.h>
 #include <util/iissues.h>
@@ -25,6 +26,11 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <utlist.h>
 #include <stdlib.h>
+#include <time.h>
+#include <inttypes.h>
+
+/* The clock is only read every this many steps */
+#define WATCHDOG_TIME_CHECK_INTERVAL 1024
 
 struct cursor_t {
     struct cursor_iface_t cursor;
@@ -33,8 +39,89 @@ struct cursor_t {
     struct invoke_iface_t *return_context;
     struct invoke_iface_t *current;
     struct invoke_iface_t *cycle_start;
+    struct profiler_iface_t *profiler;
+    uint64_t max_steps;
+    uint64_t max_time_ns;
+    uint64_t steps;
+    uint64_t next_watchdog_check; /* Step count of the next check */
+    struct timespec armed;
 };
 
+static void schedule_watchdog_check(
+    struct cursor_t *cur)
+{
+    cur->next_watchdog_check = UINT64_MAX;
+
+    if(cur->max_steps > 0)
+    {
+	cur->next_watchdog_check = cur->max_steps + 1;
+    }
+
+    if(cur->max_time_ns > 0
+       && cur->steps + WATCHDOG_TIME_CHECK_INTERVAL < cur->next_watchdog_check)
+    {
+	cur->next_watchdog_check = cur->steps + WATCHDOG_TIME_CHECK_INTERVAL;
+    }
+}
+
+static int watchdog_expired(
+    struct cursor_t *cur,
+    struct issues_iface_t *issues)
+{
+    const char *message = NULL;
+    
+    if(cur->max_steps > 0 && cur->steps > cur->max_steps)
+    {
+	message = issues->build_message(
+	    issues,
+	    "cycle aborted, the limit of %" PRIu64 " steps was exceeded",
+	    cur->max_steps);
+    }
+    else if(cur->max_time_ns > 0)
+    {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	uint64_t time_ns = (now.tv_sec - cur->armed.tv_sec) * 1000000000ULL
+	    + now.tv_nsec - cur->armed.tv_nsec;
+
+	if(time_ns > cur->max_time_ns)
+	{
+	    message = issues->build_message(
+		issues,
+		"cycle aborted, the time limit of %" PRIu64 " us was exceeded",
+		cur->max_time_ns / 1000);
+	}
+    }
+
+    if(!message)
+    {
+	schedule_watchdog_check(cur);
+	return ESSTEE_FALSE;
+    }
+
+    /* Let a resumed cycle run on until the watchdog is armed again */
+    cur->next_watchdog_check = UINT64_MAX;
+    
+    issues->new_issue_at(
+	issues,
+	message,
+	ESSTEE_RUNTIME_ERROR,
+	1,
+	cur->current->location);
+
+    return ESSTEE_TRUE;
+}
+
+static void restart_cycle(
+    struct cursor_t *cur,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    cur->cycle_start->reset(cur->cycle_start, config, issues);
+    cur->current = cur->cycle_start;
+}
+
 static void set_current_to_next(
     struct cursor_t *cur,
     const struct config_iface_t *config,
@@ -50,7 +137,7 @@ static void set_current_to_next(
 	if(cur->call_stack == NULL)
 	{
 	    /* Cycle complete */
-	    cur->current = cur->cycle_start;
+	    restart_cycle(cur, config, issues);
 	}
 	else
 	{
@@ -67,11 +154,57 @@ static void set_current_to_next(
     }
 }
 
-static struct invoke_iface_t * cursor_step(
+/* Steps the current invoke, timing it if profiling. The profiler is
+ * given as a constant NULL by the unprofiled cursor functions, so the
+ * profiling code is folded away in them */
+static inline int step_current(
+    struct cursor_t *cur,
     struct cursor_iface_t *self,
     struct systime_iface_t *systime,
     const struct config_iface_t *config,
-    struct issues_iface_t *issues)
+    struct issues_iface_t *issues,
+    struct profiler_iface_t *profiler)
+{
+    struct invoke_iface_t *invoke = cur->current;
+
+    if(++cur->steps >= cur->next_watchdog_check
+       && watchdog_expired(cur, issues) == ESSTEE_TRUE)
+    {
+	return INVOKE_RESULT_ERROR;
+    }
+    
+    if(!profiler)
+    {
+	return invoke->step(invoke, self, systime, config, issues);
+    }
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int invoke_result = invoke->step(invoke, self, systime, config, issues);
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    uint64_t time_ns = (stop.tv_sec - start.tv_sec) * 1000000000ULL
+	+ stop.tv_nsec - start.tv_nsec;
+    
+    profiler->record_step(profiler, invoke, time_ns, issues);
+
+    /* The invoke switched the cursor to something it called */
+    if(cur->call_stack == invoke && cur->current != invoke)
+    {
+	profiler->record_call(profiler, invoke, cur->current, issues);
+    }
+
+    return invoke_result;
+}
+
+static inline struct invoke_iface_t * step(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues,
+    struct profiler_iface_t *profiler)
 {
     struct cursor_t *cur =
 	CONTAINER_OF(self, struct cursor_t, cursor);
@@ -86,11 +219,12 @@ static struct invoke_iface_t * cursor_step(
     
     do
     {
-	int invoke_result = cur->current->step(cur->current,
-					       self,
-					       systime,
-					       config,
-					       issues);
+	int invoke_result = step_current(cur,
+					 self,
+					 systime,
+					 config,
+					 issues,
+					 profiler);
 
 	if(cur->current == start)
 	{
@@ -103,7 +237,7 @@ static struct invoke_iface_t * cursor_step(
 	}
 	else if(invoke_result == INVOKE_RESULT_ALL_FINISHED)
 	{
-	    cur->current = cur->cycle_start;
+	    restart_cycle(cur, config, issues);
 	    break;
 	}
 	else if(invoke_result == INVOKE_RESULT_FINISHED)
@@ -116,20 +250,22 @@ static struct invoke_iface_t * cursor_step(
     return cur->current;
 }
 
-static struct invoke_iface_t * cursor_step_in(
+static inline struct invoke_iface_t * step_in(
     struct cursor_iface_t *self,
     struct systime_iface_t *systime,
     const struct config_iface_t *config,
-    struct issues_iface_t *issues)
+    struct issues_iface_t *issues,
+    struct profiler_iface_t *profiler)
 {
     struct cursor_t *cur =
 	CONTAINER_OF(self, struct cursor_t, cursor);
 
-    int invoke_result = cur->current->step(cur->current,
-					   self,
-					   systime,
-					   config,
-					   issues);
+    int invoke_result = step_current(cur,
+				     self,
+				     systime,
+				     config,
+				     issues,
+				     profiler);
 
     if(invoke_result == INVOKE_RESULT_ERROR)
     {
@@ -137,7 +273,7 @@ static struct invoke_iface_t * cursor_step_in(
     }
     else if(invoke_result == INVOKE_RESULT_ALL_FINISHED)
     {
-	cur->current = cur->cycle_start;
+	restart_cycle(cur, config, issues);
     }
     else if(invoke_result == INVOKE_RESULT_FINISHED)
     {
@@ -147,11 +283,12 @@ static struct invoke_iface_t * cursor_step_in(
     return cur->current;
 }
 
-static struct invoke_iface_t * cursor_step_out(
+static inline struct invoke_iface_t * step_out(
     struct cursor_iface_t *self,
     struct systime_iface_t *systime,
     const struct config_iface_t *config,
-    struct issues_iface_t *issues)
+    struct issues_iface_t *issues,
+    struct profiler_iface_t *profiler)
 {
     struct cursor_t *cur =
 	CONTAINER_OF(self, struct cursor_t, cursor);
@@ -168,11 +305,12 @@ static struct invoke_iface_t * cursor_step_out(
 	
 	do
 	{
-	    int invoke_result = cur->current->step(cur->current,
-						   self,
-						   systime,
-						   config,
-						   issues);
+	    int invoke_result = step_current(cur,
+					     self,
+					     systime,
+					     config,
+					     issues,
+					     profiler);
 
 	    if(invoke_result == INVOKE_RESULT_ERROR)
 	    {
@@ -180,7 +318,7 @@ static struct invoke_iface_t * cursor_step_out(
 	    }
 	    else if(invoke_result == INVOKE_RESULT_ALL_FINISHED)
 	    {
-		cur->current = cur->cycle_start;
+		restart_cycle(cur, config, issues);
 		break;
 	    }
 	    else if(invoke_result == INVOKE_RESULT_FINISHED)
@@ -194,6 +332,164 @@ static struct invoke_iface_t * cursor_step_out(
     return cur->current;
 }
 
+static struct invoke_iface_t * cursor_step(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return step(self, systime, config, issues, NULL);
+}
+
+static struct invoke_iface_t * cursor_profiled_step(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    return step(self, systime, config, issues, cur->profiler);
+}
+
+static struct invoke_iface_t * cursor_step_in(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return step_in(self, systime, config, issues, NULL);
+}
+
+static struct invoke_iface_t * cursor_profiled_step_in(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    return step_in(self, systime, config, issues, cur->profiler);
+}
+
+static struct invoke_iface_t * cursor_step_out(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    return step_out(self, systime, config, issues, NULL);
+}
+
+static struct invoke_iface_t * cursor_profiled_step_out(
+    struct cursor_iface_t *self,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    return step_out(self, systime, config, issues, cur->profiler);
+}
+
+static int call_depth(
+    const struct cursor_t *cur)
+{
+    int depth = 0;
+    
+    const struct invoke_iface_t *itr = NULL;
+    for(itr = cur->call_stack; itr != NULL; itr = itr->call_stack_next)
+    {
+	depth++;
+    }
+
+    return depth;
+}
+
+static int same_line(
+    const struct st_location_t *location,
+    const struct st_location_t *other_location)
+{
+    return location && other_location
+	&& location->first_line == other_location->first_line
+	&& location->source == other_location->source;
+}
+
+static int cursor_run_to_breakpoint(
+    struct cursor_iface_t *self,
+    struct breakpoints_iface_t *breakpoints,
+    struct systime_iface_t *systime,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    if(!cur->current)
+    {
+	return ESSTEE_ERROR;
+    }
+    
+    while(1)
+    {
+	struct invoke_iface_t *before = cur->current;
+	int depth_before = call_depth(cur);
+	
+	int invoke_result = step_current(cur,
+					 self,
+					 systime,
+					 config,
+					 issues,
+					 cur->profiler);
+
+	if(invoke_result == INVOKE_RESULT_ERROR)
+	{
+	    return ESSTEE_ERROR;
+	}
+	else if(invoke_result == INVOKE_RESULT_ALL_FINISHED
+		|| (invoke_result == INVOKE_RESULT_FINISHED
+		    && !cur->current->next
+		    && !cur->call_stack))
+	{
+	    restart_cycle(cur, config, issues);
+	    return ESSTEE_FALSE;
+	}
+	else if(invoke_result == INVOKE_RESULT_FINISHED)
+	{
+	    set_current_to_next(cur, config, issues);
+	}
+
+	int written_result = breakpoints->written(breakpoints,
+						  systime,
+						  config,
+						  issues);
+	if(written_result != ESSTEE_FALSE)
+	{
+	    return written_result;
+	}
+
+	if(cur->current == before
+	   || call_depth(cur) < depth_before
+	   || same_line(cur->current->location, before->location))
+	{
+	    continue;
+	}
+
+	int hit_result = breakpoints->hit(breakpoints,
+					  cur->current->location,
+					  systime,
+					  config,
+					  issues);
+	if(hit_result != ESSTEE_FALSE)
+	{
+	    return hit_result;
+	}
+    }
+}
+
 static int cursor_switch_current(
     struct cursor_iface_t *self,
     struct invoke_iface_t *switch_to,
@@ -380,6 +676,43 @@ static int cursor_switch_cycle_start(
     return ESSTEE_OK;
 }
 
+static void cursor_set_profiler(
+    struct cursor_iface_t *self,
+    struct profiler_iface_t *profiler)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    cur->profiler = profiler;
+
+    if(profiler)
+    {
+	cur->cursor.step = cursor_profiled_step;
+	cur->cursor.step_in = cursor_profiled_step_in;
+	cur->cursor.step_out = cursor_profiled_step_out;
+    }
+    else
+    {
+	cur->cursor.step = cursor_step;
+	cur->cursor.step_in = cursor_step_in;
+	cur->cursor.step_out = cursor_step_out;
+    }
+}
+
+static int cursor_at_cycle_start(
+    const struct cursor_iface_t *self)
+{
+    const struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    if(cur->current == cur->cycle_start && !cur->call_stack)
+    {
+	return ESSTEE_TRUE;
+    }
+
+    return ESSTEE_FALSE;
+}
+
 const struct st_location_t * cursor_current_location(
     struct cursor_iface_t *self)
 {
@@ -394,6 +727,49 @@ const struct st_location_t * cursor_current_location(
     return NULL;
 }
 
+static void cursor_set_cycle_limits(
+    struct cursor_iface_t *self,
+    uint64_t max_steps,
+    uint64_t max_time_ns)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    cur->max_steps = max_steps;
+    cur->max_time_ns = max_time_ns;
+    schedule_watchdog_check(cur);
+}
+
+static void cursor_arm_watchdog(
+    struct cursor_iface_t *self)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    cur->steps = 0;
+    if(cur->max_time_ns > 0)
+    {
+	clock_gettime(CLOCK_MONOTONIC, &(cur->armed));
+    }
+    schedule_watchdog_check(cur);
+}
+
+static int cursor_abort_cycle(
+    struct cursor_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct cursor_t *cur =
+	CONTAINER_OF(self, struct cursor_t, cursor);
+
+    if(!cur->cycle_start)
+    {
+	return ESSTEE_OK;
+    }
+    
+    return cursor_switch_cycle_start(self, cur->cycle_start, config, issues);
+}
+
 static void cursor_destroy(
     struct cursor_iface_t *self)
 {
@@ -413,10 +789,16 @@ struct cursor_iface_t * st_new_cursor()
 	error_free_resources);
 
     cursor_reset(&(cur->cursor));
+    cur->profiler = NULL;
+    cur->max_steps = 0;
+    cur->max_time_ns = 0;
+    cur->steps = 0;
+    cur->next_watchdog_check = UINT64_MAX;
 
     cur->cursor.step = cursor_step;
     cur->cursor.step_in = cursor_step_in;
     cur->cursor.step_out = cursor_step_out;
+    cur->cursor.run_to_breakpoint = cursor_run_to_breakpoint;
     cur->cursor.reset = cursor_reset;
     cur->cursor.switch_current = cursor_switch_current;
     cur->cursor.push_return_context = cursor_push_return_context;
@@ -426,7 +808,12 @@ struct cursor_iface_t * st_new_cursor()
     cur->cursor.pop_exit_context = cursor_pop_exit_context;
     cur->cursor.jump_exit = cursor_jump_exit;
     cur->cursor.switch_cycle_start = cursor_switch_cycle_start;
+    cur->cursor.at_cycle_start = cursor_at_cycle_start;
+    cur->cursor.set_profiler = cursor_set_profiler;
     cur->cursor.current_location = cursor_current_location;
+    cur->cursor.set_cycle_limits = cursor_set_cycle_limits;
+    cur->cursor.arm_watchdog = cursor_arm_watchdog;
+    cur->cursor.abort_cycle = cursor_abort_cycle;
     cur->cursor.destroy = cursor_destroy;
     
     return &(cur->cursor);
@@ -0,0 +1,204 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <rt/cycle_stats.h>
+#include <util/macros.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Log-linear buckets: values below 2^(SUB_BUCKET_BITS + 1) have a
+ * bucket each, above that every power of two is split in
+ * SUB_BUCKETS equally wide buckets */
+#define SUB_BUCKET_BITS 5
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define BUCKETS ((64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS)
+
+struct cycle_stats_t {
+    struct cycle_stats_iface_t cycle_stats;
+    struct st_cycle_stats_t summary;
+    uint64_t total_ns;
+    uint64_t counts[BUCKETS];
+};
+
+/**************************************************************************/
+/* Help functions                                                         */
+/**************************************************************************/
+static int bucket_of(
+    uint64_t time_ns)
+{
+    if(time_ns < SUB_BUCKETS)
+    {
+	return (int)time_ns;
+    }
+
+    int magnitude = 63 - __builtin_clzll(time_ns);
+    int shift = magnitude - SUB_BUCKET_BITS;
+    int sub_bucket = (int)(time_ns >> shift) - SUB_BUCKETS;
+
+    return (shift + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+/* The highest value that ends up in the bucket */
+static uint64_t bucket_highest(
+    int bucket)
+{
+    if(bucket < 2 * SUB_BUCKETS)
+    {
+	return (uint64_t)bucket;
+    }
+
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub_bucket = (uint64_t)(bucket % SUB_BUCKETS);
+    uint64_t lowest = (SUB_BUCKETS + sub_bucket) << shift;
+
+    return lowest + ((1ULL << shift) - 1);
+}
+
+static uint64_t percentile(
+    const struct cycle_stats_t *cs,
+    uint64_t per_mille)
+{
+    /* Rank of the cycle at the percentile, rounded upwards */
+    uint64_t rank = (cs->summary.cycles * per_mille + 999) / 1000;
+    if(rank == 0)
+    {
+	rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for(int i = 0; i < BUCKETS; i++)
+    {
+	seen += cs->counts[i];
+	if(seen >= rank)
+	{
+	    uint64_t highest = bucket_highest(i);
+	    return (highest < cs->summary.max_ns) ? highest : cs->summary.max_ns;
+	}
+    }
+
+    return cs->summary.max_ns;
+}
+
+/**************************************************************************/
+/* Cycle stats interface                                                  */
+/**************************************************************************/
+static void cycle_stats_record(
+    struct cycle_stats_iface_t *self,
+    uint64_t time_ns)
+{
+    struct cycle_stats_t *cs =
+	CONTAINER_OF(self, struct cycle_stats_t, cycle_stats);
+
+    if(cs->summary.cycles == 0 || time_ns < cs->summary.min_ns)
+    {
+	cs->summary.min_ns = time_ns;
+    }
+    if(time_ns > cs->summary.max_ns)
+    {
+	cs->summary.max_ns = time_ns;
+    }
+    if(cs->summary.budget_ns > 0 && time_ns > cs->summary.budget_ns)
+    {
+	cs->summary.overruns++;
+    }
+
+    cs->summary.cycles++;
+    cs->summary.last_ns = time_ns;
+    cs->total_ns += time_ns;
+    cs->counts[bucket_of(time_ns)]++;
+}
+
+static const struct st_cycle_stats_t * cycle_stats_summary(
+    struct cycle_stats_iface_t *self)
+{
+    struct cycle_stats_t *cs =
+	CONTAINER_OF(self, struct cycle_stats_t, cycle_stats);
+
+    if(cs->summary.cycles > 0)
+    {
+	cs->summary.mean_ns = cs->total_ns / cs->summary.cycles;
+	cs->summary.p50_ns = percentile(cs, 500);
+	cs->summary.p99_ns = percentile(cs, 990);
+	cs->summary.p999_ns = percentile(cs, 999);
+    }
+
+    return &(cs->summary);
+}
+
+static void cycle_stats_set_budget(
+    struct cycle_stats_iface_t *self,
+    uint64_t budget_ns)
+{
+    struct cycle_stats_t *cs =
+	CONTAINER_OF(self, struct cycle_stats_t, cycle_stats);
+
+    cs->summary.budget_ns = budget_ns;
+}
+
+static void cycle_stats_reset(
+    struct cycle_stats_iface_t *self)
+{
+    struct cycle_stats_t *cs =
+	CONTAINER_OF(self, struct cycle_stats_t, cycle_stats);
+
+    uint64_t budget_ns = cs->summary.budget_ns;
+    
+    memset(&(cs->summary), 0, sizeof(struct st_cycle_stats_t));
+    memset(cs->counts, 0, sizeof(cs->counts));
+    cs->summary.budget_ns = budget_ns;
+    cs->total_ns = 0;
+}
+
+static void cycle_stats_destroy(
+    struct cycle_stats_iface_t *self)
+{
+    struct cycle_stats_t *cs =
+	CONTAINER_OF(self, struct cycle_stats_t, cycle_stats);
+
+    free(cs);
+}
+
+/**************************************************************************/
+/* Public interface                                                       */
+/**************************************************************************/
+struct cycle_stats_iface_t * st_new_cycle_stats(
+    struct issues_iface_t *issues)
+{
+    struct cycle_stats_t *cs = NULL;
+
+    ALLOC_OR_ERROR_JUMP(
+	cs,
+	struct cycle_stats_t,
+	issues,
+	error_free_resources);
+
+    memset(cs, 0, sizeof(struct cycle_stats_t));
+
+    cs->cycle_stats.record = cycle_stats_record;
+    cs->cycle_stats.summary = cycle_stats_summary;
+    cs->cycle_stats.set_budget = cycle_stats_set_budget;
+    cs->cycle_stats.reset = cycle_stats_reset;
+    cs->cycle_stats.destroy = cycle_stats_destroy;
+
+    return &(cs->cycle_stats);
+
+error_free_resources:
+    return NULL;
+}
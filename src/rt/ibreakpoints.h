@@ -0,0 +1,97 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <elements/iqueries.h>
+#include <elements/ivariable.h>
+#include <rt/isystime.h>
+#include <util/iconfig.h>
+#include <util/iissues.h>
+#include <esstee/locations.h>
+
+struct breakpoints_iface_t {
+
+    /* A breakpoint is set on a line of a source (NULL for any
+     * source), and is hit when its condition (NULL for none) is true.
+     * Setting it again replaces the condition. */
+    int (*set)(
+	struct breakpoints_iface_t *self,
+	const char *source,
+	int line,
+	struct queries_iface_t *condition,
+	struct issues_iface_t *issues);
+
+    int (*clear)(
+	struct breakpoints_iface_t *self,
+	const char *source,
+	int line,
+	struct issues_iface_t *issues);
+
+    void (*clear_all)(
+	struct breakpoints_iface_t *self);
+
+    /* A watchpoint is written by a modification of the variable, or
+     * only of the given element of it (NULL for any), and is hit when
+     * its condition (NULL for none) is true after the write. Writes
+     * are caught by a watch of the variable, variables without
+     * watchpoints are not slowed down. */
+    int (*watch)(
+	struct breakpoints_iface_t *self,
+	const char *identifier,
+	struct variable_iface_t *variable,
+	const struct value_iface_t *element,
+	struct queries_iface_t *condition,
+	struct issues_iface_t *issues);
+
+    int (*unwatch)(
+	struct breakpoints_iface_t *self,
+	const char *identifier,
+	struct issues_iface_t *issues);
+
+    /* Both breakpoints and watchpoints are counted */
+    size_t (*count)(
+	const struct breakpoints_iface_t *self);
+
+    size_t (*watchpoints)(
+	const struct breakpoints_iface_t *self);
+
+    /* Gives ESSTEE_TRUE if a breakpoint at the location is hit */
+    int (*hit)(
+	struct breakpoints_iface_t *self,
+	const struct st_location_t *location,
+	struct systime_iface_t *systime,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
+    
+    /* Gives ESSTEE_TRUE if a watchpoint written since the last check
+     * is hit */
+    int (*written)(
+	struct breakpoints_iface_t *self,
+	struct systime_iface_t *systime,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
+
+    /* Forgets the writes made while not checking */
+    void (*forget_writes)(
+	struct breakpoints_iface_t *self);
+    
+    void (*destroy)(
+	struct breakpoints_iface_t *self);
+};
@@ -22,6 +22,11 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <util/iconfig.h>
 #include <util/iissues.h>
 #include <rt/isystime.h>
+#include <rt/iprofiler.h>
+
+#include <inttypes.h>
+
+struct breakpoints_iface_t;
 
 struct cursor_iface_t {
 
@@ -43,6 +48,23 @@ struct cursor_iface_t {
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
+    /* Steps single invokes until one on a line with a breakpoint is
+     * entered from another line (returning to an invoke does not
+     * count), a step writes a watchpoint, or the cycle is complete.
+     * Kept apart from the other step functions, which never look for
+     * breakpoints.
+     *
+     * @return ESSTEE_TRUE at a breakpoint, or after a watchpoint hit.
+     * @return ESSTEE_FALSE when back at the start of the cycle.
+     * @return ESSTEE_ERROR on failure.
+     */
+    int (*run_to_breakpoint)(
+	struct cursor_iface_t *self,
+	struct breakpoints_iface_t *breakpoints,
+	struct systime_iface_t *systime,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
+
     void (*reset)(
     	struct cursor_iface_t *self);
     
@@ -78,8 +100,35 @@ struct cursor_iface_t {
     int (*jump_exit)(
 	struct cursor_iface_t *self);
 
+    int (*at_cycle_start)(
+	const struct cursor_iface_t *self);
+
+    /* Steps are timed and recorded while a profiler is set */
+    void (*set_profiler)(
+	struct cursor_iface_t *self,
+	struct profiler_iface_t *profiler);
+
     const struct st_location_t * (*current_location)(
     	struct cursor_iface_t *self);
+
+    /* Steps beyond max_steps, or beyond max_time_ns after the watchdog
+     * was armed, fail with a runtime error at the current location
+     * before the step is done. Zero disables a limit. */
+    void (*set_cycle_limits)(
+	struct cursor_iface_t *self,
+	uint64_t max_steps,
+	uint64_t max_time_ns);
+
+    /* Restarts the step and time counting, done at each cycle start */
+    void (*arm_watchdog)(
+	struct cursor_iface_t *self);
+
+    /* Discards the rest of the current cycle, the next step is the
+     * first of the cycle */
+    int (*abort_cycle)(
+	struct cursor_iface_t *self,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
     
     void (*destroy)(
 	struct cursor_iface_t *self);
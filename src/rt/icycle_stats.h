@@ -0,0 +1,45 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <esstee/cycle_stats.h>
+
+struct cycle_stats_iface_t {
+
+    void (*record)(
+	struct cycle_stats_iface_t *self,
+	uint64_t time_ns);
+
+    /* The statistics are summarized at each call */
+    const struct st_cycle_stats_t * (*summary)(
+	struct cycle_stats_iface_t *self);
+
+    /* A zero budget disables overrun counting */
+    void (*set_budget)(
+	struct cycle_stats_iface_t *self,
+	uint64_t budget_ns);
+
+    /* Discards the recorded cycles, the budget is kept */
+    void (*reset)(
+	struct cycle_stats_iface_t *self);
+
+    void (*destroy)(
+	struct cycle_stats_iface_t *self);
+};
@@ -0,0 +1,61 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <util/iissues.h>
+#include <esstee/profile.h>
+
+struct invoke_iface_t;
+
+struct profiler_iface_t {
+
+    /* Registers a POU, statements located within it are accounted
+     * to it */
+    int (*add_pou)(
+	struct profiler_iface_t *self,
+	st_bitflag_t class,
+	const char *identifier,
+	const struct st_location_t *location,
+	struct issues_iface_t *issues);
+
+    void (*record_step)(
+	struct profiler_iface_t *self,
+	const struct invoke_iface_t *invoke,
+	uint64_t time_ns,
+	struct issues_iface_t *issues);
+
+    void (*record_call)(
+	struct profiler_iface_t *self,
+	const struct invoke_iface_t *caller,
+	const struct invoke_iface_t *callee,
+	struct issues_iface_t *issues);
+
+    /* Iterates the entries in order of decreasing time, the POU
+     * entries are summed when an iteration starts */
+    const struct st_profile_entry_t * (*fetch_entry)(
+	struct profiler_iface_t *self,
+	st_bitflag_t filter);
+
+    const struct st_profile_call_t * (*fetch_call)(
+	struct profiler_iface_t *self);
+    
+    void (*destroy)(
+	struct profiler_iface_t *self);
+};
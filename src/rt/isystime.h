@@ -36,4 +36,27 @@ struct systime_iface_t {
     uint64_t (*elapsed_from)(
 	struct systime_iface_t *self,
 	uint64_t timestamp);
+
+    /* A paced time follows the monotonic clock from where it is,
+     * added time is put on top of it */
+    int (*set_paced)(
+	struct systime_iface_t *self,
+	int paced);
+
+    /* Anything waiting for a time (e.g. a timer) registers it anew
+     * each cycle, the deadlines are cleared before every cycle. A
+     * fast-forward never skips past the earliest one. */
+    void (*add_deadline)(
+	struct systime_iface_t *self,
+	uint64_t time_ms);
+
+    /* UINT64_MAX when no deadline is registered */
+    uint64_t (*next_deadline)(
+	struct systime_iface_t *self);
+
+    void (*clear_deadlines)(
+	struct systime_iface_t *self);
+
+    void (*destroy)(
+	struct systime_iface_t *self);
 };
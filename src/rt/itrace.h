@@ -0,0 +1,101 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <util/iissues.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct variable_iface_t;
+
+struct trace_recorder_iface_t {
+
+    /* Variables are added before the trace begins, the name is
+     * stored in the trace */
+    int (*add_variable)(
+	struct trace_recorder_iface_t *self,
+	const char *name,
+	const struct variable_iface_t *variable,
+	struct issues_iface_t *issues);
+
+    /* Writes the header, and the values of all variables as cycle 0 */
+    int (*begin)(
+	struct trace_recorder_iface_t *self,
+	uint64_t time_ms,
+	struct issues_iface_t *issues);
+
+    /* Counts a cycle, writing a record if any value changed */
+    int (*record)(
+	struct trace_recorder_iface_t *self,
+	uint64_t time_ms,
+	struct issues_iface_t *issues);
+
+    /* Closes the trace, the last cycle is always recorded */
+    int (*end)(
+	struct trace_recorder_iface_t *self,
+	struct issues_iface_t *issues);
+
+    void (*destroy)(
+	struct trace_recorder_iface_t *self);
+};
+
+struct trace_reader_iface_t {
+
+    size_t (*variable_count)(
+	const struct trace_reader_iface_t *self);
+
+    const char * (*variable_name)(
+	const struct trace_reader_iface_t *self,
+	size_t index);
+
+    /* Applies the next record, ESSTEE_FALSE at the end of the trace */
+    int (*next_record)(
+	struct trace_reader_iface_t *self,
+	struct issues_iface_t *issues);
+
+    /* Applies the records up to and including the given cycle, from
+     * the start of the trace if needed */
+    int (*seek)(
+	struct trace_reader_iface_t *self,
+	uint64_t cycle,
+	struct issues_iface_t *issues);
+
+    /* Cycle and time of the last record applied */
+    uint64_t (*cycle)(
+	const struct trace_reader_iface_t *self);
+
+    uint64_t (*time_ms)(
+	const struct trace_reader_iface_t *self);
+
+    /* Whether the variable changed in the last record applied */
+    int (*changed)(
+	const struct trace_reader_iface_t *self,
+	size_t index);
+
+    int (*restore_variable)(
+	const struct trace_reader_iface_t *self,
+	size_t index,
+	struct variable_iface_t *variable,
+	struct issues_iface_t *issues);
+
+    void (*destroy)(
+	struct trace_reader_iface_t *self);
+};
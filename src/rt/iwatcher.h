@@ -0,0 +1,55 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <elements/ivariable.h>
+#include <util/iconfig.h>
+#include <util/iissues.h>
+#include <esstee/esstee.h>
+
+struct watcher_iface_t {
+
+    /* Variables watched under several identifiers share their watch */
+    int (*watch)(
+	struct watcher_iface_t *self,
+	const char *identifier,
+	struct variable_iface_t *variable,
+	st_watch_callback_t callback,
+	void *user_data,
+	struct issues_iface_t *issues);
+
+    int (*unwatch)(
+	struct watcher_iface_t *self,
+	const char *identifier,
+	struct issues_iface_t *issues);
+
+    /* Calls back for the dirty variables whose value differs from
+     * the last one reported */
+    int (*notify)(
+	struct watcher_iface_t *self,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
+
+    int (*watching)(
+	const struct watcher_iface_t *self);
+    
+    void (*destroy)(
+	struct watcher_iface_t *self);
+};
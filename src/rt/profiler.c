@@ -0,0 +1,396 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <rt/profiler.h>
+#include <statements/iinvoke.h>
+#include <util/macros.h>
+#include <util/bitflag.h>
+#include <esstee/flags.h>
+
+#include <utlist.h>
+#include <uthash.h>
+#include <string.h>
+#include <stdlib.h>
+
+struct profile_node_t {
+    struct st_profile_entry_t entry;
+    const struct st_location_t *key;
+    struct profile_node_t *pou;
+    UT_hash_handle hh;
+    struct profile_node_t *pou_prev;
+    struct profile_node_t *pou_next;
+    struct profile_node_t *prev;
+    struct profile_node_t *next;
+};
+
+struct call_node_t {
+    struct st_profile_call_t call;
+    struct call_node_t *prev;
+    struct call_node_t *next;
+};
+
+struct profiler_t {
+    struct profiler_iface_t profiler;
+    struct profile_node_t *pous;
+    struct profile_node_t *statement_table;
+    struct profile_node_t *entries;
+    struct call_node_t *calls;
+    struct profile_node_t *entry_iterator;
+    struct call_node_t *call_iterator;
+    st_bitflag_t last_filter;
+};
+
+/**************************************************************************/
+/* Help functions                                                         */
+/**************************************************************************/
+static int location_within(
+    const struct st_location_t *inner,
+    const struct st_location_t *outer)
+{
+    if(inner->source != outer->source)
+    {
+	if(!inner->source || !outer->source)
+	{
+	    return ESSTEE_FALSE;
+	}
+	else if(strcmp(inner->source, outer->source) != 0)
+	{
+	    return ESSTEE_FALSE;
+	}
+    }
+
+    if(inner->first_line < outer->first_line
+       || (inner->first_line == outer->first_line
+	   && inner->first_column < outer->first_column))
+    {
+	return ESSTEE_FALSE;
+    }
+
+    if(inner->last_line > outer->last_line
+       || (inner->last_line == outer->last_line
+	   && inner->last_column > outer->last_column))
+    {
+	return ESSTEE_FALSE;
+    }
+
+    return ESSTEE_TRUE;
+}
+
+static struct profile_node_t * statement_node(
+    struct profiler_t *pf,
+    const struct invoke_iface_t *invoke,
+    struct issues_iface_t *issues)
+{
+    const struct st_location_t *location = invoke->location;
+    if(!location)
+    {
+	return NULL;
+    }
+    
+    struct profile_node_t *node = NULL;
+    HASH_FIND(hh, pf->statement_table, &location, sizeof(location), node);
+    if(node)
+    {
+	return node;
+    }
+
+    ALLOC_OR_ERROR_JUMP(
+	node,
+	struct profile_node_t,
+	issues,
+	error_free_resources);
+
+    node->key = location;
+    node->pou = NULL;
+
+    struct profile_node_t *itr = NULL;
+    DL_FOREACH2(pf->pous, itr, pou_next)
+    {
+	if(location_within(location, itr->entry.location))
+	{
+	    node->pou = itr;
+	    break;
+	}
+    }
+    
+    node->entry.class = ESSTEE_PROFILE_STATEMENT;
+    node->entry.identifier = (node->pou) ? node->pou->entry.identifier : NULL;
+    node->entry.location = location;
+    node->entry.steps = 0;
+    node->entry.calls = 0;
+    node->entry.time_ns = 0;
+
+    HASH_ADD(hh, pf->statement_table, key, sizeof(node->key), node);
+    DL_APPEND(pf->entries, node);
+    
+    return node;
+
+error_free_resources:
+    return NULL;
+}
+
+static int entry_time_cmp(
+    struct profile_node_t *a,
+    struct profile_node_t *b)
+{
+    if(a->entry.time_ns > b->entry.time_ns)
+    {
+	return -1;
+    }
+    else if(a->entry.time_ns < b->entry.time_ns)
+    {
+	return 1;
+    }
+
+    return 0;
+}
+
+static void sum_pous(
+    struct profiler_t *pf)
+{
+    struct profile_node_t *itr = NULL;
+    DL_FOREACH2(pf->pous, itr, pou_next)
+    {
+	itr->entry.steps = 0;
+	itr->entry.time_ns = 0;
+    }
+
+    for(itr = pf->statement_table; itr != NULL; itr = itr->hh.next)
+    {
+	if(itr->pou)
+	{
+	    itr->pou->entry.steps += itr->entry.steps;
+	    itr->pou->entry.time_ns += itr->entry.time_ns;
+	}
+    }
+}
+
+/**************************************************************************/
+/* Profiler interface                                                     */
+/**************************************************************************/
+static int profiler_add_pou(
+    struct profiler_iface_t *self,
+    st_bitflag_t class,
+    const char *identifier,
+    const struct st_location_t *location,
+    struct issues_iface_t *issues)
+{
+    struct profiler_t *pf =
+	CONTAINER_OF(self, struct profiler_t, profiler);
+
+    struct profile_node_t *node = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	node,
+	struct profile_node_t,
+	issues,
+	error_free_resources);
+
+    node->key = location;
+    node->pou = NULL;
+    node->entry.class = class;
+    node->entry.identifier = identifier;
+    node->entry.location = location;
+    node->entry.steps = 0;
+    node->entry.calls = 0;
+    node->entry.time_ns = 0;
+
+    DL_APPEND2(pf->pous, node, pou_prev, pou_next);
+    DL_APPEND(pf->entries, node);
+    
+    return ESSTEE_OK;
+
+error_free_resources:
+    return ESSTEE_ERROR;
+}
+
+static void profiler_record_step(
+    struct profiler_iface_t *self,
+    const struct invoke_iface_t *invoke,
+    uint64_t time_ns,
+    struct issues_iface_t *issues)
+{
+    struct profiler_t *pf =
+	CONTAINER_OF(self, struct profiler_t, profiler);
+
+    struct profile_node_t *node = statement_node(pf, invoke, issues);
+    if(node)
+    {
+	node->entry.steps++;
+	node->entry.time_ns += time_ns;
+    }
+}
+
+static void profiler_record_call(
+    struct profiler_iface_t *self,
+    const struct invoke_iface_t *caller,
+    const struct invoke_iface_t *callee,
+    struct issues_iface_t *issues)
+{
+    struct profiler_t *pf =
+	CONTAINER_OF(self, struct profiler_t, profiler);
+
+    struct profile_node_t *caller_node = statement_node(pf, caller, issues);
+    struct profile_node_t *callee_node = statement_node(pf, callee, issues);
+
+    if(!caller_node || !callee_node)
+    {
+	return;
+    }
+
+    /* Only calls between POUs are of interest, not the switches
+     * into blocks of conditionals and loops */
+    struct profile_node_t *caller_pou = caller_node->pou;
+    struct profile_node_t *callee_pou = callee_node->pou;
+    
+    if(!caller_pou || !callee_pou || caller_pou == callee_pou)
+    {
+	return;
+    }
+
+    callee_pou->entry.calls++;
+
+    struct call_node_t *itr = NULL;
+    DL_FOREACH(pf->calls, itr)
+    {
+	if(itr->call.caller == &(caller_pou->entry)
+	   && itr->call.callee == &(callee_pou->entry))
+	{
+	    itr->call.calls++;
+	    return;
+	}
+    }
+
+    struct call_node_t *call = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	call,
+	struct call_node_t,
+	issues,
+	error_free_resources);
+
+    call->call.caller = &(caller_pou->entry);
+    call->call.callee = &(callee_pou->entry);
+    call->call.calls = 1;
+
+    DL_APPEND(pf->calls, call);
+    
+error_free_resources:
+    return;
+}
+
+static const struct st_profile_entry_t * profiler_fetch_entry(
+    struct profiler_iface_t *self,
+    st_bitflag_t filter)
+{
+    struct profiler_t *pf =
+	CONTAINER_OF(self, struct profiler_t, profiler);
+
+    if(pf->entry_iterator == NULL || filter != pf->last_filter)
+    {
+	sum_pous(pf);
+	DL_SORT(pf->entries, entry_time_cmp);
+	pf->entry_iterator = pf->entries;
+    }
+    else
+    {
+	pf->entry_iterator = pf->entry_iterator->next;
+    }
+
+    pf->last_filter = filter;
+
+    for(; pf->entry_iterator != NULL; pf->entry_iterator = pf->entry_iterator->next)
+    {
+	if(ST_FLAG_IS_SET(pf->entry_iterator->entry.class, filter))
+	{
+	    return &(pf->entry_iterator->entry);
+	}
+    }
+
+    return NULL;
+}
+
+static const struct st_profile_call_t * profiler_fetch_call(
+    struct profiler_iface_t *self)
+{
+    struct profiler_t *pf =
+	CONTAINER_OF(self, struct profiler_t, profiler);
+
+    pf->call_iterator = (pf->call_iterator) ? pf->call_iterator->next : pf->calls;
+
+    return (pf->call_iterator) ? &(pf->call_iterator->call) : NULL;
+}
+
+static void profiler_destroy(
+    struct profiler_iface_t *self)
+{
+    struct profiler_t *pf =
+	CONTAINER_OF(self, struct profiler_t, profiler);
+
+    HASH_CLEAR(hh, pf->statement_table);
+    
+    struct profile_node_t *itr = NULL;
+    struct profile_node_t *tmp = NULL;
+    DL_FOREACH_SAFE(pf->entries, itr, tmp)
+    {
+	free(itr);
+    }
+
+    struct call_node_t *call_itr = NULL;
+    struct call_node_t *call_tmp = NULL;
+    DL_FOREACH_SAFE(pf->calls, call_itr, call_tmp)
+    {
+	free(call_itr);
+    }
+
+    free(pf);
+}
+
+/**************************************************************************/
+/* Public interface                                                       */
+/**************************************************************************/
+struct profiler_iface_t * st_new_profiler(
+    struct issues_iface_t *issues)
+{
+    struct profiler_t *pf = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	pf,
+	struct profiler_t,
+	issues,
+	error_free_resources);
+
+    pf->pous = NULL;
+    pf->statement_table = NULL;
+    pf->entries = NULL;
+    pf->calls = NULL;
+    pf->entry_iterator = NULL;
+    pf->call_iterator = NULL;
+    pf->last_filter = 0;
+
+    memset(&(pf->profiler), 0, sizeof(struct profiler_iface_t));
+    pf->profiler.add_pou = profiler_add_pou;
+    pf->profiler.record_step = profiler_record_step;
+    pf->profiler.record_call = profiler_record_call;
+    pf->profiler.fetch_entry = profiler_fetch_entry;
+    pf->profiler.fetch_call = profiler_fetch_call;
+    pf->profiler.destroy = profiler_destroy;
+
+    return &(pf->profiler);
+
+error_free_resources:
+    return NULL;
+}
@@ -23,6 +23,15 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stddef.h>
 
+static uint64_t clock_ms_since(
+    const struct timespec *origin)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - origin->tv_sec) * 1000ULL
+	+ (now.tv_nsec - origin->tv_nsec) / 1000000;
+}
 
 struct systime_iface_t * st_new_systime(void)
 {
@@ -35,6 +44,15 @@ struct systime_iface_t * st_new_systime(void)
     syst->systime.add_time_ms = st_systime_add_time_ms;
     syst->systime.get_time_ms = st_systime_get_time_ms;
     syst->systime.reset = st_systime_reset;
+    syst->systime.elapsed_from = st_systime_elapsed_from;
+    syst->systime.set_paced = st_systime_set_paced;
+    syst->systime.add_deadline = st_systime_add_deadline;
+    syst->systime.next_deadline = st_systime_next_deadline;
+    syst->systime.clear_deadlines = st_systime_clear_deadlines;
+    syst->systime.destroy = st_systime_destroy;
+    syst->current_time = 0;
+    syst->paced = ESSTEE_FALSE;
+    syst->deadline = UINT64_MAX;
 
     return &(syst->systime);
     
@@ -50,6 +68,11 @@ int st_systime_reset(
 
     syst->current_time = 0;
 
+    if(syst->paced)
+    {
+	clock_gettime(CLOCK_MONOTONIC, &(syst->origin));
+    }
+
     return ESSTEE_OK;
 }
     
@@ -59,6 +82,11 @@ uint64_t st_systime_get_time_ms(
     struct systime_t *syst =
 	CONTAINER_OF(self, struct systime_t, systime);
 
+    if(syst->paced)
+    {
+	return syst->current_time + clock_ms_since(&(syst->origin));
+    }
+    
     return syst->current_time;    
 }
 
@@ -73,3 +101,73 @@ uint64_t st_systime_add_time_ms(
 
     return ESSTEE_OK;
 }
+
+uint64_t st_systime_elapsed_from(
+    struct systime_iface_t *self,
+    uint64_t timestamp)
+{
+    uint64_t now = st_systime_get_time_ms(self);
+
+    return (now > timestamp) ? now - timestamp : 0;
+}
+
+int st_systime_set_paced(
+    struct systime_iface_t *self,
+    int paced)
+{
+    struct systime_t *syst =
+	CONTAINER_OF(self, struct systime_t, systime);
+
+    if(paced && !syst->paced)
+    {
+	clock_gettime(CLOCK_MONOTONIC, &(syst->origin));
+	syst->paced = ESSTEE_TRUE;
+    }
+    else if(!paced && syst->paced)
+    {
+	syst->current_time = st_systime_get_time_ms(self);
+	syst->paced = ESSTEE_FALSE;
+    }
+
+    return ESSTEE_OK;
+}
+
+void st_systime_add_deadline(
+    struct systime_iface_t *self,
+    uint64_t time_ms)
+{
+    struct systime_t *syst =
+	CONTAINER_OF(self, struct systime_t, systime);
+
+    if(time_ms < syst->deadline)
+    {
+	syst->deadline = time_ms;
+    }
+}
+
+uint64_t st_systime_next_deadline(
+    struct systime_iface_t *self)
+{
+    struct systime_t *syst =
+	CONTAINER_OF(self, struct systime_t, systime);
+
+    return syst->deadline;
+}
+
+void st_systime_clear_deadlines(
+    struct systime_iface_t *self)
+{
+    struct systime_t *syst =
+	CONTAINER_OF(self, struct systime_t, systime);
+
+    syst->deadline = UINT64_MAX;
+}
+
+void st_systime_destroy(
+    struct systime_iface_t *self)
+{
+    struct systime_t *syst =
+	CONTAINER_OF(self, struct systime_t, systime);
+
+    free(syst);
+}
@@ -21,10 +21,14 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <rt/isystime.h>
 
+#include <time.h>
 
 struct systime_t {
     struct systime_iface_t systime;
-    uint64_t current_time;
+    uint64_t current_time;	/* Offset to the clock when paced */
+    int paced;
+    struct timespec origin;
+    uint64_t deadline;		/* Earliest registered */
 };
 
 struct systime_iface_t * st_new_systime(void);
@@ -38,3 +42,24 @@ uint64_t st_systime_get_time_ms(
 uint64_t st_systime_add_time_ms(
     struct systime_iface_t *self,
     uint64_t ms);
+
+uint64_t st_systime_elapsed_from(
+    struct systime_iface_t *self,
+    uint64_t timestamp);
+
+int st_systime_set_paced(
+    struct systime_iface_t *self,
+    int paced);
+
+void st_systime_add_deadline(
+    struct systime_iface_t *self,
+    uint64_t time_ms);
+
+uint64_t st_systime_next_deadline(
+    struct systime_iface_t *self);
+
+void st_systime_clear_deadlines(
+    struct systime_iface_t *self);
+
+void st_systime_destroy(
+    struct systime_iface_t *self);
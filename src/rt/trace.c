@@ -0,0 +1,854 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A trace is a header naming the traced variables, followed by one
+ * record per cycle in which any of them changed (and the first and
+ * last cycle). A record holds the cycle and time as deltas to the
+ * previous record, and the checkpointed value of each variable that
+ * changed. Numbers are LEB128 varints:
+ *
+ * header: "ESSTEETR" u32:version u32:count (u32:size name)*
+ * record: cycle_delta time_delta:zigzag changes (index_delta size value)*
+ */
+
+#include <rt/trace.h>
+#include <elements/ivariable.h>
+#include <util/checkpoint.h>
+#include <util/macros.h>
+#include <esstee/flags.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_MAGIC "ESSTEETR"
+#define TRACE_VERSION 1
+
+#define TRACE_FILE_BUFFER_SIZE (1 << 20)
+
+/* Enough for the cycle, time and change count of a record */
+#define RECORD_HEADER_MAX_SIZE 30
+
+struct traced_variable_t {
+    char *name;
+    const struct variable_iface_t *variable;
+    struct st_buffer_t last;
+};
+
+struct trace_recorder_t {
+    struct trace_recorder_iface_t recorder;
+    FILE *fp;
+    char *path;
+    char *file_buffer;
+    struct traced_variable_t *variables;
+    size_t variable_count;
+    size_t variable_capacity;
+    struct st_buffer_t scratch;
+    struct checkpoint_iface_t *scratch_writer;
+    struct st_buffer_t changes;
+    uint64_t cycle;
+    uint64_t time_ms;
+    uint64_t recorded_cycle;
+    uint64_t recorded_time_ms;
+    int began;
+};
+
+struct trace_reader_t {
+    struct trace_reader_iface_t reader;
+    char *bytes;
+    size_t size;
+    size_t records_offset;
+    size_t offset;
+    char **names;
+    struct st_buffer_t *values;
+    unsigned char *changed;
+    size_t variable_count;
+    uint64_t cycle;
+    uint64_t time_ms;
+    int applied;
+};
+
+/**************************************************************************/
+/* Help functions                                                         */
+/**************************************************************************/
+static int buffer_append(
+    struct st_buffer_t *buffer,
+    const void *bytes,
+    size_t size,
+    struct issues_iface_t *issues)
+{
+    if(buffer->capacity - buffer->size < size)
+    {
+	size_t capacity = (buffer->capacity > 0) ? buffer->capacity : 64;
+	while(capacity - buffer->size < size)
+	{
+	    capacity *= 2;
+	}
+
+	char *grown = (char *)realloc(buffer->bytes, capacity);
+	if(!grown)
+	{
+	    issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	    return ESSTEE_ERROR;
+	}
+
+	buffer->bytes = grown;
+	buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->bytes + buffer->size, bytes, size);
+    buffer->size += size;
+
+    return ESSTEE_OK;
+}
+
+static size_t encode_varint(
+    uint64_t value,
+    unsigned char *bytes)
+{
+    size_t size = 0;
+    while(value >= 0x80)
+    {
+	bytes[size++] = (unsigned char)(value | 0x80);
+	value >>= 7;
+    }
+    bytes[size++] = (unsigned char)value;
+
+    return size;
+}
+
+static int append_varint(
+    struct st_buffer_t *buffer,
+    uint64_t value,
+    struct issues_iface_t *issues)
+{
+    unsigned char bytes[10];
+    size_t size = encode_varint(value, bytes);
+
+    return buffer_append(buffer, bytes, size, issues);
+}
+
+static int decode_varint(
+    const struct trace_reader_t *tr,
+    size_t *offset,
+    uint64_t *value)
+{
+    *value = 0;
+    for(int shift = 0; shift < 64 && *offset < tr->size; shift += 7)
+    {
+	unsigned char byte = (unsigned char)tr->bytes[(*offset)++];
+	*value |= (uint64_t)(byte & 0x7f) << shift;
+
+	if(!(byte & 0x80))
+	{
+	    return ESSTEE_OK;
+	}
+    }
+
+    return ESSTEE_ERROR;
+}
+
+static uint64_t zigzag_encode(
+    int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(
+    uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**************************************************************************/
+/* Recorder interface                                                     */
+/**************************************************************************/
+static int write_record(
+    struct trace_recorder_t *tr,
+    uint64_t time_ms,
+    uint64_t changes,
+    struct issues_iface_t *issues)
+{
+    unsigned char header[RECORD_HEADER_MAX_SIZE];
+    size_t header_size = 0;
+
+    header_size += encode_varint(tr->cycle - tr->recorded_cycle,
+				 header + header_size);
+    header_size += encode_varint(zigzag_encode((int64_t)(time_ms - tr->recorded_time_ms)),
+				 header + header_size);
+    header_size += encode_varint(changes, header + header_size);
+
+    if(fwrite(header, 1, header_size, tr->fp) != header_size
+       || fwrite(tr->changes.bytes, 1, tr->changes.size, tr->fp) != tr->changes.size)
+    {
+	issues->new_issue(issues,
+			  "failed writing trace file '%s'",
+			  ESSTEE_IO_ERROR,
+			  tr->path);
+	return ESSTEE_ERROR;
+    }
+
+    tr->recorded_cycle = tr->cycle;
+    tr->recorded_time_ms = time_ms;
+
+    return ESSTEE_OK;
+}
+
+/* Collects the values that changed since the last record */
+static int collect_changes(
+    struct trace_recorder_t *tr,
+    uint64_t *changes,
+    struct issues_iface_t *issues)
+{
+    size_t last_index = 0;
+    
+    *changes = 0;
+    tr->changes.size = 0;
+    
+    for(size_t i = 0; i < tr->variable_count; i++)
+    {
+	struct traced_variable_t *tv = &(tr->variables[i]);
+
+	tr->scratch.size = 0;
+	if(tv->variable->checkpoint(tv->variable, tr->scratch_writer, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+
+	if(tr->began
+	   && tv->last.size == tr->scratch.size
+	   && memcmp(tv->last.bytes, tr->scratch.bytes, tr->scratch.size) == 0)
+	{
+	    continue;
+	}
+
+	tv->last.size = 0;
+	if(buffer_append(&(tv->last), tr->scratch.bytes, tr->scratch.size, issues) != ESSTEE_OK
+	   || append_varint(&(tr->changes), i - last_index, issues) != ESSTEE_OK
+	   || append_varint(&(tr->changes), tr->scratch.size, issues) != ESSTEE_OK
+	   || buffer_append(&(tr->changes), tr->scratch.bytes, tr->scratch.size, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+
+	last_index = i;
+	(*changes)++;
+    }
+
+    return ESSTEE_OK;
+}
+
+static int trace_recorder_add_variable(
+    struct trace_recorder_iface_t *self,
+    const char *name,
+    const struct variable_iface_t *variable,
+    struct issues_iface_t *issues)
+{
+    struct trace_recorder_t *tr =
+	CONTAINER_OF(self, struct trace_recorder_t, recorder);
+
+    if(tr->began)
+    {
+	issues->new_issue(issues,
+			  "variables cannot be added to a trace that has begun",
+			  ESSTEE_CONTEXT_ERROR);
+	return ESSTEE_ERROR;
+    }
+    
+    if(!variable->checkpoint)
+    {
+	issues->new_issue(issues,
+			  "variable '%s' cannot be traced",
+			  ESSTEE_ARGUMENT_ERROR,
+			  name);
+	return ESSTEE_ERROR;
+    }
+
+    if(tr->variable_count == tr->variable_capacity)
+    {
+	size_t capacity = (tr->variable_capacity > 0) ? 2 * tr->variable_capacity : 16;
+	struct traced_variable_t *grown = (struct traced_variable_t *)
+	    realloc(tr->variables, capacity * sizeof(struct traced_variable_t));
+	if(!grown)
+	{
+	    issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	    return ESSTEE_ERROR;
+	}
+
+	tr->variables = grown;
+	tr->variable_capacity = capacity;
+    }
+
+    struct traced_variable_t *tv = &(tr->variables[tr->variable_count]);
+    tv->name = strdup(name);
+    if(!tv->name)
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	return ESSTEE_ERROR;
+    }
+    
+    tv->variable = variable;
+    tv->last.bytes = NULL;
+    tv->last.size = 0;
+    tv->last.capacity = 0;
+    tr->variable_count++;
+
+    return ESSTEE_OK;
+}
+
+static int trace_recorder_begin(
+    struct trace_recorder_iface_t *self,
+    uint64_t time_ms,
+    struct issues_iface_t *issues)
+{
+    struct trace_recorder_t *tr =
+	CONTAINER_OF(self, struct trace_recorder_t, recorder);
+
+    uint32_t version = TRACE_VERSION;
+    uint32_t count = (uint32_t)tr->variable_count;
+    
+    if(fwrite(TRACE_MAGIC, 1, 8, tr->fp) != 8
+       || fwrite(&version, sizeof(version), 1, tr->fp) != 1
+       || fwrite(&count, sizeof(count), 1, tr->fp) != 1)
+    {
+	goto error_write;
+    }
+
+    for(size_t i = 0; i < tr->variable_count; i++)
+    {
+	uint32_t name_size = (uint32_t)strlen(tr->variables[i].name);
+	if(fwrite(&name_size, sizeof(name_size), 1, tr->fp) != 1
+	   || fwrite(tr->variables[i].name, 1, name_size, tr->fp) != name_size)
+	{
+	    goto error_write;
+	}
+    }
+
+    uint64_t changes = 0;
+    if(collect_changes(tr, &changes, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    tr->cycle = 0;
+    tr->time_ms = time_ms;
+    tr->recorded_cycle = 0;
+    tr->recorded_time_ms = 0;
+    tr->began = ESSTEE_TRUE;
+
+    return write_record(tr, time_ms, changes, issues);
+
+error_write:
+    issues->new_issue(issues,
+		      "failed writing trace file '%s'",
+		      ESSTEE_IO_ERROR,
+		      tr->path);
+    return ESSTEE_ERROR;
+}
+
+static int trace_recorder_record(
+    struct trace_recorder_iface_t *self,
+    uint64_t time_ms,
+    struct issues_iface_t *issues)
+{
+    struct trace_recorder_t *tr =
+	CONTAINER_OF(self, struct trace_recorder_t, recorder);
+
+    tr->cycle++;
+    tr->time_ms = time_ms;
+
+    uint64_t changes = 0;
+    if(collect_changes(tr, &changes, issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(changes == 0)
+    {
+	return ESSTEE_OK;
+    }
+
+    return write_record(tr, time_ms, changes, issues);
+}
+
+static int trace_recorder_end(
+    struct trace_recorder_iface_t *self,
+    struct issues_iface_t *issues)
+{
+    struct trace_recorder_t *tr =
+	CONTAINER_OF(self, struct trace_recorder_t, recorder);
+
+    int end_result = ESSTEE_OK;
+    
+    if(tr->began && tr->cycle != tr->recorded_cycle)
+    {
+	tr->changes.size = 0;
+	end_result = write_record(tr, tr->time_ms, 0, issues);
+    }
+
+    if(fclose(tr->fp) != 0 && end_result == ESSTEE_OK)
+    {
+	issues->new_issue(issues,
+			  "failed writing trace file '%s'",
+			  ESSTEE_IO_ERROR,
+			  tr->path);
+	end_result = ESSTEE_ERROR;
+    }
+    tr->fp = NULL;
+
+    return end_result;
+}
+
+static void trace_recorder_destroy(
+    struct trace_recorder_iface_t *self)
+{
+    struct trace_recorder_t *tr =
+	CONTAINER_OF(self, struct trace_recorder_t, recorder);
+
+    if(tr->fp)
+    {
+	fclose(tr->fp);
+    }
+
+    for(size_t i = 0; i < tr->variable_count; i++)
+    {
+	free(tr->variables[i].name);
+	free(tr->variables[i].last.bytes);
+    }
+
+    if(tr->scratch_writer)
+    {
+	tr->scratch_writer->destroy(tr->scratch_writer);
+    }
+    
+    free(tr->variables);
+    free(tr->scratch.bytes);
+    free(tr->changes.bytes);
+    free(tr->file_buffer);
+    free(tr->path);
+    free(tr);
+}
+
+/**************************************************************************/
+/* Reader interface                                                       */
+/**************************************************************************/
+static size_t trace_reader_variable_count(
+    const struct trace_reader_iface_t *self)
+{
+    const struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    return tr->variable_count;
+}
+
+static const char * trace_reader_variable_name(
+    const struct trace_reader_iface_t *self,
+    size_t index)
+{
+    const struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    return (index < tr->variable_count) ? tr->names[index] : NULL;
+}
+
+static int trace_reader_next_record(
+    struct trace_reader_iface_t *self,
+    struct issues_iface_t *issues)
+{
+    struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    if(tr->offset >= tr->size)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    uint64_t cycle_delta = 0, time_delta = 0, changes = 0;
+    if(decode_varint(tr, &(tr->offset), &cycle_delta) != ESSTEE_OK
+       || decode_varint(tr, &(tr->offset), &time_delta) != ESSTEE_OK
+       || decode_varint(tr, &(tr->offset), &changes) != ESSTEE_OK)
+    {
+	goto error_truncated;
+    }
+
+    memset(tr->changed, 0, tr->variable_count);
+    
+    size_t index = 0;
+    for(uint64_t i = 0; i < changes; i++)
+    {
+	uint64_t index_delta = 0, size = 0;
+	if(decode_varint(tr, &(tr->offset), &index_delta) != ESSTEE_OK
+	   || decode_varint(tr, &(tr->offset), &size) != ESSTEE_OK
+	   || size > tr->size - tr->offset)
+	{
+	    goto error_truncated;
+	}
+
+	index += index_delta;
+	if(index >= tr->variable_count)
+	{
+	    goto error_truncated;
+	}
+
+	tr->values[index].size = 0;
+	if(buffer_append(&(tr->values[index]), tr->bytes + tr->offset, size, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+	tr->offset += size;
+	tr->changed[index] = 1;
+    }
+
+    tr->cycle += cycle_delta;
+    tr->time_ms += zigzag_decode(time_delta);
+    tr->applied = ESSTEE_TRUE;
+    
+    return ESSTEE_TRUE;
+
+error_truncated:
+    issues->new_issue(issues,
+		      "trace is truncated or corrupt",
+		      ESSTEE_ARGUMENT_ERROR);
+    return ESSTEE_ERROR;
+}
+
+static int trace_reader_seek(
+    struct trace_reader_iface_t *self,
+    uint64_t cycle,
+    struct issues_iface_t *issues)
+{
+    struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    if(tr->applied && cycle < tr->cycle)
+    {
+	tr->offset = tr->records_offset;
+	tr->cycle = 0;
+	tr->time_ms = 0;
+	tr->applied = ESSTEE_FALSE;
+	for(size_t i = 0; i < tr->variable_count; i++)
+	{
+	    tr->values[i].size = 0;
+	}
+    }
+
+    while(tr->offset < tr->size)
+    {
+	size_t peek = tr->offset;
+	uint64_t cycle_delta = 0;
+	if(decode_varint(tr, &peek, &cycle_delta) != ESSTEE_OK)
+	{
+	    break;
+	}
+
+	if(tr->applied && tr->cycle + cycle_delta > cycle)
+	{
+	    break;
+	}
+
+	if(self->next_record(self, issues) == ESSTEE_ERROR)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+static uint64_t trace_reader_cycle(
+    const struct trace_reader_iface_t *self)
+{
+    const struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    return tr->cycle;
+}
+
+static uint64_t trace_reader_time_ms(
+    const struct trace_reader_iface_t *self)
+{
+    const struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    return tr->time_ms;
+}
+
+static int trace_reader_changed(
+    const struct trace_reader_iface_t *self,
+    size_t index)
+{
+    const struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    return (index < tr->variable_count && tr->changed[index]) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+static int trace_reader_restore_variable(
+    const struct trace_reader_iface_t *self,
+    size_t index,
+    struct variable_iface_t *variable,
+    struct issues_iface_t *issues)
+{
+    const struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    if(index >= tr->variable_count || tr->values[index].size == 0)
+    {
+	issues->new_issue(issues,
+			  "trace holds no value to restore",
+			  ESSTEE_ARGUMENT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    if(!variable->restore)
+    {
+	issues->new_issue(issues,
+			  "variable '%s' cannot be restored",
+			  ESSTEE_ARGUMENT_ERROR,
+			  variable->identifier);
+	return ESSTEE_ERROR;
+    }
+
+    struct checkpoint_iface_t *checkpoint =
+	st_new_checkpoint_reader(&(tr->values[index]), issues);
+    if(!checkpoint)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int restore_result = variable->restore(variable, checkpoint, issues);
+    checkpoint->destroy(checkpoint);
+
+    return restore_result;
+}
+
+static void trace_reader_destroy(
+    struct trace_reader_iface_t *self)
+{
+    struct trace_reader_t *tr =
+	CONTAINER_OF(self, struct trace_reader_t, reader);
+
+    for(size_t i = 0; i < tr->variable_count; i++)
+    {
+	if(tr->names)
+	{
+	    free(tr->names[i]);
+	}
+	if(tr->values)
+	{
+	    free(tr->values[i].bytes);
+	}
+    }
+
+    free(tr->names);
+    free(tr->values);
+    free(tr->changed);
+    free(tr->bytes);
+    free(tr);
+}
+
+/**************************************************************************/
+/* Public interface                                                       */
+/**************************************************************************/
+struct trace_recorder_iface_t * st_new_trace_recorder(
+    const char *path,
+    struct issues_iface_t *issues)
+{
+    struct trace_recorder_t *tr = NULL;
+    
+    ALLOC_OR_ERROR_JUMP(
+	tr,
+	struct trace_recorder_t,
+	issues,
+	error_free_resources);
+
+    memset(tr, 0, sizeof(struct trace_recorder_t));
+
+    tr->path = strdup(path);
+    tr->file_buffer = (char *)malloc(TRACE_FILE_BUFFER_SIZE);
+    tr->scratch_writer = st_new_checkpoint_writer(&(tr->scratch), issues);
+    if(!(tr->path && tr->file_buffer && tr->scratch_writer))
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
+
+    tr->fp = fopen(path, "wb");
+    if(!tr->fp)
+    {
+	issues->new_issue(issues,
+			  "unable to open trace file '%s' for writing",
+			  ESSTEE_IO_ERROR,
+			  path);
+	goto error_free_resources;
+    }
+    setvbuf(tr->fp, tr->file_buffer, _IOFBF, TRACE_FILE_BUFFER_SIZE);
+    
+    tr->recorder.add_variable = trace_recorder_add_variable;
+    tr->recorder.begin = trace_recorder_begin;
+    tr->recorder.record = trace_recorder_record;
+    tr->recorder.end = trace_recorder_end;
+    tr->recorder.destroy = trace_recorder_destroy;
+
+    return &(tr->recorder);
+
+error_free_resources:
+    if(tr)
+    {
+	trace_recorder_destroy(&(tr->recorder));
+    }
+    return NULL;
+}
+
+struct trace_reader_iface_t * st_new_trace_reader(
+    const char *path,
+    struct issues_iface_t *issues)
+{
+    struct trace_reader_t *tr = NULL;
+    FILE *fp = NULL;
+    
+    ALLOC_OR_ERROR_JUMP(
+	tr,
+	struct trace_reader_t,
+	issues,
+	error_free_resources);
+
+    memset(tr, 0, sizeof(struct trace_reader_t));
+
+    fp = fopen(path, "rb");
+    if(!fp)
+    {
+	issues->new_issue(issues,
+			  "unable to open trace file '%s'",
+			  ESSTEE_IO_ERROR,
+			  path);
+	goto error_free_resources;
+    }
+
+    if(fseek(fp, 0, SEEK_END) != 0)
+    {
+	goto error_read;
+    }
+    long size = ftell(fp);
+    if(size < 0 || fseek(fp, 0, SEEK_SET) != 0)
+    {
+	goto error_read;
+    }
+
+    tr->size = (size_t)size;
+    tr->bytes = (char *)malloc(tr->size + 1);
+    if(!tr->bytes)
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
+    
+    if(fread(tr->bytes, 1, tr->size, fp) != tr->size)
+    {
+	goto error_read;
+    }
+    fclose(fp);
+    fp = NULL;
+
+    uint32_t version = 0, count = 0;
+    size_t offset = 8 + sizeof(version) + sizeof(count);
+    if(tr->size < offset || memcmp(tr->bytes, TRACE_MAGIC, 8) != 0)
+    {
+	goto error_format;
+    }
+    memcpy(&version, tr->bytes + 8, sizeof(version));
+    memcpy(&count, tr->bytes + 8 + sizeof(version), sizeof(count));
+    if(version != TRACE_VERSION)
+    {
+	goto error_format;
+    }
+    
+    tr->variable_count = count;
+    tr->names = (char **)calloc(count + 1, sizeof(char *));
+    tr->values = (struct st_buffer_t *)calloc(count + 1, sizeof(struct st_buffer_t));
+    tr->changed = (unsigned char *)calloc(count + 1, 1);
+    if(!(tr->names && tr->values && tr->changed))
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+	uint32_t name_size = 0;
+	if(tr->size - offset < sizeof(name_size))
+	{
+	    goto error_format;
+	}
+	memcpy(&name_size, tr->bytes + offset, sizeof(name_size));
+	offset += sizeof(name_size);
+
+	if(tr->size - offset < name_size)
+	{
+	    goto error_format;
+	}
+
+	tr->names[i] = strndup(tr->bytes + offset, name_size);
+	if(!tr->names[i])
+	{
+	    issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	    goto error_free_resources;
+	}
+	offset += name_size;
+    }
+
+    tr->records_offset = offset;
+    tr->offset = offset;
+
+    tr->reader.variable_count = trace_reader_variable_count;
+    tr->reader.variable_name = trace_reader_variable_name;
+    tr->reader.next_record = trace_reader_next_record;
+    tr->reader.seek = trace_reader_seek;
+    tr->reader.cycle = trace_reader_cycle;
+    tr->reader.time_ms = trace_reader_time_ms;
+    tr->reader.changed = trace_reader_changed;
+    tr->reader.restore_variable = trace_reader_restore_variable;
+    tr->reader.destroy = trace_reader_destroy;
+
+    return &(tr->reader);
+
+error_format:
+    issues->new_issue(issues,
+		      "'%s' is not a valid trace file",
+		      ESSTEE_ARGUMENT_ERROR,
+		      path);
+    goto error_free_resources;
+    
+error_read:
+    issues->new_issue(issues,
+		      "failed reading trace file '%s'",
+		      ESSTEE_IO_ERROR,
+		      path);
+    
+error_free_resources:
+    if(fp)
+    {
+	fclose(fp);
+    }
+    if(tr)
+    {
+	trace_reader_destroy(&(tr->reader));
+    }
+    return NULL;
+}
@@ -0,0 +1,462 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Watched variables are marked by their own write paths, so notifying
+ * only visits the variables modified since the last notification. A
+ * marked variable is reported when its checkpointed value differs
+ * from the one last reported, writing an equal value is not a
+ * change. */
+
+#include <rt/watcher.h>
+#include <util/checkpoint.h>
+#include <util/macros.h>
+#include <esstee/flags.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <utlist.h>
+#include <uthash.h>
+
+#define WATCH_DISPLAY_SIZE 256
+
+struct watched_variable_t;
+
+struct watch_subscription_t {
+    char *identifier;
+    st_watch_callback_t callback;
+    void *user_data;
+    struct watched_variable_t *watched;
+    UT_hash_handle hh;
+    struct watch_subscription_t *prev;
+    struct watch_subscription_t *next;
+};
+
+struct watched_variable_t {
+    struct variable_watch_t watch;
+    struct watcher_t *watcher;
+    struct variable_iface_t *variable;
+    int dirty;
+    struct watched_variable_t *dirty_next;
+    struct st_buffer_t last;
+    struct watch_subscription_t *subscriptions;
+    struct watched_variable_t *prev;
+    struct watched_variable_t *next;
+};
+
+struct watcher_t {
+    struct watcher_iface_t watcher;
+    struct watch_subscription_t *subscriptions; /* Table by identifier */
+    struct watched_variable_t *variables;
+    struct watched_variable_t *dirty;   /* Modified since notified */
+    struct watched_variable_t **dirty_last;
+    struct st_buffer_t scratch;
+    struct checkpoint_iface_t *scratch_writer;
+    char display[WATCH_DISPLAY_SIZE];
+};
+
+/**************************************************************************/
+/* Help functions                                                         */
+/**************************************************************************/
+static int checkpoint_to_scratch(
+    struct watcher_t *w,
+    const struct variable_iface_t *variable,
+    struct issues_iface_t *issues)
+{
+    w->scratch.size = 0;
+    return variable->checkpoint(variable, w->scratch_writer, issues);
+}
+
+static int keep_scratch(
+    struct watcher_t *w,
+    struct watched_variable_t *wv,
+    struct issues_iface_t *issues)
+{
+    if(wv->last.capacity < w->scratch.size)
+    {
+	char *grown = (char *)realloc(wv->last.bytes, w->scratch.size);
+	if(!grown)
+	{
+	    issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	    return ESSTEE_ERROR;
+	}
+
+	wv->last.bytes = grown;
+	wv->last.capacity = w->scratch.size;
+    }
+
+    memcpy(wv->last.bytes, w->scratch.bytes, w->scratch.size);
+    wv->last.size = w->scratch.size;
+
+    return ESSTEE_OK;
+}
+
+static void unlink_dirty(
+    struct watcher_t *w,
+    struct watched_variable_t *wv)
+{
+    struct watched_variable_t **itr = &(w->dirty);
+    while(*itr && *itr != wv)
+    {
+	itr = &((*itr)->dirty_next);
+    }
+
+    if(*itr)
+    {
+	*itr = wv->dirty_next;
+	if(w->dirty_last == &(wv->dirty_next))
+	{
+	    w->dirty_last = itr;
+	}
+    }
+}
+
+/* Appends the variable to the dirty list, once until the watcher has
+ * been notified */
+static void watched_variable_modified(
+    struct variable_watch_t *self,
+    const struct value_iface_t *written)
+{
+    struct watched_variable_t *wv =
+	CONTAINER_OF(self, struct watched_variable_t, watch);
+
+    if(!wv->dirty)
+    {
+	wv->dirty = 1;
+	wv->dirty_next = NULL;
+	*(wv->watcher->dirty_last) = wv;
+	wv->watcher->dirty_last = &(wv->dirty_next);
+    }
+}
+
+/* A variable watched under several identifiers, e.g. a global and an
+ * external alias of it, has a single watch of the watcher */
+static struct watched_variable_t * find_watched(
+    struct variable_iface_t *variable)
+{
+    struct variable_watch_t *itr = NULL;
+    for(itr = variable->watched_by(variable); itr != NULL; itr = itr->next)
+    {
+	if(itr->modified == watched_variable_modified)
+	{
+	    return CONTAINER_OF(itr, struct watched_variable_t, watch);
+	}
+    }
+
+    return NULL;
+}
+
+static void free_watched_variable(
+    struct watched_variable_t *wv)
+{
+    wv->variable->remove_watch(wv->variable, &(wv->watch));
+    free(wv->last.bytes);
+    free(wv);
+}
+
+static const char * display_value(
+    struct watcher_t *w,
+    struct variable_iface_t *variable,
+    const struct config_iface_t *config)
+{
+    const struct value_iface_t *value = variable->value(variable);
+
+    if(!value->display)
+    {
+	return NULL;
+    }
+
+    int display_result = value->display(value,
+					 w->display,
+					 WATCH_DISPLAY_SIZE,
+					 config);
+    if(display_result < 0)
+    {
+	return NULL;
+    }
+
+    w->display[WATCH_DISPLAY_SIZE-1] = '\0';
+    return w->display;
+}
+
+/**************************************************************************/
+/* Watcher interface                                                      */
+/**************************************************************************/
+static int watcher_watch(
+    struct watcher_iface_t *self,
+    const char *identifier,
+    struct variable_iface_t *variable,
+    st_watch_callback_t callback,
+    void *user_data,
+    struct issues_iface_t *issues)
+{
+    struct watcher_t *w =
+	CONTAINER_OF(self, struct watcher_t, watcher);
+
+    struct watch_subscription_t *ws = NULL;
+    struct watched_variable_t *wv = NULL;
+    
+    HASH_FIND_STR(w->subscriptions, identifier, ws);
+    if(ws)
+    {
+	issues->new_issue(issues,
+			  "'%s' is already watched",
+			  ESSTEE_ARGUMENT_ERROR,
+			  identifier);
+	return ESSTEE_ERROR;
+    }
+
+    if(!variable->checkpoint || !variable->watched_by)
+    {
+	issues->new_issue(issues,
+			  "variable '%s' cannot be watched",
+			  ESSTEE_ARGUMENT_ERROR,
+			  identifier);
+	return ESSTEE_ERROR;
+    }
+
+    ALLOC_OR_ERROR_JUMP(
+	ws,
+	struct watch_subscription_t,
+	issues,
+	error_free_resources);
+
+    ws->identifier = strdup(identifier);
+    if(!ws->identifier)
+    {
+	issues->memory_error(issues, __FILE__, __FUNCTION__, __LINE__);
+	goto error_free_resources;
+    }
+    ws->callback = callback;
+    ws->user_data = user_data;
+
+    ws->watched = find_watched(variable);
+    if(!ws->watched)
+    {
+	ALLOC_OR_ERROR_JUMP(
+	    wv,
+	    struct watched_variable_t,
+	    issues,
+	    error_free_resources);
+
+	memset(wv, 0, sizeof(struct watched_variable_t));
+	wv->watch.modified = watched_variable_modified;
+	wv->watcher = w;
+	wv->variable = variable;
+
+	if(checkpoint_to_scratch(w, variable, issues) != ESSTEE_OK
+	   || keep_scratch(w, wv, issues) != ESSTEE_OK)
+	{
+	    goto error_free_resources;
+	}
+
+	variable->add_watch(variable, &(wv->watch));
+	DL_APPEND(w->variables, wv);
+	ws->watched = wv;
+    }
+
+    DL_APPEND(ws->watched->subscriptions, ws);
+    HASH_ADD_KEYPTR(hh,
+		    w->subscriptions,
+		    ws->identifier,
+		    strlen(ws->identifier),
+		    ws);
+
+    return ESSTEE_OK;
+
+error_free_resources:
+    if(ws)
+    {
+	free(ws->identifier);
+    }
+    free(ws);
+    if(wv)
+    {
+	free(wv->last.bytes);
+    }
+    free(wv);
+    return ESSTEE_ERROR;
+}
+
+static int watcher_unwatch(
+    struct watcher_iface_t *self,
+    const char *identifier,
+    struct issues_iface_t *issues)
+{
+    struct watcher_t *w =
+	CONTAINER_OF(self, struct watcher_t, watcher);
+
+    struct watch_subscription_t *ws = NULL;
+    HASH_FIND_STR(w->subscriptions, identifier, ws);
+    if(!ws)
+    {
+	issues->new_issue(issues,
+			  "'%s' is not watched",
+			  ESSTEE_ARGUMENT_ERROR,
+			  identifier);
+	return ESSTEE_ERROR;
+    }
+
+    struct watched_variable_t *wv = ws->watched;
+    
+    HASH_DEL(w->subscriptions, ws);
+    DL_DELETE(wv->subscriptions, ws);
+    free(ws->identifier);
+    free(ws);
+
+    if(!wv->subscriptions)
+    {
+	if(wv->dirty)
+	{
+	    unlink_dirty(w, wv);
+	}
+
+	DL_DELETE(w->variables, wv);
+	free_watched_variable(wv);
+    }
+
+    return ESSTEE_OK;
+}
+
+static int watcher_notify(
+    struct watcher_iface_t *self,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct watcher_t *w =
+	CONTAINER_OF(self, struct watcher_t, watcher);
+
+    int notify_result = ESSTEE_OK;
+    
+    /* The list is taken before calling back, and every entry is
+     * cleared also on errors, so later writes queue them again */
+    struct watched_variable_t *itr = w->dirty;
+    w->dirty = NULL;
+    w->dirty_last = &(w->dirty);
+    
+    while(itr)
+    {
+	struct watched_variable_t *wv = itr;
+	itr = itr->dirty_next;
+	wv->dirty = 0;
+	wv->dirty_next = NULL;
+	
+	if(checkpoint_to_scratch(w, wv->variable, issues) != ESSTEE_OK)
+	{
+	    notify_result = ESSTEE_ERROR;
+	    continue;
+	}
+
+	if(wv->last.size == w->scratch.size
+	   && memcmp(wv->last.bytes, w->scratch.bytes, w->scratch.size) == 0)
+	{
+	    continue;
+	}
+
+	if(keep_scratch(w, wv, issues) != ESSTEE_OK)
+	{
+	    notify_result = ESSTEE_ERROR;
+	    continue;
+	}
+
+	const char *display = display_value(w, wv->variable, config);
+
+	struct watch_subscription_t *sitr = NULL;
+	DL_FOREACH(wv->subscriptions, sitr)
+	{
+	    sitr->callback(sitr->identifier, display, sitr->user_data);
+	}
+    }
+
+    return notify_result;
+}
+
+static int watcher_watching(
+    const struct watcher_iface_t *self)
+{
+    const struct watcher_t *w =
+	CONTAINER_OF(self, struct watcher_t, watcher);
+
+    return (w->subscriptions) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+static void watcher_destroy(
+    struct watcher_iface_t *self)
+{
+    struct watcher_t *w =
+	CONTAINER_OF(self, struct watcher_t, watcher);
+
+    struct watch_subscription_t *sitr = NULL, *stmp = NULL;
+    HASH_ITER(hh, w->subscriptions, sitr, stmp)
+    {
+	HASH_DEL(w->subscriptions, sitr);
+	free(sitr->identifier);
+	free(sitr);
+    }
+
+    struct watched_variable_t *vitr = NULL, *vtmp = NULL;
+    DL_FOREACH_SAFE(w->variables, vitr, vtmp)
+    {
+	DL_DELETE(w->variables, vitr);
+	free_watched_variable(vitr);
+    }
+
+    if(w->scratch_writer)
+    {
+	w->scratch_writer->destroy(w->scratch_writer);
+    }
+    free(w->scratch.bytes);
+    free(w);
+}
+
+/**************************************************************************/
+/* Public interface                                                       */
+/**************************************************************************/
+struct watcher_iface_t * st_new_watcher(
+    struct issues_iface_t *issues)
+{
+    struct watcher_t *w = NULL;
+    
+    ALLOC_OR_ERROR_JUMP(
+	w,
+	struct watcher_t,
+	issues,
+	error_free_resources);
+
+    memset(w, 0, sizeof(struct watcher_t));
+    w->dirty_last = &(w->dirty);
+
+    w->scratch_writer = st_new_checkpoint_writer(&(w->scratch), issues);
+    if(!w->scratch_writer)
+    {
+	goto error_free_resources;
+    }
+
+    w->watcher.watch = watcher_watch;
+    w->watcher.unwatch = watcher_unwatch;
+    w->watcher.notify = watcher_notify;
+    w->watcher.watching = watcher_watching;
+    w->watcher.destroy = watcher_destroy;
+
+    return &(w->watcher);
+
+error_free_resources:
+    free(w);
+    return NULL;
+}
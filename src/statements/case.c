@@ -19,9 +19,12 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <statements/case.h>
 #include <statements/statements.h>
+#include <elements/subrange_case.h>
+#include <elements/enums.h>
 #include <util/macros.h>
 
 #include <utlist.h>
+#include <stdlib.h>
 
 struct case_list_element_t {
     struct value_iface_t *value;
@@ -38,6 +41,316 @@ struct case_t {
     struct case_t *next;
 };
 
+/**************************************************************************/
+/* Dispatch                                                               */
+/**************************************************************************/
+#define CASE_JUMP_TABLE_MAX_SPAN 65536
+#define CASE_JUMP_TABLE_SLACK 16
+
+struct case_interval_t {
+    int64_t min;
+    int64_t max;
+    int case_index;
+};
+
+/* Compiled form of the case labels of an integer or enumerated
+ * selector, the latter keyed by ordinal. Labels are resolved either
+ * through a jump table, when they are compact, or through a binary
+ * search among sorted, disjoint intervals. The dispatch refers to
+ * cases by index, so it is shared among clones of the case
+ * statement. */
+struct case_dispatch_t {
+    int enumerated;
+    int64_t table_min;
+    uint64_t table_span;
+    int *table;
+    struct case_interval_t *intervals;
+    size_t intervals_count;
+};
+
+static int case_interval_compare(
+    const void *a,
+    const void *b)
+{
+    const struct case_interval_t *ia = (const struct case_interval_t *)a;
+    const struct case_interval_t *ib = (const struct case_interval_t *)b;
+
+    if(ia->min < ib->min)
+    {
+	return -1;
+    }
+    else if(ia->min > ib->min)
+    {
+	return 1;
+    }
+
+    return ia->case_index - ib->case_index;
+}
+
+static int case_dispatch_lookup(
+    const struct case_dispatch_t *dispatch,
+    int64_t key)
+{
+    if(dispatch->table)
+    {
+	uint64_t offset = (uint64_t)key - (uint64_t)dispatch->table_min;
+	if(key < dispatch->table_min || offset >= dispatch->table_span)
+	{
+	    return -1;
+	}
+
+	return dispatch->table[offset];
+    }
+
+    size_t low = 0;
+    size_t high = dispatch->intervals_count;
+    while(low < high)
+    {
+	size_t middle = low + (high - low) / 2;
+	const struct case_interval_t *interval = dispatch->intervals + middle;
+
+	if(key < interval->min)
+	{
+	    high = middle;
+	}
+	else if(key > interval->max)
+	{
+	    low = middle + 1;
+	}
+	else
+	{
+	    return interval->case_index;
+	}
+    }
+
+    return -1;
+}
+
+static int case_label_interval(
+    const struct value_iface_t *label,
+    const struct enum_item_t *selector_item,
+    struct case_interval_t *interval,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(selector_item)
+    {
+	if(!label->enumeration)
+	{
+	    return ESSTEE_FALSE;
+	}
+
+	const struct enum_item_t *label_item = label->enumeration(label,
+								  config,
+								  issues);
+
+	interval->min = st_enum_item_ordinal(label_item, selector_item);
+	interval->max = interval->min;
+
+	return (interval->min >= 0) ? ESSTEE_TRUE : ESSTEE_FALSE;
+    }
+
+    const struct subrange_iface_t *subrange = st_subrange_case_subrange(label);
+
+    if(subrange)
+    {
+	if(!subrange->min->integer || !subrange->max->integer)
+	{
+	    return ESSTEE_FALSE;
+	}
+
+	interval->min = subrange->min->integer(subrange->min, config, issues);
+	interval->max = subrange->max->integer(subrange->max, config, issues);
+    }
+    else
+    {
+	if(!label->integer)
+	{
+	    return ESSTEE_FALSE;
+	}
+
+	interval->min = label->integer(label, config, issues);
+	interval->max = interval->min;
+    }
+
+    return (interval->min <= interval->max) ? ESSTEE_TRUE : ESSTEE_FALSE;
+}
+
+/* Gives NULL if the labels cannot be dispatched on, in which case the
+ * labels are scanned one by one instead */
+static struct case_dispatch_t * create_case_dispatch(
+    const struct value_iface_t *selector_value,
+    struct case_t *cases,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(!selector_value)
+    {
+	return NULL;
+    }
+
+    const struct enum_item_t *selector_item = NULL;
+    if(selector_value->enumeration)
+    {
+	selector_item = selector_value->enumeration(selector_value,
+						    config,
+						    issues);
+
+	if(!selector_item->group)
+	{
+	    return NULL;
+	}
+    }
+    else if(!selector_value->integer)
+    {
+	return NULL;
+    }
+
+    size_t intervals_count = 0;
+    struct case_t *case_itr = NULL;
+    DL_FOREACH(cases, case_itr)
+    {
+	struct case_list_element_t *case_list_itr = NULL;
+	DL_FOREACH(case_itr->case_list, case_list_itr)
+	{
+	    intervals_count++;
+	}
+    }
+
+    if(intervals_count == 0)
+    {
+	return NULL;
+    }
+
+    struct case_dispatch_t *dispatch = NULL;
+    struct case_interval_t *intervals = NULL;
+    int *table = NULL;
+
+    ALLOC_OR_ERROR_JUMP(
+	dispatch,
+	struct case_dispatch_t,
+	issues,
+	error_free_resources);
+
+    ALLOC_ARRAY_OR_ERROR_JUMP(
+	intervals,
+	struct case_interval_t,
+	intervals_count,
+	issues,
+	error_free_resources);
+
+    size_t interval_index = 0;
+    int case_index = 0;
+    DL_FOREACH(cases, case_itr)
+    {
+	struct case_list_element_t *case_list_itr = NULL;
+	DL_FOREACH(case_itr->case_list, case_list_itr)
+	{
+	    struct case_interval_t *interval = intervals + interval_index;
+
+	    if(case_label_interval(case_list_itr->value,
+				   selector_item,
+				   interval,
+				   config,
+				   issues) != ESSTEE_TRUE)
+	    {
+		goto error_free_resources;
+	    }
+
+	    interval->case_index = case_index;
+	    interval_index++;
+	}
+
+	case_index++;
+    }
+
+    qsort(intervals,
+	  intervals_count,
+	  sizeof(struct case_interval_t),
+	  case_interval_compare);
+
+    /* Overlapping labels are resolved by the first matching case, which
+     * the jump table can express but the binary search cannot */
+    int overlapping = 0;
+    for(size_t i = 1; i < intervals_count; i++)
+    {
+	if(intervals[i].min <= intervals[i-1].max)
+	{
+	    overlapping = 1;
+	    break;
+	}
+    }
+
+    int64_t min = intervals[0].min;
+    int64_t max = intervals[0].max;
+    for(size_t i = 1; i < intervals_count; i++)
+    {
+	if(intervals[i].max > max)
+	{
+	    max = intervals[i].max;
+	}
+    }
+
+    uint64_t span = (uint64_t)max - (uint64_t)min;
+    if(span < CASE_JUMP_TABLE_MAX_SPAN
+       && span < 4 * intervals_count + CASE_JUMP_TABLE_SLACK)
+    {
+	span++;
+
+	ALLOC_ARRAY_OR_ERROR_JUMP(
+	    table,
+	    int,
+	    span,
+	    issues,
+	    error_free_resources);
+
+	for(uint64_t i = 0; i < span; i++)
+	{
+	    table[i] = -1;
+	}
+
+	for(size_t i = 0; i < intervals_count; i++)
+	{
+	    for(int64_t k = intervals[i].min; k <= intervals[i].max; k++)
+	    {
+		int *entry = table + (k - min);
+		if(*entry < 0 || *entry > intervals[i].case_index)
+		{
+		    *entry = intervals[i].case_index;
+		}
+	    }
+	}
+
+	free(intervals);
+
+	dispatch->enumerated = (selector_item != NULL);
+	dispatch->table_min = min;
+	dispatch->table_span = span;
+	dispatch->table = table;
+	dispatch->intervals = NULL;
+	dispatch->intervals_count = 0;
+    }
+    else if(!overlapping)
+    {
+	dispatch->enumerated = (selector_item != NULL);
+	dispatch->table = NULL;
+	dispatch->intervals = intervals;
+	dispatch->intervals_count = intervals_count;
+    }
+    else
+    {
+	goto error_free_resources;
+    }
+
+    return dispatch;
+
+error_free_resources:
+    free(dispatch);
+    free(intervals);
+    free(table);
+    return NULL;
+}
+
 /**************************************************************************/
 /* Invoke interface                                                       */
 /**************************************************************************/
@@ -45,11 +358,48 @@ struct case_statement_t {
     struct invoke_iface_t invoke;
     struct expression_iface_t *selector;
     struct case_t *cases;
+    struct case_t **cases_by_index;
+    const struct case_dispatch_t *dispatch;
     struct st_location_t *location;
     struct invoke_iface_t *else_statements;
     int invoke_state;
 };
 
+static struct case_t ** create_cases_by_index(
+    struct case_t *cases,
+    struct issues_iface_t *issues)
+{
+    size_t cases_count = 0;
+    struct case_t *case_itr = NULL;
+    DL_FOREACH(cases, case_itr)
+    {
+	cases_count++;
+    }
+
+    /* One extra entry, so that a case statement without cases still
+     * gets an array */
+    size_t array_size = cases_count + 1;
+    struct case_t **cases_by_index = NULL;
+    ALLOC_ARRAY_OR_ERROR_JUMP(
+	cases_by_index,
+	struct case_t *,
+	array_size,
+	issues,
+	error_free_resources);
+
+    size_t case_index = 0;
+    DL_FOREACH(cases, case_itr)
+    {
+	cases_by_index[case_index] = case_itr;
+	case_index++;
+    }
+
+    return cases_by_index;
+
+error_free_resources:
+    return NULL;
+}
+
 static int selector_value_in_case_list(
     const struct value_iface_t *selector,
     struct case_list_element_t *case_list,
@@ -101,20 +451,45 @@ static int case_statement_step(
 	    cs->selector->return_value(cs->selector);
 
 	struct case_t *case_itr = NULL;
-	DL_FOREACH(cs->cases, case_itr)
+	if(cs->dispatch)
 	{
-	    int selector_in_case_result = selector_value_in_case_list(selector_value,
-								      case_itr->case_list,
-								      config,
-								      issues);
-	    
-	    if(selector_in_case_result == ESSTEE_TRUE)
+	    int64_t key;
+	    if(cs->dispatch->enumerated)
+	    {
+		key = selector_value->enumeration(selector_value,
+						  config,
+						  issues)->ordinal;
+	    }
+	    else
 	    {
-		break;
+		key = selector_value->integer(selector_value,
+					      config,
+					      issues);
 	    }
-	    else if(selector_in_case_result == ESSTEE_ERROR)
+
+	    int case_index = case_dispatch_lookup(cs->dispatch, key);
+	    if(case_index >= 0)
 	    {
-		return INVOKE_RESULT_ERROR;
+		case_itr = cs->cases_by_index[case_index];
+	    }
+	}
+	else
+	{
+	    DL_FOREACH(cs->cases, case_itr)
+	    {
+		int selector_in_case_result = selector_value_in_case_list(selector_value,
+									  case_itr->case_list,
+									  config,
+									  issues);
+	    
+		if(selector_in_case_result == ESSTEE_TRUE)
+		{
+		    break;
+		}
+		else if(selector_in_case_result == ESSTEE_ERROR)
+		{
+		    return INVOKE_RESULT_ERROR;
+		}
 	    }
 	}
 
@@ -213,6 +588,14 @@ static int case_statement_verify(
 	}
     }
 
+    if(!cs->dispatch)
+    {
+	cs->dispatch = create_case_dispatch(selector_value,
+					    cs->cases,
+					    config,
+					    issues);
+    }
+
     return ESSTEE_OK;
 }
 
@@ -386,6 +769,12 @@ static struct invoke_iface_t * case_statement_clone(
 	DL_APPEND(cases_copy, case_copy);
     }
     copy->cases = cases_copy;
+
+    copy->cases_by_index = create_cases_by_index(copy->cases, issues);
+    if(!copy->cases_by_index)
+    {
+	goto error_free_resources;
+    }
     
     struct invoke_iface_t *statement_itr = NULL;
     DL_FOREACH(cs->else_statements, statement_itr)
@@ -518,9 +907,16 @@ struct invoke_iface_t * st_create_case_statement(
 	issues,
 	error_free_resources);
 
+    cs->cases_by_index = create_cases_by_index(cases, issues);
+    if(!cs->cases_by_index)
+    {
+	goto error_free_resources;
+    }
+
     cs->location = cs_location;
     cs->selector = selector;
     cs->cases = cases;
+    cs->dispatch = NULL;
     cs->else_statements = else_statements;
 
     memset(&(cs->invoke), 0, sizeof(struct invoke_iface_t));
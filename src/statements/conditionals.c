@@ -19,6 +19,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <statements/conditionals.h>
 #include <statements/statements.h>
+#include <statements/invariants.h>
 #include <util/macros.h>
 
 #include <utlist.h>
@@ -46,10 +47,23 @@ static int if_statement_step(
     struct if_statement_t *ifs =
 	CONTAINER_OF(self, struct if_statement_t, invoke);
 
+    int current_condition = ESSTEE_FALSE;
+
     switch(ifs->invoke_state)
     {
     case 0:
-	if(ifs->condition->invoke.step)
+	if(ifs->condition->test)
+	{
+	    /* Branch on the condition without stepping it */
+	    current_condition = ifs->condition->test(ifs->condition,
+						     config,
+						     issues);
+	    if(current_condition == ESSTEE_ERROR)
+	    {
+		return INVOKE_RESULT_ERROR;
+	    }
+	}
+	else if(ifs->condition->invoke.step)
 	{
 	    ifs->invoke_state = 1;
 	    cursor->switch_current(cursor,
@@ -60,12 +74,15 @@ static int if_statement_step(
 	}
 
     case 1: {
-	const struct value_iface_t *condition_value =
-	    ifs->condition->return_value(ifs->condition);
+	if(ifs->invoke_state == 1 || !ifs->condition->test)
+	{
+	    const struct value_iface_t *condition_value =
+		ifs->condition->return_value(ifs->condition);
 
-	int current_condition = condition_value->bool(condition_value,
+	    current_condition = condition_value->bool(condition_value,
 						      config,
 						      issues);
+	}
 
 	ifs->invoke_state = 2;
 	
@@ -271,6 +288,44 @@ static int if_statement_allocate(
     return ESSTEE_OK;
 }
 
+static int if_statement_written_variables(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct if_statement_t *ifs =
+	CONTAINER_OF(self, struct if_statement_t, invoke);
+
+    if(st_loop_invariants_add_evaluated(invariants,
+					ifs->condition,
+					issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_loop_invariants_add_written_by(invariants,
+					 ifs->true_statements,
+					 issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(ifs->elsif)
+    {
+	return ifs->elsif->invoke.written_variables(&(ifs->elsif->invoke),
+						    invariants,
+						    issues);
+    }
+    else if(ifs->else_statements)
+    {
+	return st_loop_invariants_add_written_by(invariants,
+						 ifs->else_statements,
+						 issues);
+    }
+
+    return ESSTEE_OK;
+}
+
 static void if_statement_destroy(
     struct invoke_iface_t *self)
 {
@@ -421,6 +476,7 @@ struct if_statement_t * st_create_elsif_clause(
     ifs->invoke.reset = if_statement_reset;
     ifs->invoke.allocate = if_statement_allocate;
     ifs->invoke.clone = if_statement_clone;
+    ifs->invoke.written_variables = if_statement_written_variables;
 	
     return ifs;
     
@@ -498,6 +554,7 @@ struct invoke_iface_t * st_create_if_statement(
     ifs->invoke.reset = if_statement_reset;
     ifs->invoke.allocate = if_statement_allocate;
     ifs->invoke.clone = if_statement_clone;
+    ifs->invoke.written_variables = if_statement_written_variables;
     ifs->invoke.destroy = if_statement_destroy;
 	
     return &(ifs->invoke);
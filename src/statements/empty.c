@@ -64,6 +64,14 @@ static int empty_statement_post_clone(
     return ESSTEE_OK;
 }
 
+static int empty_statement_written_variables(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    return ESSTEE_OK;
+}
+
 static void empty_statement_destroy(
     struct invoke_iface_t *self)
 {
@@ -124,12 +132,14 @@ struct invoke_iface_t * st_append_empty_statement(
 	error_free_resources);
 
     es->location = es_location;
+    memset(&(es->invoke), 0, sizeof(struct invoke_iface_t));
     es->invoke.verify = empty_statement_verify;
     es->invoke.step = empty_statement_step;
     es->invoke.location = es->location;
     es->invoke.clone = empty_statement_clone;
     es->invoke.post_clone = empty_statement_post_clone;
     es->invoke.reset = empty_statement_reset;
+    es->invoke.written_variables = empty_statement_written_variables;
     es->invoke.destroy = empty_statement_destroy;
 
     DL_APPEND(statement_list, &(es->invoke));
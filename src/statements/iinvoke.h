@@ -30,6 +30,8 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #define INVOKE_RESULT_ERROR        3
 #define INVOKE_RESULT_ALL_FINISHED 4
 
+struct loop_invariants_t;
+
 struct invoke_iface_t {
 
     int (*verify)(
@@ -62,6 +64,22 @@ struct invoke_iface_t {
 	const struct config_iface_t *config,
 	struct issues_iface_t *issues);
 
+    /* Optional, adds the variables the statement may write to the
+     * invariants of an enclosing loop. A statement without it is
+     * assumed to be able to write any variable. */
+    int (*written_variables)(
+	struct invoke_iface_t *self,
+	struct loop_invariants_t *invariants,
+	struct issues_iface_t *issues);
+
+    /* Optional, hoists the expressions of the statement that are
+     * invariant in an enclosing loop. Only present in statements
+     * evaluating all of their expressions each time they run. */
+    int (*hoist_invariants)(
+	struct invoke_iface_t *self,
+	struct loop_invariants_t *invariants,
+	struct issues_iface_t *issues);
+
     void (*destroy)(
 	struct invoke_iface_t *self);
 
@@ -0,0 +1,370 @@
+/*
+Copyright (C) 2016 Kristian Nordman
+
+This file is part of esstee.
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <statements/invariants.h>
+#include <util/macros.h>
+
+#include <utlist.h>
+
+struct written_variable_t {
+    const struct variable_iface_t *variable;
+    struct written_variable_t *next;
+};
+
+struct hoisted_expression_t {
+    struct expression_iface_t *expression;
+    int (*step)(
+	struct invoke_iface_t *self,
+	struct cursor_iface_t *cursor,
+	const struct systime_iface_t *time,
+	const struct config_iface_t *config,
+	struct issues_iface_t *issues);
+    struct hoisted_expression_t *prev;
+    struct hoisted_expression_t *next;
+};
+
+struct loop_invariants_t {
+    struct written_variable_t *written;
+    int writes_unknown;
+    int writes_direct;
+    int collecting;
+    int suspended;
+    struct hoisted_expression_t *hoisted;
+    struct hoisted_expression_t *invoke_state;
+    int frozen;
+};
+
+/**************************************************************************/
+/* Public interface                                                       */
+/**************************************************************************/
+struct loop_invariants_t * st_create_loop_invariants(
+    struct issues_iface_t *issues)
+{
+    struct loop_invariants_t *li = NULL;
+
+    ALLOC_OR_ERROR_JUMP(
+	li,
+	struct loop_invariants_t,
+	issues,
+	error_free_resources);
+
+    li->written = NULL;
+    li->writes_unknown = 0;
+    li->writes_direct = 0;
+    li->collecting = 0;
+    li->suspended = 0;
+    li->hoisted = NULL;
+    li->invoke_state = NULL;
+    li->frozen = 0;
+
+    return li;
+
+error_free_resources:
+    return NULL;
+}
+
+int st_loop_invariants_add_written(
+    struct loop_invariants_t *invariants,
+    const struct variable_iface_t *variable,
+    struct issues_iface_t *issues)
+{
+    if(ST_FLAG_IS_SET(variable->class, DIRECT_VAR_CLASS))
+    {
+	invariants->writes_direct = 1;
+    }
+
+    if(st_loop_invariants_written(invariants, variable) == ESSTEE_TRUE)
+    {
+	return ESSTEE_OK;
+    }
+
+    struct written_variable_t *wv = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	wv,
+	struct written_variable_t,
+	issues,
+	error_free_resources);
+
+    wv->variable = variable;
+    LL_PREPEND(invariants->written, wv);
+
+    return ESSTEE_OK;
+
+error_free_resources:
+    return ESSTEE_ERROR;
+}
+
+int st_loop_invariants_add_written_by(
+    struct loop_invariants_t *invariants,
+    struct invoke_iface_t *statements,
+    struct issues_iface_t *issues)
+{
+    struct invoke_iface_t *itr = NULL;
+    DL_FOREACH(statements, itr)
+    {
+	if(!itr->written_variables)
+	{
+	    invariants->writes_unknown = 1;
+	    return ESSTEE_OK;
+	}
+
+	if(itr->written_variables(itr, invariants, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+int st_loop_invariants_add_evaluated(
+    struct loop_invariants_t *invariants,
+    struct expression_iface_t *expression,
+    struct issues_iface_t *issues)
+{
+    if(!expression->invariant)
+    {
+	invariants->writes_unknown = 1;
+	return ESSTEE_OK;
+    }
+
+    /* While collecting, no variable counts as written and nothing is
+     * hoisted, so only expressions with side effects are variant */
+    invariants->collecting = 1;
+    int invariant_result = expression->invariant(expression,
+						 invariants,
+						 issues);
+    invariants->collecting = 0;
+
+    if(invariant_result == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+    else if(invariant_result != ESSTEE_TRUE)
+    {
+	invariants->writes_unknown = 1;
+    }
+
+    return ESSTEE_OK;
+}
+
+int st_loop_invariants_add_evaluated_indices(
+    struct loop_invariants_t *invariants,
+    struct qualified_identifier_iface_t *qualified_identifier,
+    struct issues_iface_t *issues)
+{
+    invariants->collecting = 1;
+    int invariant_result = qualified_identifier->invariant_indices(
+	qualified_identifier,
+	invariants,
+	issues);
+    invariants->collecting = 0;
+
+    if(invariant_result == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+    else if(invariant_result != ESSTEE_TRUE)
+    {
+	invariants->writes_unknown = 1;
+    }
+
+    return ESSTEE_OK;
+}
+
+int st_loop_invariants_written(
+    const struct loop_invariants_t *invariants,
+    const struct variable_iface_t *variable)
+{
+    if(invariants->collecting)
+    {
+	return ESSTEE_FALSE;
+    }
+
+    if(invariants->writes_unknown)
+    {
+	return ESSTEE_TRUE;
+    }
+
+    if(invariants->writes_direct && ST_FLAG_IS_SET(variable->class, DIRECT_VAR_CLASS))
+    {
+	return ESSTEE_TRUE;
+    }
+
+    struct written_variable_t *itr = NULL;
+    LL_FOREACH(invariants->written, itr)
+    {
+	if(itr->variable == variable)
+	{
+	    return ESSTEE_TRUE;
+	}
+    }
+
+    return ESSTEE_FALSE;
+}
+
+int st_loop_invariants_hoist(
+    struct loop_invariants_t *invariants,
+    struct expression_iface_t *expression,
+    struct issues_iface_t *issues)
+{
+    /* Only expressions computed by steps gain from being hoisted */
+    if(invariants->collecting
+       || invariants->suspended
+       || !expression->invoke.step)
+    {
+	return ESSTEE_OK;
+    }
+
+    struct hoisted_expression_t *he = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	he,
+	struct hoisted_expression_t,
+	issues,
+	error_free_resources);
+
+    he->expression = expression;
+    he->step = expression->invoke.step;
+    DL_APPEND(invariants->hoisted, he);
+    invariants->invoke_state = invariants->hoisted;
+
+    return ESSTEE_OK;
+
+error_free_resources:
+    return ESSTEE_ERROR;
+}
+
+void st_loop_invariants_suspend(
+    struct loop_invariants_t *invariants)
+{
+    invariants->suspended++;
+}
+
+void st_loop_invariants_resume(
+    struct loop_invariants_t *invariants)
+{
+    invariants->suspended--;
+}
+
+int st_loop_invariants_hoist_from(
+    struct loop_invariants_t *invariants,
+    struct invoke_iface_t *statements,
+    struct issues_iface_t *issues)
+{
+    if(invariants->writes_unknown)
+    {
+	return ESSTEE_OK;
+    }
+
+    struct invoke_iface_t *itr = NULL;
+    DL_FOREACH(statements, itr)
+    {
+	if(!itr->hoist_invariants)
+	{
+	    continue;
+	}
+
+	if(itr->hoist_invariants(itr, invariants, issues) != ESSTEE_OK)
+	{
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+int st_loop_invariants_count(
+    const struct loop_invariants_t *invariants)
+{
+    int count = 0;
+    struct hoisted_expression_t *itr = NULL;
+    DL_COUNT(invariants->hoisted, itr, count);
+
+    return count;
+}
+
+int st_loop_invariants_step(
+    struct loop_invariants_t *invariants,
+    struct cursor_iface_t *cursor,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    if(invariants->frozen)
+    {
+	return INVOKE_RESULT_FINISHED;
+    }
+
+    if(invariants->invoke_state)
+    {
+	struct hoisted_expression_t *current = invariants->invoke_state;
+	invariants->invoke_state = current->next;
+
+	current->expression->invoke.step = current->step;
+	cursor->switch_current(cursor,
+			       &(current->expression->invoke),
+			       config,
+			       issues);
+	return INVOKE_RESULT_IN_PROGRESS;
+    }
+
+    struct hoisted_expression_t *itr = NULL;
+    DL_FOREACH(invariants->hoisted, itr)
+    {
+	itr->expression->invoke.step = NULL;
+    }
+
+    invariants->frozen = 1;
+
+    return INVOKE_RESULT_FINISHED;
+}
+
+void st_loop_invariants_release(
+    struct loop_invariants_t *invariants)
+{
+    struct hoisted_expression_t *itr = NULL;
+    DL_FOREACH(invariants->hoisted, itr)
+    {
+	itr->expression->invoke.step = itr->step;
+    }
+
+    invariants->invoke_state = invariants->hoisted;
+    invariants->frozen = 0;
+}
+
+void st_destroy_loop_invariants(
+    struct loop_invariants_t *invariants)
+{
+    struct written_variable_t *witr = NULL;
+    struct written_variable_t *wtmp = NULL;
+    LL_FOREACH_SAFE(invariants->written, witr, wtmp)
+    {
+	LL_DELETE(invariants->written, witr);
+	free(witr);
+    }
+
+    struct hoisted_expression_t *hitr = NULL;
+    struct hoisted_expression_t *htmp = NULL;
+    DL_FOREACH_SAFE(invariants->hoisted, hitr, htmp)
+    {
+	DL_DELETE(invariants->hoisted, hitr);
+	free(hitr);
+    }
+
+    free(invariants);
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (C) 2016 Kristian Nordman
+
+This file is part of esstee.
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <statements/iinvoke.h>
+#include <expressions/iexpression.h>
+#include <elements/ivariable.h>
+#include <elements/iqualified_identifier.h>
+
+/* Loop invariants are found when a loop statement is allocated. The
+ * variables written by the loop body are collected first, through the
+ * written_variables hook of each statement. If all writes are known,
+ * the invariant hooks of the expressions in the body then hoist the
+ * expressions reading none of the written variables. Variables located
+ * in direct memory may overlap, when one of them is written all of
+ * them count as written. The hoisted
+ * expressions are stepped once when the loop is entered, and are left
+ * without a step for the rest of the loop, so their return values are
+ * reused by each iteration. */
+struct loop_invariants_t;
+
+struct loop_invariants_t * st_create_loop_invariants(
+    struct issues_iface_t *issues);
+
+/* Analysis */
+int st_loop_invariants_add_written(
+    struct loop_invariants_t *invariants,
+    const struct variable_iface_t *variable,
+    struct issues_iface_t *issues);
+
+int st_loop_invariants_add_written_by(
+    struct loop_invariants_t *invariants,
+    struct invoke_iface_t *statements,
+    struct issues_iface_t *issues);
+
+/* Expressions evaluated by the loop or its statements must be free of
+ * side effects, or the writes of the loop are unknown */
+int st_loop_invariants_add_evaluated(
+    struct loop_invariants_t *invariants,
+    struct expression_iface_t *expression,
+    struct issues_iface_t *issues);
+
+int st_loop_invariants_add_evaluated_indices(
+    struct loop_invariants_t *invariants,
+    struct qualified_identifier_iface_t *qualified_identifier,
+    struct issues_iface_t *issues);
+
+/* Any variable counts as written when the writes of the loop are not
+ * all known */
+int st_loop_invariants_written(
+    const struct loop_invariants_t *invariants,
+    const struct variable_iface_t *variable);
+
+int st_loop_invariants_hoist(
+    struct loop_invariants_t *invariants,
+    struct expression_iface_t *expression,
+    struct issues_iface_t *issues);
+
+/* Hoisting is suspended while analyzing expressions that are not
+ * evaluated each time their statement runs */
+void st_loop_invariants_suspend(
+    struct loop_invariants_t *invariants);
+
+void st_loop_invariants_resume(
+    struct loop_invariants_t *invariants);
+
+int st_loop_invariants_hoist_from(
+    struct loop_invariants_t *invariants,
+    struct invoke_iface_t *statements,
+    struct issues_iface_t *issues);
+
+int st_loop_invariants_count(
+    const struct loop_invariants_t *invariants);
+
+/* Execution */
+int st_loop_invariants_step(
+    struct loop_invariants_t *invariants,
+    struct cursor_iface_t *cursor,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues);
+
+void st_loop_invariants_release(
+    struct loop_invariants_t *invariants);
+
+void st_destroy_loop_invariants(
+    struct loop_invariants_t *invariants);
@@ -82,6 +82,26 @@ static int invoke_statement_verify(
     }
     else if(is->function)
     {
+	if(is->function->overload)
+	{
+	    struct function_iface_t *variant = is->function->overload(is->function,
+								      is->parameters,
+								      issues);
+	    if(!variant)
+	    {
+		issues->new_issue_at(
+		    issues,
+		    "function cannot be invoked with the given arguments",
+		    ESSTEE_ARGUMENT_ERROR,
+		    1,
+		    is->location);
+
+		return ESSTEE_ERROR;
+	    }
+
+	    is->function = variant;
+	}
+	
 	int verify_result = is->function->verify_invoke(
 	    is->function,
 	    is->parameters,
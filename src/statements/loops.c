@@ -22,6 +22,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 #include <elements/ivariable.h>
 #include <elements/integers.h>
 #include <statements/statements.h>
+#include <statements/invariants.h>
 
 #include <utlist.h>
 
@@ -40,8 +41,88 @@ struct for_statement_t {
     struct st_location_t *identifier_location;
     int invoke_state;
     struct value_iface_t *implicit_increment;
+    struct value_iface_t *counter;
+    int64_t count;
+    int64_t count_increment;
+    uint64_t iterations_left;
+    struct loop_invariants_t *invariants;
 };
 
+/* Finds the expressions of the loop statements that are invariant in
+ * the loop. The invariants are left out when there are none. */
+static int loop_find_invariants(
+    struct invoke_iface_t *loop,
+    struct invoke_iface_t *statements,
+    struct loop_invariants_t **invariants,
+    struct issues_iface_t *issues)
+{
+    if(*invariants)
+    {
+	st_destroy_loop_invariants(*invariants);
+	*invariants = NULL;
+    }
+
+    struct loop_invariants_t *li = st_create_loop_invariants(issues);
+    if(!li)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(loop->written_variables(loop, li, issues) != ESSTEE_OK)
+    {
+	goto error_free_resources;
+    }
+
+    if(st_loop_invariants_hoist_from(li, statements, issues) != ESSTEE_OK)
+    {
+	goto error_free_resources;
+    }
+
+    if(st_loop_invariants_count(li) == 0)
+    {
+	st_destroy_loop_invariants(li);
+	return ESSTEE_OK;
+    }
+
+    *invariants = li;
+    return ESSTEE_OK;
+
+error_free_resources:
+    st_destroy_loop_invariants(li);
+    return ESSTEE_ERROR;
+}
+
+/* The iterations of a for loop can only be counted in advance when
+ * its body writes neither the variable nor anything the end value is
+ * read from */
+static int for_statement_countable(
+    struct for_statement_t *fs,
+    struct issues_iface_t *issues)
+{
+    struct loop_invariants_t *li = st_create_loop_invariants(issues);
+    if(!li)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int countable = ESSTEE_FALSE;
+    if(st_loop_invariants_add_written_by(li, fs->statements, issues) != ESSTEE_OK)
+    {
+	countable = ESSTEE_ERROR;
+    }
+    else if(st_loop_invariants_written(li, fs->variable) != ESSTEE_TRUE
+	    && fs->to->invariant)
+    {
+	st_loop_invariants_suspend(li);
+	countable = fs->to->invariant(fs->to, li, issues);
+	st_loop_invariants_resume(li);
+    }
+
+    st_destroy_loop_invariants(li);
+
+    return countable;
+}
+
 static int for_statement_step(
     struct invoke_iface_t *self,
     struct cursor_iface_t *cursor,
@@ -110,7 +191,20 @@ static int for_statement_step(
 	    break;
 	}
 	
-    case 4: 
+    case 4:
+	if(fs->invariants)
+	{
+	    fs->invoke_state = 4;
+	    int invariants_result = st_loop_invariants_step(fs->invariants,
+							    cursor,
+							    config,
+							    issues);
+	    if(invariants_result != INVOKE_RESULT_FINISHED)
+	    {
+		return invariants_result;
+	    }
+	}
+
 	fs->invoke_state = 5;
 	cursor->switch_current(cursor,
 			       fs->statements,
@@ -150,6 +244,117 @@ static int for_statement_step(
     return INVOKE_RESULT_FINISHED;
 }
 
+/* A loop over an integer variable, with an end value and an increment
+ * that are not computed by steps, counts natively. The end value is
+ * read once when the loop starts, and the variable is assigned each
+ * value it takes, before the statements are run */
+static int for_statement_counted_step(
+    struct invoke_iface_t *self,
+    struct cursor_iface_t *cursor,
+    const struct systime_iface_t *time,
+    const struct config_iface_t *config,
+    struct issues_iface_t *issues)
+{
+    struct for_statement_t *fs =
+	CONTAINER_OF(self, struct for_statement_t, invoke);
+
+    const struct value_iface_t *from_value = NULL;
+    const struct value_iface_t *to_value = NULL;
+    int variable_assign_result = ESSTEE_ERROR;
+    
+    switch(fs->invoke_state)
+    {
+    case 0:
+	cursor->push_exit_context(cursor, self);
+	
+	if(fs->from->invoke.step)
+	{
+	    fs->invoke_state = 1;
+	    cursor->switch_current(cursor,
+				   &(fs->from->invoke),
+				   config,
+				   issues);
+	    return INVOKE_RESULT_IN_PROGRESS;
+	}
+
+    case 1:
+	from_value = fs->from->return_value(fs->from);
+	to_value = fs->to->return_value(fs->to);
+	
+	variable_assign_result = fs->variable->assign(fs->variable,
+						      NULL,
+						      from_value,
+						      config,
+						      issues);
+	if(variable_assign_result != ESSTEE_OK)
+	{
+	    return INVOKE_RESULT_ERROR;
+	}
+
+	fs->count = from_value->integer(from_value, config, issues);
+	int64_t to = to_value->integer(to_value, config, issues);
+
+	if(fs->count > to)
+	{
+	    break;
+	}
+
+	fs->iterations_left =
+	    ((uint64_t)to - (uint64_t)fs->count) / (uint64_t)fs->count_increment;
+
+    case 3:
+	if(fs->invariants)
+	{
+	    fs->invoke_state = 3;
+	    int invariants_result = st_loop_invariants_step(fs->invariants,
+							    cursor,
+							    config,
+							    issues);
+	    if(invariants_result != INVOKE_RESULT_FINISHED)
+	    {
+		return invariants_result;
+	    }
+	}
+
+	fs->invoke_state = 2;
+	cursor->switch_current(cursor,
+			       fs->statements,
+			       config,
+			       issues);
+	return INVOKE_RESULT_IN_PROGRESS;
+
+    case 2:
+	fs->count += fs->count_increment;
+	st_integer_value_set(fs->counter, fs->count);
+
+	variable_assign_result = fs->variable->assign(fs->variable,
+						      NULL,
+						      fs->counter,
+						      config,
+						      issues);
+	if(variable_assign_result != ESSTEE_OK)
+	{
+	    return INVOKE_RESULT_ERROR;
+	}
+
+	if(fs->iterations_left == 0)
+	{
+	    break;
+	}
+
+	fs->iterations_left--;
+	cursor->switch_current(cursor,
+			       fs->statements,
+			       config,
+			       issues);
+	return INVOKE_RESULT_IN_PROGRESS;
+    }
+
+    cursor->pop_exit_context(cursor);
+    
+    return INVOKE_RESULT_FINISHED;
+}
+
 static int for_statement_verify(
     struct invoke_iface_t *self,
     const struct config_iface_t *config,
@@ -318,6 +523,38 @@ static int for_statement_verify(
 	}
     }
 
+    /* The increment must be a positive constant, since the loop
+     * only ends when the variable is greater than the end value */
+    int increment_constant = !fs->increment
+	|| (!fs->increment->invoke.step && !fs->increment->clone);
+    
+    if(var_value->integer
+       && from_value->integer
+       && to_value->integer
+       && increment_value->integer
+       && !fs->to->invoke.step
+       && increment_constant)
+    {
+	int countable = for_statement_countable(fs, issues);
+	if(countable == ESSTEE_ERROR)
+	{
+	    return ESSTEE_ERROR;
+	}
+	else if(countable != ESSTEE_TRUE)
+	{
+	    return ESSTEE_OK;
+	}
+
+	int64_t increment = increment_value->integer(increment_value,
+						     config,
+						     issues);
+	if(increment > 0)
+	{
+	    fs->count_increment = increment;
+	    fs->invoke.step = for_statement_counted_step;
+	}
+    }
+
     return ESSTEE_OK;
 }
 
@@ -330,6 +567,11 @@ static int for_statement_reset(
 	CONTAINER_OF(self, struct for_statement_t, invoke);
 
     fs->invoke_state = 0;
+
+    if(fs->invariants)
+    {
+	st_loop_invariants_release(fs->invariants);
+    }
     
     if(fs->from->invoke.reset)
     {
@@ -420,7 +662,58 @@ static int for_statement_allocate(
 	}
     }
 
-    return st_allocate_statements(fs->statements, issues);
+    int statements_allocate = st_allocate_statements(fs->statements, issues);
+    if(statements_allocate != ESSTEE_OK)
+    {
+	return statements_allocate;
+    }
+
+    return loop_find_invariants(self,
+				fs->statements,
+				&(fs->invariants),
+				issues);
+}
+
+static int for_statement_written_variables(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct for_statement_t *fs =
+	CONTAINER_OF(self, struct for_statement_t, invoke);
+
+    if(st_loop_invariants_add_written(invariants,
+				      fs->variable,
+				      issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_loop_invariants_add_evaluated(invariants,
+					fs->from,
+					issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_loop_invariants_add_evaluated(invariants,
+					fs->to,
+					issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(fs->increment
+       && st_loop_invariants_add_evaluated(invariants,
+					   fs->increment,
+					   issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return st_loop_invariants_add_written_by(invariants,
+					     fs->statements,
+					     issues);
 }
 
 static void for_statement_destroy(
@@ -457,6 +750,7 @@ static struct invoke_iface_t * for_statement_clone(
 
     memcpy(copy, fs, sizeof(struct for_statement_t));
     copy->statements = NULL;
+    copy->invariants = NULL;
     
     if(fs->from->clone)
     {
@@ -524,6 +818,7 @@ struct while_statement_t {
     struct invoke_iface_t *statements;
     struct st_location_t *location;
     int invoke_state;
+    struct loop_invariants_t *invariants;
 };
 
 static int while_statement_step(
@@ -555,18 +850,34 @@ static int while_statement_step(
 	}
 
     case 2:
-    default:
 	while_value = ws->while_expression->return_value(ws->while_expression);
 
-	if(while_value->bool(while_value, config, issues) == ESSTEE_TRUE)
+	if(while_value->bool(while_value, config, issues) != ESSTEE_TRUE)
 	{
-	    ws->invoke_state = 1;
-	    cursor->switch_current(cursor,
-				   ws->statements,
-				   config,
-				   issues);
-	    return INVOKE_RESULT_IN_PROGRESS;
+	    break;
+	}
+
+    case 3:
+    default:
+	if(ws->invariants)
+	{
+	    ws->invoke_state = 3;
+	    int invariants_result = st_loop_invariants_step(ws->invariants,
+							    cursor,
+							    config,
+							    issues);
+	    if(invariants_result != INVOKE_RESULT_FINISHED)
+	    {
+		return invariants_result;
+	    }
 	}
+
+	ws->invoke_state = 1;
+	cursor->switch_current(cursor,
+			       ws->statements,
+			       config,
+			       issues);
+	return INVOKE_RESULT_IN_PROGRESS;
     }
 
     cursor->pop_exit_context(cursor);
@@ -620,6 +931,11 @@ static int while_statement_reset(
 
     ws->invoke_state = 0;
 
+    if(ws->invariants)
+    {
+	st_loop_invariants_release(ws->invariants);
+    }
+
     if(ws->while_expression->invoke.reset)
     {
 	int reset_result =
@@ -665,7 +981,36 @@ static int while_statement_allocate(
 	}
     }
 
-    return st_allocate_statements(ws->statements, issues);
+    int statements_allocate = st_allocate_statements(ws->statements, issues);
+    if(statements_allocate != ESSTEE_OK)
+    {
+	return statements_allocate;
+    }
+
+    return loop_find_invariants(self,
+				ws->statements,
+				&(ws->invariants),
+				issues);
+}
+
+static int while_statement_written_variables(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct while_statement_t *ws =
+	CONTAINER_OF(self, struct while_statement_t, invoke);
+
+    if(st_loop_invariants_add_evaluated(invariants,
+					ws->while_expression,
+					issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return st_loop_invariants_add_written_by(invariants,
+					     ws->statements,
+					     issues);
 }
 
 static void while_statement_destroy(
@@ -698,6 +1043,7 @@ static struct invoke_iface_t * while_statement_clone(
 	error_free_resources);
 
     memcpy(copy, ws, sizeof(struct while_statement_t));
+    copy->invariants = NULL;
 
     if(ws->while_expression->clone)
     {
@@ -754,6 +1100,19 @@ static int repeat_statement_step(
 	cursor->push_exit_context(cursor, self);
 	
     case 1:
+	if(ws->invariants)
+	{
+	    ws->invoke_state = 1;
+	    int invariants_result = st_loop_invariants_step(ws->invariants,
+							    cursor,
+							    config,
+							    issues);
+	    if(invariants_result != INVOKE_RESULT_FINISHED)
+	    {
+		return invariants_result;
+	    }
+	}
+
 	ws->invoke_state = 2;
 	cursor->switch_current(cursor,
 			       ws->statements,
@@ -874,6 +1233,16 @@ struct invoke_iface_t * st_create_for_statement(
     {
 	goto error_free_resources;
     }
+
+    fs->counter = st_new_typeless_integer_value(0,
+						0,
+						config,
+						issues);
+
+    if(!fs->counter)
+    {
+	goto error_free_resources;
+    }
     
     int ref_add_result = var_refs->add(var_refs,
 				       variable_identifier,
@@ -893,6 +1262,7 @@ struct invoke_iface_t * st_create_for_statement(
     fs->to = to;
     fs->increment = increment;
     fs->statements = statements;
+    fs->invariants = NULL;
 
     memset(&(fs->invoke), 0, sizeof(struct invoke_iface_t));
     fs->invoke.location = fs->location;
@@ -902,6 +1272,7 @@ struct invoke_iface_t * st_create_for_statement(
     fs->invoke.allocate = for_statement_allocate;
     fs->invoke.clone = for_statement_clone;
     fs->invoke.destroy = for_statement_destroy;
+    fs->invoke.written_variables = for_statement_written_variables;
 
     return &(fs->invoke);
     
@@ -937,6 +1308,7 @@ struct invoke_iface_t * st_create_while_statement(
     ws->location = ws_location;
     ws->while_expression = while_expression;
     ws->statements = statements;
+    ws->invariants = NULL;
 
     memset(&(ws->invoke), 0, sizeof(struct invoke_iface_t));
     ws->invoke.location = ws->location;
@@ -946,6 +1318,7 @@ struct invoke_iface_t * st_create_while_statement(
     ws->invoke.allocate = while_statement_allocate;
     ws->invoke.clone = while_statement_clone;
     ws->invoke.destroy = while_statement_destroy;
+    ws->invoke.written_variables = while_statement_written_variables;
       
     return &(ws->invoke);
     
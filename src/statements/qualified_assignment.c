@@ -18,6 +18,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <statements/qualified_assignment.h>
+#include <statements/invariants.h>
 #include <util/macros.h>
 
 /**************************************************************************/
@@ -225,6 +226,62 @@ static int assignment_statement_qualified_reset(
     return ESSTEE_OK;
 }
 
+static int assignment_statement_qualified_written_variables(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct qualified_assignment_statement_t *qis =
+	CONTAINER_OF(self, struct qualified_assignment_statement_t, invoke);
+
+    if(st_loop_invariants_add_evaluated(invariants,
+					qis->rhs,
+					issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_loop_invariants_add_evaluated_indices(invariants,
+						qis->lhs,
+						issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    /* Assigning an element or a member writes the whole variable */
+    return st_loop_invariants_add_written(invariants,
+					  qis->lhs->base_variable(qis->lhs),
+					  issues);
+}
+
+static int assignment_statement_qualified_hoist_invariants(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct qualified_assignment_statement_t *qis =
+	CONTAINER_OF(self, struct qualified_assignment_statement_t, invoke);
+
+    if(qis->lhs->invariant_indices(qis->lhs,
+				   invariants,
+				   issues) == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int invariant = qis->rhs->invariant(qis->rhs, invariants, issues);
+    if(invariant == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+    else if(invariant == ESSTEE_TRUE)
+    {
+	return st_loop_invariants_hoist(invariants, qis->rhs, issues);
+    }
+
+    return ESSTEE_OK;
+}
+
 static void assignment_statement_qualified_destroy(
     struct invoke_iface_t *self)
 {
@@ -358,6 +415,8 @@ struct invoke_iface_t * st_create_assignment_statement_qualified(
     qis->invoke.reset = assignment_statement_qualified_reset;
     qis->invoke.allocate = assignment_statement_qualified_allocate;
     qis->invoke.destroy = assignment_statement_qualified_destroy;
+    qis->invoke.written_variables = assignment_statement_qualified_written_variables;
+    qis->invoke.hoist_invariants = assignment_statement_qualified_hoist_invariants;
 
     return &(qis->invoke);
     
@@ -19,6 +19,7 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <statements/simple_assignment.h>
 #include <elements/ivariable.h>
+#include <statements/invariants.h>
 #include <util/macros.h>
 
 /**************************************************************************/
@@ -161,6 +162,45 @@ static int assignment_statement_simple_allocate(
     return ESSTEE_OK;
 }
 
+static int assignment_statement_simple_written_variables(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct simple_assignment_statement_t *sa =
+	CONTAINER_OF(self, struct simple_assignment_statement_t, invoke);
+
+    if(st_loop_invariants_add_evaluated(invariants,
+					sa->rhs,
+					issues) != ESSTEE_OK)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    return st_loop_invariants_add_written(invariants, sa->lhs, issues);
+}
+
+static int assignment_statement_simple_hoist_invariants(
+    struct invoke_iface_t *self,
+    struct loop_invariants_t *invariants,
+    struct issues_iface_t *issues)
+{
+    struct simple_assignment_statement_t *sa =
+	CONTAINER_OF(self, struct simple_assignment_statement_t, invoke);
+
+    int invariant = sa->rhs->invariant(sa->rhs, invariants, issues);
+    if(invariant == ESSTEE_ERROR)
+    {
+	return ESSTEE_ERROR;
+    }
+    else if(invariant == ESSTEE_TRUE)
+    {
+	return st_loop_invariants_hoist(invariants, sa->rhs, issues);
+    }
+
+    return ESSTEE_OK;
+}
+
 static void assignment_statement_simple_destroy(
     struct invoke_iface_t *self)
 {
@@ -336,6 +376,8 @@ struct invoke_iface_t * st_create_assignment_statement_simple(
     sa->invoke.allocate = assignment_statement_simple_allocate;
     sa->invoke.clone = assignment_statement_simple_clone;
     sa->invoke.reset = assignment_statement_simple_reset;
+    sa->invoke.written_variables = assignment_statement_simple_written_variables;
+    sa->invoke.hoist_invariants = assignment_statement_simple_hoist_invariants;
     sa->invoke.destroy = assignment_statement_simple_destroy;
     
     return &(sa->invoke);
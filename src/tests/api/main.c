@@ -0,0 +1,545 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Runs tests of the library interface that cannot be expressed as a
+ * program and queries, optionally only those with a name containing
+ * the first argument */
+
+#include <esstee/esstee.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#define CYCLE_MS 20
+#define THREAD_CLONES 2
+
+static const char counter_source[] =
+    "PROGRAM counter\n"
+    "VAR\n"
+    "\tcount : INT;\n"
+    "END_VAR\n"
+    "count := count + 1;\n"
+    "END_PROGRAM\n";
+
+static const char other_source[] =
+    "PROGRAM other\n"
+    "VAR\n"
+    "\tvalue : INT;\n"
+    "END_VAR\n"
+    "value := 3;\n"
+    "END_PROGRAM\n";
+
+static const char changed_other_source[] =
+    "PROGRAM other\n"
+    "VAR\n"
+    "\tvalue : INT;\n"
+    "END_VAR\n"
+    "value := 7;\n"
+    "END_PROGRAM\n";
+
+static const char shared_counter_source[] =
+    "VAR_GLOBAL\n"
+    "\ttotal : DINT;\n"
+    "END_VAR\n"
+    "\n"
+    "PROGRAM counter\n"
+    "VAR\n"
+    "\tcount : DINT;\n"
+    "\ti : INT;\n"
+    "\tmirror AT %MD0 : DINT;\n"
+    "END_VAR\n"
+    "VAR_EXTERNAL\n"
+    "\ttotal : DINT;\n"
+    "END_VAR\n"
+    "count := count + 1;\n"
+    "FOR i := 1 TO 10 DO\n"
+    "\ttotal := total + 1;\n"
+    "END_FOR;\n"
+    "mirror := count;\n"
+    "END_PROGRAM\n";
+
+static void print_all_errors(struct st_t *st) {
+    const struct st_issue_t *i = NULL;
+    while((i = st_fetch_issue(st, ESSTEE_FILTER_ANY_ISSUE)) != NULL)
+    {
+	fprintf(stderr, "%s\n", i->message);
+    }
+}
+
+/* Loads a copy of the source, with the two NULs that make it scanned
+ * in place when terminated. The copy is released right after
+ * loading, as the instance may not refer to it. */
+static int load_source(
+    struct st_t *st,
+    const char *identifier,
+    const char *source,
+    int terminated) {
+    size_t length = strlen(source);
+    size_t buffer_size = (terminated) ? length + 2 : length;
+
+    char *buffer = (char *)malloc(buffer_size);
+    if(!buffer) {
+	return ESSTEE_ERROR;
+    }
+
+    memcpy(buffer, source, length);
+    if(terminated) {
+	buffer[length] = '\0';
+	buffer[length+1] = '\0';
+    }
+
+    int load_result = st_load_buffer(identifier, buffer, buffer_size, st);
+    free(buffer);
+
+    return load_result;
+}
+
+static int run_cycles(struct st_t *st, int cycles) {
+    for(int i = 0; i < cycles; i++) {
+	if(st_run_cycle(st, CYCLE_MS) != ESSTEE_OK) {
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    return ESSTEE_OK;
+}
+
+static int expect_query(
+    struct st_t *st,
+    const char *query,
+    const char *expected) {
+    char output[1000];
+    if(st_query(st, output, sizeof(output), query) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    if(strcmp(output, expected) != 0) {
+	fprintf(stderr, "query '%s' gave '%s', expected '%s'\n", query, output, expected);
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
+}
+
+static int test_load_in_place(struct st_t *st) {
+    if(load_source(st, "counter", counter_source, 1) != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK
+       || !st_start(st, "counter")
+       || run_cycles(st, 3) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    return expect_query(st, "[counter].count", "3");
+}
+
+static int test_load_copy(struct st_t *st) {
+    size_t length = strlen(counter_source);
+    char *buffer = (char *)malloc(length);
+    if(!buffer) {
+	return ESSTEE_ERROR;
+    }
+    memcpy(buffer, counter_source, length);
+
+    /* A buffer without the two NULs is copied and left untouched */
+    int load_result = st_load_buffer("counter", buffer, length, st);
+    int untouched = (memcmp(buffer, counter_source, length) == 0);
+    free(buffer);
+
+    if(!untouched) {
+	fprintf(stderr, "the loaded buffer was modified\n");
+	return ESSTEE_ERROR;
+    }
+
+    if(load_result != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK
+       || !st_start(st, "counter")
+       || run_cycles(st, 2) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    return expect_query(st, "[counter].count", "2");
+}
+
+static int test_unload_relink(struct st_t *st) {
+    if(load_source(st, "counter", counter_source, 1) != ESSTEE_OK
+       || load_source(st, "other", other_source, 0) != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    /* Relinking without the unloaded unit leaves the rest running */
+    if(st_unload_buffer(st, "other") != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK
+       || !st_start(st, "counter")
+       || run_cycles(st, 1) != ESSTEE_OK
+       || expect_query(st, "[counter].count", "1") != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    /* Loading it again, changed, gives no duplicate definitions */
+    if(load_source(st, "other", changed_other_source, 1) != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK
+       || !st_start(st, "other")
+       || run_cycles(st, 1) != ESSTEE_OK
+       || expect_query(st, "[other].value", "7") != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_unload_buffer(st, "other") != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    if(st_start(st, "other")) {
+	fprintf(stderr, "an unloaded program could be started\n");
+	return ESSTEE_ERROR;
+    }
+
+    if(st_unload_buffer(st, "missing") == ESSTEE_OK) {
+	fprintf(stderr, "unloading a unit never loaded succeeded\n");
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
+}
+
+/* Checks the program, global and direct memory variables of an
+ * instance of the shared counter, after a number of cycles */
+static int expect_counted(
+    struct st_t *st,
+    int cycles) {
+    char count[32];
+    char total[32];
+    snprintf(count, sizeof(count), "%d", cycles);
+    snprintf(total, sizeof(total), "%d", cycles * 10);
+
+    if(expect_query(st, "[counter].count", count) != ESSTEE_OK
+       || expect_query(st, "total", total) != ESSTEE_OK
+       || expect_query(st, "[counter].mirror", count) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
+}
+
+static int start_shared_counter(
+    struct st_t *st,
+    int cycles) {
+    if(load_source(st, "counter", shared_counter_source, 0) != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK
+       || !st_start(st, "counter")
+       || run_cycles(st, cycles) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
+}
+
+static int test_clone_diverges(struct st_t *st) {
+    if(start_shared_counter(st, 2) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    struct st_t *clone = st_clone_instance(st);
+    if(!clone) {
+	return ESSTEE_ERROR;
+    }
+
+    struct st_t *clone_of_clone = NULL;
+    int result = ESSTEE_ERROR;
+
+    if(run_cycles(st, 3) != ESSTEE_OK
+       || run_cycles(clone, 1) != ESSTEE_OK
+       || expect_counted(st, 5) != ESSTEE_OK
+       || expect_counted(clone, 3) != ESSTEE_OK) {
+	goto done;
+    }
+
+    clone_of_clone = st_clone_instance(clone);
+    if(!clone_of_clone
+       || run_cycles(clone_of_clone, 2) != ESSTEE_OK
+       || expect_counted(clone_of_clone, 5) != ESSTEE_OK
+       || expect_counted(clone, 3) != ESSTEE_OK) {
+	goto done;
+    }
+
+    /* Restarting the clone resets only its own variables */
+    if(!st_start(clone, "counter")
+       || run_cycles(clone, 1) != ESSTEE_OK
+       || expect_counted(clone, 1) != ESSTEE_OK
+       || expect_counted(st, 5) != ESSTEE_OK) {
+	goto done;
+    }
+
+    result = ESSTEE_OK;
+
+done:
+    print_all_errors(clone);
+    st_destroy(clone);
+    if(clone_of_clone) {
+	print_all_errors(clone_of_clone);
+	st_destroy(clone_of_clone);
+    }
+
+    return result;
+}
+
+struct cycle_run_t {
+    struct st_t *st;
+    int cycles;
+    int result;
+};
+
+static void * run_cycles_thread(void *arg) {
+    struct cycle_run_t *run = (struct cycle_run_t *)arg;
+    run->result = run_cycles(run->st, run->cycles);
+    return NULL;
+}
+
+static int test_clone_threads(struct st_t *st) {
+    if(start_shared_counter(st, 1) != ESSTEE_OK) {
+	return ESSTEE_ERROR;
+    }
+
+    /* The instance and its clones run a different number of cycles
+     * each, all at the same time */
+    struct cycle_run_t runs[THREAD_CLONES+1];
+    pthread_t threads[THREAD_CLONES+1];
+    int started = 0;
+    int result = ESSTEE_OK;
+
+    runs[0].st = st;
+    for(int i = 1; i <= THREAD_CLONES; i++) {
+	runs[i].st = st_clone_instance(st);
+	if(!runs[i].st) {
+	    for(int j = 1; j < i; j++) {
+		st_destroy(runs[j].st);
+	    }
+	    return ESSTEE_ERROR;
+	}
+    }
+
+    for(int i = 0; i <= THREAD_CLONES; i++) {
+	runs[i].cycles = 10000 * (i+1);
+	runs[i].result = ESSTEE_ERROR;
+	if(pthread_create(&threads[i], NULL, run_cycles_thread, &runs[i]) != 0) {
+	    result = ESSTEE_ERROR;
+	    break;
+	}
+	started++;
+    }
+
+    for(int i = 0; i < started; i++) {
+	pthread_join(threads[i], NULL);
+    }
+
+    for(int i = 0; i < started && result == ESSTEE_OK; i++) {
+	if(runs[i].result != ESSTEE_OK
+	   || expect_counted(runs[i].st, runs[i].cycles + 1) != ESSTEE_OK) {
+	    result = ESSTEE_ERROR;
+	}
+    }
+
+    for(int i = 1; i <= THREAD_CLONES; i++) {
+	print_all_errors(runs[i].st);
+	st_destroy(runs[i].st);
+    }
+
+    return result;
+}
+
+static int test_clone_in_place(struct st_t *st) {
+    if(load_source(st, "counter", counter_source, 1) != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK
+       || !st_start(st, "counter")) {
+	return ESSTEE_ERROR;
+    }
+
+    /* The source scanned in place is not kept to link a clone from */
+    struct st_t *clone = st_clone_instance(st);
+    if(clone) {
+	fprintf(stderr, "an instance loaded in place was cloned\n");
+	st_destroy(clone);
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
+}
+
+static int test_checkpoint_round_trip(struct st_t *st) {
+    struct st_buffer_t buffer = { .bytes = NULL, .size = 0, .capacity = 0 };
+    int result = ESSTEE_ERROR;
+
+    if(start_shared_counter(st, 2) != ESSTEE_OK
+       || st_checkpoint(st, &buffer) != ESSTEE_OK) {
+	goto done;
+    }
+
+    /* Restoring after more cycles goes back to the checkpoint */
+    if(run_cycles(st, 3) != ESSTEE_OK
+       || expect_counted(st, 5) != ESSTEE_OK
+       || st_restore(st, &buffer) != ESSTEE_OK
+       || expect_counted(st, 2) != ESSTEE_OK
+       || run_cycles(st, 1) != ESSTEE_OK
+       || expect_counted(st, 3) != ESSTEE_OK) {
+	goto done;
+    }
+
+    /* Any instance linked from the same program takes it */
+    struct st_t *other = st_new_instance(100);
+    if(!other) {
+	goto done;
+    }
+
+    if(start_shared_counter(other, 7) == ESSTEE_OK
+       && st_restore(other, &buffer) == ESSTEE_OK
+       && expect_counted(other, 2) == ESSTEE_OK) {
+	result = ESSTEE_OK;
+    }
+
+    print_all_errors(other);
+    st_destroy(other);
+
+done:
+    free(buffer.bytes);
+    return result;
+}
+
+/* Restores the checkpoint and expects it rejected with the issue */
+static int expect_rejected(
+    struct st_t *st,
+    const struct st_buffer_t *buffer,
+    const char *message) {
+    if(st_restore(st, buffer) == ESSTEE_OK) {
+	fprintf(stderr, "a foreign checkpoint was restored\n");
+	return ESSTEE_ERROR;
+    }
+
+    const struct st_issue_t *issue = st_fetch_issue(st, ESSTEE_FILTER_ANY_ERROR);
+    if(!issue || strcmp(issue->message, message) != 0) {
+	fprintf(stderr, "the checkpoint was rejected for another reason\n");
+	return ESSTEE_ERROR;
+    }
+
+    return ESSTEE_OK;
+}
+
+static int test_checkpoint_foreign(struct st_t *st) {
+    struct st_buffer_t buffer = { .bytes = NULL, .size = 0, .capacity = 0 };
+    struct st_t *other = st_new_instance(100);
+    struct st_t *larger = st_new_instance(200);
+    int result = ESSTEE_ERROR;
+
+    if(!(other && larger)
+       || start_shared_counter(st, 2) != ESSTEE_OK
+       || load_source(other, "counter", counter_source, 0) != ESSTEE_OK
+       || st_link(other) != ESSTEE_OK
+       || !st_start(other, "counter")
+       || start_shared_counter(larger, 1) != ESSTEE_OK
+       || st_checkpoint(st, &buffer) != ESSTEE_OK) {
+	goto done;
+    }
+
+    if(expect_rejected(other,
+		       &buffer,
+		       "checkpoint was taken from a different program") != ESSTEE_OK
+       || expect_rejected(larger,
+			  &buffer,
+			  "checkpoint was taken from a different program") != ESSTEE_OK) {
+	goto done;
+    }
+
+    /* The rejected instances keep running from where they were */
+    if(run_cycles(other, 1) != ESSTEE_OK
+       || expect_query(other, "[counter].count", "1") != ESSTEE_OK
+       || run_cycles(larger, 1) != ESSTEE_OK
+       || expect_counted(larger, 2) != ESSTEE_OK) {
+	goto done;
+    }
+
+    memcpy(buffer.bytes, "FOREIGN!", 8);
+    if(expect_rejected(st, &buffer, "not a valid checkpoint") != ESSTEE_OK) {
+	goto done;
+    }
+
+    result = ESSTEE_OK;
+
+done:
+    if(other) {
+	print_all_errors(other);
+	st_destroy(other);
+    }
+    if(larger) {
+	print_all_errors(larger);
+	st_destroy(larger);
+    }
+    free(buffer.bytes);
+    return result;
+}
+
+struct api_test_t {
+    const char *name;
+    int (*run)(struct st_t *st);
+};
+
+static struct api_test_t api_tests[] = {
+    {"load_in_place", test_load_in_place},
+    {"load_copy", test_load_copy},
+    {"unload_relink", test_unload_relink},
+    {"clone_diverges", test_clone_diverges},
+    {"clone_threads", test_clone_threads},
+    {"clone_in_place", test_clone_in_place},
+    {"checkpoint_round_trip", test_checkpoint_round_trip},
+    {"checkpoint_foreign", test_checkpoint_foreign},
+    {NULL, NULL}
+};
+
+int main(int argc, char * const argv[])
+{
+    const char *filter = (argc > 1) ? argv[1] : NULL;
+    int failed = 0;
+
+    for(struct api_test_t *t = api_tests; t->name != NULL; t++) {
+	if(filter && !strstr(t->name, filter)) {
+	    continue;
+	}
+
+	struct st_t *st = st_new_instance(100);
+	if(!st) {
+	    fprintf(stderr, "%s: could not create an instance\n", t->name);
+	    failed++;
+	    continue;
+	}
+
+	if(t->run(st) != ESSTEE_OK) {
+	    fprintf(stderr, "%s: failed\n", t->name);
+	    print_all_errors(st);
+	    failed++;
+	}
+	else {
+	    fprintf(stderr, "%s: ok\n", t->name);
+	}
+
+	st_destroy(st);
+    }
+
+    return (failed > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
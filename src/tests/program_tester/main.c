@@ -24,6 +24,8 @@ along with esstee.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
 #include <getopt.h>
 extern int yydebug;
 
@@ -34,6 +36,24 @@ extern int yydebug;
 #define RUN_CYCLES 5
 #define FILE 6
 #define QUIET_PRE_RUN 7
+#define PROFILE 8
+#define CYCLE_STATS 9
+#define CYCLE_BUDGET 10
+#define MAX_CYCLE_STEPS 11
+#define MAX_CYCLE_TIME 12
+#define PERIOD 13
+#define FAST_FORWARD 14
+#define TRACE 15
+#define TRACE_VARIABLES 16
+#define WATCH 17
+#define BREAK_LINE 18
+#define BREAK_CONDITION 19
+#define WATCHPOINT 20
+#define WATCHPOINT_CONDITION 21
+#define SHORT_CIRCUIT 22
+
+/* Keeps a runaway test program from stalling a test run */
+#define DEFAULT_MAX_CYCLE_STEPS 10000000
 
 static struct option long_options[] = {
     {"bison-debug", no_argument, NULL, BISON_DEBUG},
@@ -43,6 +63,21 @@ static struct option long_options[] = {
     {"program", required_argument, NULL, PROGRAM},
     {"run-cycles", required_argument, NULL, RUN_CYCLES},
     {"file", required_argument, NULL, FILE},
+    {"profile", no_argument, NULL, PROFILE},
+    {"cycle-stats", no_argument, NULL, CYCLE_STATS},
+    {"cycle-budget-us", required_argument, NULL, CYCLE_BUDGET},
+    {"max-cycle-steps", required_argument, NULL, MAX_CYCLE_STEPS},
+    {"max-cycle-time-ms", required_argument, NULL, MAX_CYCLE_TIME},
+    {"period-us", required_argument, NULL, PERIOD},
+    {"fast-forward-ms", required_argument, NULL, FAST_FORWARD},
+    {"trace", required_argument, NULL, TRACE},
+    {"trace-variables", required_argument, NULL, TRACE_VARIABLES},
+    {"watch", required_argument, NULL, WATCH},
+    {"break-line", required_argument, NULL, BREAK_LINE},
+    {"break-condition", required_argument, NULL, BREAK_CONDITION},
+    {"watchpoint", required_argument, NULL, WATCHPOINT},
+    {"watchpoint-condition", required_argument, NULL, WATCHPOINT_CONDITION},
+    {"short-circuit", no_argument, NULL, SHORT_CIRCUIT},
     {0, 0, 0, 0}
 };
 
@@ -76,6 +111,165 @@ static void print_all_errors(struct st_t *st) {
     }
 }
 
+static const char * profile_class(st_bitflag_t class) {
+    switch(class)
+    {
+    case ESSTEE_PROFILE_STATEMENT:
+	return "statement";
+    case ESSTEE_PROFILE_FUNCTION:
+	return "function";
+    case ESSTEE_PROFILE_FUNCTION_BLOCK:
+	return "fb";
+    case ESSTEE_PROFILE_PROGRAM:
+	return "program";
+    default:
+	return "?";
+    }
+}
+
+static void print_profile_entries(struct st_t *st, st_bitflag_t filter) {
+    fprintf(stderr, "%12s %12s %10s %-10s %-20s %s\n",
+	    "time (us)", "steps", "calls", "kind", "pou", "location");
+    
+    const struct st_profile_entry_t *e = NULL;
+    while((e = st_fetch_profile_entry(st, filter)) != NULL)
+    {
+	fprintf(stderr, "%12.1f %12" PRIu64 " %10" PRIu64 " %-10s %-20s",
+		e->time_ns / 1000.0,
+		e->steps,
+		e->calls,
+		profile_class(e->class),
+		(e->identifier) ? e->identifier : "-");
+
+	if(e->location)
+	{
+	    fprintf(stderr, " L(%d:%d) C(%d:%d)",
+		    e->location->first_line,
+		    e->location->last_line,
+		    e->location->first_column,
+		    e->location->last_column);
+	}
+	fprintf(stderr, "\n");
+    }
+}
+
+static void print_profile(struct st_t *st) {
+    fprintf(stderr, "flat profile, pous:\n");
+    print_profile_entries(st, ESSTEE_FILTER_ANY_POU);
+    
+    fprintf(stderr, "flat profile, statements:\n");
+    print_profile_entries(st, ESSTEE_PROFILE_STATEMENT);
+
+    fprintf(stderr, "call graph:\n");
+    const struct st_profile_call_t *c = NULL;
+    while((c = st_fetch_profile_call(st)) != NULL)
+    {
+	fprintf(stderr, "%s -> %s: %" PRIu64 " calls\n",
+		c->caller->identifier,
+		c->callee->identifier,
+		c->calls);
+    }
+}
+
+static void print_cycle_stats(struct st_t *st) {
+    const struct st_cycle_stats_t *cs = st_cycle_stats(st);
+
+    fprintf(stderr, "cycle stats: %" PRIu64 " cycles\n", cs->cycles);
+    if(cs->cycles == 0)
+    {
+	return;
+    }
+    
+    fprintf(stderr, "%12s %12s %12s %12s %12s %12s\n",
+	    "min (us)", "mean (us)", "p50 (us)", "p99 (us)", "p99.9 (us)", "max (us)");
+    fprintf(stderr, "%12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n",
+	    cs->min_ns / 1000.0,
+	    cs->mean_ns / 1000.0,
+	    cs->p50_ns / 1000.0,
+	    cs->p99_ns / 1000.0,
+	    cs->p999_ns / 1000.0,
+	    cs->max_ns / 1000.0);
+
+    if(cs->budget_ns > 0)
+    {
+	fprintf(stderr, "overruns: %" PRIu64 " of %" PRIu64 " cycles exceeded %.1f us\n",
+		cs->overruns,
+		cs->cycles,
+		cs->budget_ns / 1000.0);
+    }
+}
+
+static void print_periodic_report(
+    const struct st_periodic_report_t *report,
+    uint64_t period_us) {
+    fprintf(stderr, "periodic run: %" PRIu64 " cycles, period %" PRIu64 " us\n",
+	    report->cycles,
+	    period_us);
+    fprintf(stderr, "start latency: mean %.1f us, max %.1f us\n",
+	    report->mean_latency_ns / 1000.0,
+	    report->max_latency_ns / 1000.0);
+    fprintf(stderr, "overruns: %" PRIu64 ", skipped periods: %" PRIu64 "\n",
+	    report->overruns,
+	    report->skipped);
+}
+
+static void print_watched_change(
+    const char *identifier,
+    const char *value,
+    void *user_data) {
+    fprintf(stderr, "%s := %s\n", identifier, (value) ? value : "?");
+}
+
+/* Watches the variables separated by ';' */
+static int watch_variables(struct st_t *st, const char *variables) {
+    char *names = strdup(variables);
+    if(!names)
+    {
+	return ESSTEE_ERROR;
+    }
+
+    int watch_result = ESSTEE_OK;
+    char *saveptr = NULL;
+    for(char *name = strtok_r(names, ";", &saveptr);
+	name != NULL && watch_result == ESSTEE_OK;
+	name = strtok_r(NULL, ";", &saveptr))
+    {
+	watch_result = st_watch(st, name, print_watched_change, NULL);
+    }
+
+    free(names);
+    return watch_result;
+}
+
+/* Runs the cycles, reporting each breakpoint or watchpoint hit on
+ * the way. A hit at the start of a cycle completes the one before. */
+static int run_to_breakpoints(struct st_t *st,
+			      const struct st_location_t *start,
+			      int run_cycles) {
+    int cycle = 1;
+    while(cycle <= run_cycles) {
+	int continue_result = st_continue(st, 20, 1);
+	if(continue_result == ESSTEE_FALSE) {
+	    cycle++;
+	    continue;
+	}
+	else if(continue_result != ESSTEE_TRUE) {
+	    return ESSTEE_ERROR;
+	}
+
+	const struct st_location_t *location = st_location(st);
+	if(location == start) {
+	    cycle++;
+	}
+
+	fprintf(stderr, "stopped at line %d, cycle %d\n",
+		location->first_line,
+		cycle);
+    }
+
+    return ESSTEE_OK;
+}
+
 int main(int argc, char * const argv[])
 {
     /* Default options */
@@ -86,6 +280,21 @@ int main(int argc, char * const argv[])
     const char *file = NULL;
     int quiet_pre_run = 0;
     int run_cycles = 1;
+    int profile = 0;
+    int cycle_stats = 0;
+    uint64_t cycle_budget_us = 0;
+    uint64_t max_cycle_steps = DEFAULT_MAX_CYCLE_STEPS;
+    uint64_t max_cycle_time_ms = 0;
+    uint64_t period_us = 0;
+    uint64_t fast_forward_ms = 0;
+    const char *trace = NULL;
+    const char *trace_variables = NULL;
+    const char *watch = NULL;
+    int break_line = 0;
+    const char *break_condition = NULL;
+    const char *watchpoint = NULL;
+    const char *watchpoint_condition = NULL;
+    int short_circuit = 0;
     
     int argument_parsing = 1;
     while(argument_parsing)
@@ -116,6 +325,7 @@ int main(int argc, char * const argv[])
 
 	case RUN_CYCLES:
 	    run_cycles = atoi(optarg);
+	    break;
 
 	case FILE:
 	    file = optarg;
@@ -124,6 +334,67 @@ int main(int argc, char * const argv[])
 	case QUIET_PRE_RUN:
 	    quiet_pre_run = 1;
 	    break;
+
+	case PROFILE:
+	    profile = 1;
+	    break;
+
+	case CYCLE_STATS:
+	    cycle_stats = 1;
+	    break;
+
+	case CYCLE_BUDGET:
+	    cycle_stats = 1;
+	    cycle_budget_us = strtoull(optarg, NULL, 10);
+	    break;
+
+	case MAX_CYCLE_STEPS:
+	    max_cycle_steps = strtoull(optarg, NULL, 10);
+	    break;
+
+	case MAX_CYCLE_TIME:
+	    max_cycle_time_ms = strtoull(optarg, NULL, 10);
+	    break;
+
+	case PERIOD:
+	    period_us = strtoull(optarg, NULL, 10);
+	    break;
+
+	case FAST_FORWARD:
+	    fast_forward_ms = strtoull(optarg, NULL, 10);
+	    break;
+
+	case TRACE:
+	    trace = optarg;
+	    break;
+
+	case TRACE_VARIABLES:
+	    trace_variables = optarg;
+	    break;
+
+	case WATCH:
+	    watch = optarg;
+	    break;
+
+	case BREAK_LINE:
+	    break_line = atoi(optarg);
+	    break;
+
+	case BREAK_CONDITION:
+	    break_condition = optarg;
+	    break;
+
+	case WATCHPOINT:
+	    watchpoint = optarg;
+	    break;
+
+	case WATCHPOINT_CONDITION:
+	    watchpoint_condition = optarg;
+	    break;
+
+	case SHORT_CIRCUIT:
+	    short_circuit = 1;
+	    break;
 	    
 	default:
 	    break;
@@ -148,6 +419,10 @@ int main(int argc, char * const argv[])
 	return EXIT_FAILURE;
     }
 
+    if(short_circuit) {
+	st_set_config("short_circuit_evaluation", ESSTEE_TRUE, st);
+    }
+
     fprintf(stderr, "loading '%s' ... ", file);
     int load_result = st_load_file(st, file);
     if(load_result != ESSTEE_OK) {
@@ -192,21 +467,92 @@ int main(int argc, char * const argv[])
 	}
     }
 
+    if(profile && st_set_profiling(st, 1) != ESSTEE_OK) {
+	print_all_errors(st);
+	return EXIT_FAILURE;
+    }
+    
+    if(trace && st_trace_start(st, trace, trace_variables) != ESSTEE_OK) {
+	print_all_errors(st);
+	return EXIT_FAILURE;
+    }
+
+    if(watch && watch_variables(st, watch) != ESSTEE_OK) {
+	print_all_errors(st);
+	return EXIT_FAILURE;
+    }
+
+    if(break_line > 0
+       && st_set_breakpoint(st, NULL, break_line, break_condition) != ESSTEE_OK) {
+	print_all_errors(st);
+	return EXIT_FAILURE;
+    }
+
+    if(watchpoint
+       && st_set_watchpoint(st, watchpoint, watchpoint_condition) != ESSTEE_OK) {
+	print_all_errors(st);
+	return EXIT_FAILURE;
+    }
+
+    st_set_cycle_budget(st, cycle_budget_us * 1000);
+    st_set_cycle_limits(st, max_cycle_steps, max_cycle_time_ms * 1000000);
+    
     int cycle_result = ESSTEE_OK;
-    for(int i = 0; i < run_cycles; i++) {
-	cycle_result = st_run_cycle(st, 20);
+    struct st_periodic_report_t periodic_report;
+    struct st_fast_forward_report_t fast_forward_report;
+    if(fast_forward_ms > 0) {
+	cycle_result = st_fast_forward(st,
+				       fast_forward_ms,
+				       20,
+				       &fast_forward_report);
+    }
+    else if(break_line > 0 || watchpoint) {
+	cycle_result = run_to_breakpoints(st, cursor, run_cycles);
+    }
+    else if(period_us > 0) {
+	cycle_result = st_run_periodic(st,
+				       period_us,
+				       (run_cycles > 0) ? run_cycles : 1,
+				       &periodic_report);
+    }
+    else {
+	for(int i = 0; i < run_cycles; i++) {
+	    cycle_result = st_run_cycle(st, 20);
 
-	if(cycle_result != ESSTEE_OK)
-	{
-	    break;
+	    if(cycle_result != ESSTEE_OK)
+	    {
+		break;
+	    }
 	}
     }
 
+    if(trace && st_trace_stop(st) != ESSTEE_OK) {
+	cycle_result = ESSTEE_ERROR;
+    }
+
     if(cycle_result != ESSTEE_OK)
     {
 	print_all_errors(st);
 	return EXIT_FAILURE;
     }
+
+    if(profile) {
+	st_set_profiling(st, 0);
+	print_profile(st);
+    }
+
+    if(fast_forward_ms > 0) {
+	fprintf(stderr, "fast-forward: %" PRIu64 " cycles run, %" PRIu64 " skipped\n",
+		fast_forward_report.cycles_run,
+		fast_forward_report.cycles_skipped);
+    }
+    else if(period_us > 0) {
+	print_periodic_report(&periodic_report, period_us);
+    }
+
+    if(cycle_stats) {
+	print_cycle_stats(st);
+    }
     
     if(post_run_queries) {
 	fprintf(stderr, "running post queries\n");
@@ -0,0 +1,196 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Lists the records of a trace, or reconstructs the state at a cycle
+ * of it in the traced program and runs queries on it */
+
+#include <esstee/esstee.h>
+#include <rt/trace.h>
+#include <util/issue_context.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <getopt.h>
+
+#define TRACE 1
+#define FILE_OPTION 2
+#define PROGRAM 3
+#define CYCLE 4
+#define QUERIES 5
+
+static struct option long_options[] = {
+    {"trace", required_argument, NULL, TRACE},
+    {"file", required_argument, NULL, FILE_OPTION},
+    {"program", required_argument, NULL, PROGRAM},
+    {"cycle", required_argument, NULL, CYCLE},
+    {"queries", required_argument, NULL, QUERIES},
+    {0, 0, 0, 0}
+};
+
+static void print_issues(struct issues_iface_t *issues) {
+    const struct st_issue_t *i = NULL;
+    while((i = issues->fetch(issues, ESSTEE_FILTER_ANY_ISSUE)) != NULL)
+    {
+	fprintf(stderr, "%s\n", i->message);
+    }
+}
+
+static void print_st_issues(struct st_t *st) {
+    const struct st_issue_t *i = NULL;
+    while((i = st_fetch_issue(st, ESSTEE_FILTER_ANY_ISSUE)) != NULL)
+    {
+	fprintf(stderr, "%s\n", i->message);
+    }
+}
+
+static int list_trace(const char *path) {
+    struct issues_iface_t *issues = st_new_issue_context();
+    if(!issues) {
+	fprintf(stderr, "error creating issue context\n");
+	return EXIT_FAILURE;
+    }
+
+    struct trace_reader_iface_t *trace = st_new_trace_reader(path, issues);
+    if(!trace) {
+	print_issues(issues);
+	return EXIT_FAILURE;
+    }
+
+    size_t count = trace->variable_count(trace);
+    printf("%zu variables:\n", count);
+    for(size_t i = 0; i < count; i++) {
+	printf("  %s\n", trace->variable_name(trace, i));
+    }
+
+    int record_result = ESSTEE_TRUE;
+    while((record_result = trace->next_record(trace, issues)) == ESSTEE_TRUE) {
+	printf("cycle %" PRIu64 ", time %" PRIu64 " ms:",
+	       trace->cycle(trace),
+	       trace->time_ms(trace));
+
+	for(size_t i = 0; i < count; i++) {
+	    if(trace->changed(trace, i)) {
+		printf(" %s", trace->variable_name(trace, i));
+	    }
+	}
+	printf("\n");
+    }
+
+    trace->destroy(trace);
+
+    if(record_result == ESSTEE_ERROR) {
+	print_issues(issues);
+	return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+static int query_trace(const char *path,
+		       const char *file,
+		       const char *program,
+		       uint64_t cycle,
+		       const char *queries) {
+    struct st_t *st = st_new_instance(1024);
+    if(!st) {
+	fprintf(stderr, "error creating esstee instance\n");
+	return EXIT_FAILURE;
+    }
+
+    if(st_load_file(st, file) != ESSTEE_OK
+       || st_link(st) != ESSTEE_OK
+       || !st_start(st, program)
+       || st_trace_restore(st, path, cycle) != ESSTEE_OK) {
+	print_st_issues(st);
+	return EXIT_FAILURE;
+    }
+
+    char output_buffer[1000];
+    if(st_query(st, output_buffer, sizeof(output_buffer), queries) < 0) {
+	print_st_issues(st);
+	return EXIT_FAILURE;
+    }
+
+    printf("%s\n", output_buffer);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char * const argv[])
+{
+    /* Default options */
+    const char *trace = NULL;
+    const char *file = NULL;
+    const char *program = NULL;
+    const char *queries = NULL;
+    uint64_t cycle = 0;
+
+    int argument_parsing = 1;
+    while(argument_parsing)
+    {
+	int c = getopt_long_only(argc, argv, "", long_options, NULL);
+
+	switch(c)
+	{
+	case -1:
+	    argument_parsing = 0;
+	    break;
+
+	case TRACE:
+	    trace = optarg;
+	    break;
+
+	case FILE_OPTION:
+	    file = optarg;
+	    break;
+
+	case PROGRAM:
+	    program = optarg;
+	    break;
+
+	case CYCLE:
+	    cycle = strtoull(optarg, NULL, 10);
+	    break;
+
+	case QUERIES:
+	    queries = optarg;
+	    break;
+	    
+	default:
+	    break;
+	}
+    }
+
+    if(!trace) {
+	fprintf(stderr, "no trace file given (--trace)\n");
+	return EXIT_FAILURE;
+    }
+
+    if(!file) {
+	return list_trace(trace);
+    }
+
+    if(!program || !queries) {
+	fprintf(stderr, "querying a trace needs --program and --queries\n");
+	return EXIT_FAILURE;
+    }
+
+    return query_trace(trace, file, program, cycle, queries);
+}
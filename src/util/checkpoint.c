@@ -0,0 +1,217 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <util/checkpoint.h>
+#include <util/macros.h>
+#include <esstee/flags.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+struct checkpoint_t {
+    struct checkpoint_iface_t checkpoint;
+    struct st_buffer_t *write_buffer;
+    const struct st_buffer_t *read_buffer;
+    size_t read_offset;
+    uint64_t *digest;
+    struct issues_iface_t *issues;
+};
+
+/* FNV-1a, 64 bits */
+#define DIGEST_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define DIGEST_PRIME 0x100000001b3ULL
+
+/**************************************************************************/
+/* Checkpoint interface                                                   */
+/**************************************************************************/
+static int checkpoint_write(
+    struct checkpoint_iface_t *self,
+    const void *bytes,
+    size_t size)
+{
+    struct checkpoint_t *cp =
+	CONTAINER_OF(self, struct checkpoint_t, checkpoint);
+
+    struct st_buffer_t *buffer = cp->write_buffer;
+    
+    if(buffer->capacity - buffer->size < size)
+    {
+	size_t capacity = (buffer->capacity > 0) ? buffer->capacity : 256;
+	while(capacity - buffer->size < size)
+	{
+	    capacity *= 2;
+	}
+
+	char *grown = (char *)realloc(buffer->bytes, capacity);
+	if(!grown)
+	{
+	    cp->issues->memory_error(cp->issues, __FILE__, __FUNCTION__, __LINE__);
+	    return ESSTEE_ERROR;
+	}
+
+	buffer->bytes = grown;
+	buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->bytes + buffer->size, bytes, size);
+    buffer->size += size;
+
+    return ESSTEE_OK;
+}
+
+static int checkpoint_digest_write(
+    struct checkpoint_iface_t *self,
+    const void *bytes,
+    size_t size)
+{
+    struct checkpoint_t *cp =
+	CONTAINER_OF(self, struct checkpoint_t, checkpoint);
+
+    uint64_t digest = *(cp->digest);
+    const unsigned char *byte = (const unsigned char *)bytes;
+    
+    for(size_t i = 0; i < size; i++)
+    {
+	digest ^= byte[i];
+	digest *= DIGEST_PRIME;
+    }
+
+    *(cp->digest) = digest;
+
+    return ESSTEE_OK;
+}
+
+static int checkpoint_read(
+    struct checkpoint_iface_t *self,
+    void *bytes,
+    size_t size)
+{
+    struct checkpoint_t *cp =
+	CONTAINER_OF(self, struct checkpoint_t, checkpoint);
+
+    if(cp->read_buffer->size - cp->read_offset < size)
+    {
+	cp->issues->new_issue(cp->issues,
+			      "checkpoint is truncated",
+			      ESSTEE_ARGUMENT_ERROR);
+	return ESSTEE_ERROR;
+    }
+
+    memcpy(bytes, cp->read_buffer->bytes + cp->read_offset, size);
+    cp->read_offset += size;
+
+    return ESSTEE_OK;
+}
+
+static void checkpoint_destroy(
+    struct checkpoint_iface_t *self)
+{
+    struct checkpoint_t *cp =
+	CONTAINER_OF(self, struct checkpoint_t, checkpoint);
+
+    free(cp);
+}
+
+/**************************************************************************/
+/* Public interface                                                       */
+/**************************************************************************/
+struct checkpoint_iface_t * st_new_checkpoint_writer(
+    struct st_buffer_t *buffer,
+    struct issues_iface_t *issues)
+{
+    struct checkpoint_t *cp = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	cp,
+	struct checkpoint_t,
+	issues,
+	error_free_resources);
+
+    buffer->size = 0;
+    
+    cp->write_buffer = buffer;
+    cp->read_buffer = NULL;
+    cp->read_offset = 0;
+    cp->digest = NULL;
+    cp->issues = issues;
+
+    memset(&(cp->checkpoint), 0, sizeof(struct checkpoint_iface_t));
+    cp->checkpoint.write = checkpoint_write;
+    cp->checkpoint.destroy = checkpoint_destroy;
+
+    return &(cp->checkpoint);
+
+error_free_resources:
+    return NULL;
+}
+
+struct checkpoint_iface_t * st_new_checkpoint_reader(
+    const struct st_buffer_t *buffer,
+    struct issues_iface_t *issues)
+{
+    struct checkpoint_t *cp = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	cp,
+	struct checkpoint_t,
+	issues,
+	error_free_resources);
+
+    cp->write_buffer = NULL;
+    cp->read_buffer = buffer;
+    cp->read_offset = 0;
+    cp->digest = NULL;
+    cp->issues = issues;
+
+    memset(&(cp->checkpoint), 0, sizeof(struct checkpoint_iface_t));
+    cp->checkpoint.read = checkpoint_read;
+    cp->checkpoint.destroy = checkpoint_destroy;
+
+    return &(cp->checkpoint);
+
+error_free_resources:
+    return NULL;
+}
+
+struct checkpoint_iface_t * st_new_checkpoint_digest(
+    uint64_t *digest,
+    struct issues_iface_t *issues)
+{
+    struct checkpoint_t *cp = NULL;
+    ALLOC_OR_ERROR_JUMP(
+	cp,
+	struct checkpoint_t,
+	issues,
+	error_free_resources);
+
+    *digest = DIGEST_OFFSET_BASIS;
+    
+    cp->write_buffer = NULL;
+    cp->read_buffer = NULL;
+    cp->read_offset = 0;
+    cp->digest = digest;
+    cp->issues = issues;
+
+    memset(&(cp->checkpoint), 0, sizeof(struct checkpoint_iface_t));
+    cp->checkpoint.write = checkpoint_digest_write;
+    cp->checkpoint.destroy = checkpoint_destroy;
+
+    return &(cp->checkpoint);
+
+error_free_resources:
+    return NULL;
+}
@@ -29,6 +29,9 @@ static struct bool_option_t bool_options_template[] = {
     { .option = "resolve_links_on_parse_error",
       .value = ESSTEE_FALSE
     },
+    { .option = "short_circuit_evaluation",
+      .value = ESSTEE_FALSE
+    },
 };
 
 struct config_iface_t * st_new_config(void)
@@ -116,6 +119,19 @@ int st_config_set(
     return ESSTEE_OK;
 }
 
+void st_copy_config(
+    struct config_iface_t *self,
+    const struct config_iface_t *from)
+{
+    struct config_t *conf = CONTAINER_OF(self, struct config_t, config);
+    const struct config_t *from_conf = CONTAINER_OF(from, struct config_t, config);
+
+    for(int i=0; i < sizeof(bool_options_template)/sizeof(struct bool_option_t); i++)
+    {
+	conf->options_chunk[i].value = from_conf->options_chunk[i].value;
+    }
+}
+
 void st_destroy_config(
     struct config_iface_t *self)
 {
@@ -47,5 +47,10 @@ int st_config_set(
 
 struct config_iface_t * st_new_config(void);
 
+/* Sets every option to its value in the other configuration */
+void st_copy_config(
+    struct config_iface_t *self,
+    const struct config_iface_t *from);
+
 void st_destroy_config(
     struct config_iface_t *self);
@@ -0,0 +1,41 @@
+/*
+Copyright (C) 2015 Kristian Nordman
+
+This file is part of esstee. 
+
+esstee is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+esstee is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with esstee.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+/* Byte stream that runtime state is written to (st_checkpoint) or
+ * read back from (st_restore). Writing and reading is done in the
+ * same order, so no framing is stored. */
+struct checkpoint_iface_t {
+
+    int (*write)(
+	struct checkpoint_iface_t *self,
+	const void *bytes,
+	size_t size);
+
+    int (*read)(
+	struct checkpoint_iface_t *self,
+	void *bytes,
+	size_t size);
+
+    void (*destroy)(
+	struct checkpoint_iface_t *self);
+};